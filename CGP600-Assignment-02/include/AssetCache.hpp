@@ -0,0 +1,112 @@
+#pragma once
+
+#include <cstdint>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+
+// Hands out shared, read-only assets keyed by path, so each one is only loaded once however many things use it
+// The cache only holds weak references, so an asset is freed as soon as the last thing using it lets go
+// Safe to use from any thread. Lookups of different keys don't wait for each other's loads.
+template <typename T, typename Key = std::string>
+class AssetCache
+{
+    private:
+        struct Entry
+        {
+            std::weak_ptr<const T> asset;
+            // Valid while the asset is being loaded, so anyone else asking for it waits instead of loading it again
+            std::shared_future<std::shared_ptr<const T>> loading;
+        };
+
+        std::unordered_map<Key, Entry> entries;
+        mutable std::mutex mutex;
+        uint64_t hitCount = 0;
+        uint64_t missCount = 0;
+    public:
+        AssetCache() = default;
+        AssetCache(const AssetCache&) = delete;
+        AssetCache& operator=(const AssetCache&) = delete;
+
+        // load is only called on a miss, and returns a std::shared_ptr<T>, or null if it failed
+        // Failures aren't remembered, so the next lookup tries again
+        // If load throws, the exception reaches this caller, and anyone waiting on the same load gets null
+        template <typename Loader>
+        std::shared_ptr<const T> get(const Key& key, Loader load)
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            Entry& entry = entries[key];
+
+            std::shared_ptr<const T> asset = entry.asset.lock();
+            if (asset)
+            {
+                hitCount++;
+                return asset;
+            }
+
+            if (entry.loading.valid())
+            {
+                hitCount++;
+                std::shared_future<std::shared_ptr<const T>> loading = entry.loading;
+                lock.unlock();
+                return loading.get();
+            }
+
+            missCount++;
+            std::promise<std::shared_ptr<const T>> promise;
+            entry.loading = promise.get_future().share();
+            lock.unlock();
+
+            // Entries are never erased, and references to them survive the map growing
+            try
+            {
+                asset = load();
+            }
+            catch (...)
+            {
+                // Treated as a failed load by anyone waiting on it, then passed on to the caller
+                lock.lock();
+                entry.loading = std::shared_future<std::shared_ptr<const T>>();
+                lock.unlock();
+
+                promise.set_value(nullptr);
+                throw;
+            }
+
+            lock.lock();
+            entry.asset = asset;
+            entry.loading = std::shared_future<std::shared_ptr<const T>>();
+            lock.unlock();
+
+            promise.set_value(asset);
+            return asset;
+        }
+
+        uint64_t getHitCount() const
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            return hitCount;
+        }
+
+        uint64_t getMissCount() const
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            return missCount;
+        }
+
+        // Assets that something is still using
+        std::size_t getLiveCount() const
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+
+            std::size_t result = 0;
+            for (const auto& entry : entries)
+            {
+                if (!entry.second.asset.expired()) result++;
+            }
+
+            return result;
+        }
+};
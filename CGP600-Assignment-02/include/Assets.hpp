@@ -0,0 +1,64 @@
+#pragma once
+
+#include "AssetCache.hpp"
+#include "MappedFile.hpp"
+#include "MeshCache.hpp"
+#include <memory>
+#include <string>
+#include <vector>
+#include <d3d11.h>
+
+// A baked model and the buffers made from it, shared by every Mesh drawing that model
+struct MeshData
+{
+    MappedFile cacheFile;
+    std::vector<uint8_t> bakedData; // Only used when the cache file was stale and had to be baked or stamped again
+    MeshCacheView view = {};
+    ID3D11Buffer* vertexBuffer = nullptr;
+    ID3D11Buffer* indexBuffer = nullptr;
+
+    ~MeshData();
+};
+
+struct Texture
+{
+    ID3D11ShaderResourceView* view = nullptr;
+
+    Texture() = default;
+    Texture(const Texture&) = delete;
+    Texture& operator=(const Texture&) = delete;
+    ~Texture();
+};
+
+struct ShaderProgram
+{
+    ID3D11VertexShader* vertexShader = nullptr;
+    ID3D11PixelShader* pixelShader = nullptr;
+    ID3D11InputLayout* inputLayout = nullptr;
+    ID3D11SamplerState* sampler = nullptr;
+
+    ShaderProgram() = default;
+    ShaderProgram(const ShaderProgram&) = delete;
+    ShaderProgram& operator=(const ShaderProgram&) = delete;
+    ~ShaderProgram();
+};
+
+// Everything loaded from disk goes through here, so anything used more than once is only loaded once
+// Each returns null if the asset couldn't be loaded
+namespace Assets
+{
+    std::shared_ptr<const MeshData> getMesh(ID3D11Device* device, const char* fileName);
+    std::shared_ptr<const Texture> getTexture(ID3D11Device* device, const wchar_t* fileName);
+    // Keyed by path alone, since each shader file is only ever used with one input layout
+    std::shared_ptr<const ShaderProgram> getShaderProgram(ID3D11Device* device, const wchar_t* path,
+        const D3D11_INPUT_ELEMENT_DESC* inputElementDescriptions, UINT descriptionCount);
+
+    // The DDS file baked from an image, or empty if there isn't one or it's older than the image
+    std::wstring getBakedTexturePath(const wchar_t* fileName);
+    // Compress every PNG in a directory to a DDS file beside it, returning how many were baked
+    // Names containing -normal become BC5, opaque images BC1 and the rest BC3
+    int bakeTextures(const char* directory, int quality);
+
+    // Hits, misses and how many of each kind of asset are loaded
+    void printStatistics();
+}
@@ -0,0 +1,27 @@
+#pragma once
+
+// Timings for the hot paths, run with -benchmark on the command line
+// Best taken from a release build
+namespace Benchmarks
+{
+    // World
+    void voxelGridLayout();
+    void chunkMeshing();
+    void faceInstancing();
+    void perlinNoise();
+    void latticeNoise();
+    void simplexNoise();
+    void terrainGeneration();
+    void blockStorage();
+
+    // Models
+    void meshOptimisation();
+    void objParsing();
+    void meshCacheLoading();
+
+    // Textures
+    void textureMips();
+    void textureCompression();
+
+    void runBenchmarks();
+}
@@ -6,3 +6,13 @@ struct Block
 {
     UINT textureId;
 };
+
+inline bool operator==(const Block& a, const Block& b)
+{
+    return a.textureId == b.textureId;
+}
+
+inline bool operator!=(const Block& a, const Block& b)
+{
+    return !(a == b);
+}
@@ -1,11 +1,32 @@
 #pragma once
 
-// #define _XM_NO_INTRINSICS_
-// #define XM_NO_ALIGNMENT
-#include <DirectXMath.h>
+#include <Windows.h>
 
+// One visible face of a block packed into 32 bits, which the vertex shader expands into a quad
+// Coordinates are relative to the chunk, whose origin is supplied with each draw
+// Bits 0-14 hold x, y and z, five bits each, then the face in 15-17 and the texture in 18-31
 struct BlockInstance
 {
-    DirectX::XMFLOAT4 position;
-	UINT textureId;
+    UINT packed;
+
+    static const UINT coordinateBits = 5;
+    static const UINT coordinateMask = (1u << coordinateBits) - 1u;
+    static const UINT faceShift = coordinateBits * 3;
+    static const UINT faceMask = 7;
+    static const UINT textureShift = faceShift + 3;
+    static const UINT maxTextureId = 0xFFFFFFFFu >> textureShift;
+    // -x, +x, -y, +y, -z, +z, or emptyFace for an unused slot
+    static const UINT emptyFace = 7;
+
+    static BlockInstance encode(UINT x, UINT y, UINT z, UINT face, UINT textureId)
+    {
+        return { (x & coordinateMask) | ((y & coordinateMask) << coordinateBits) | ((z & coordinateMask) << (coordinateBits * 2)) |
+            ((face & faceMask) << faceShift) | (textureId << textureShift) };
+    }
+
+    UINT getX() const { return packed & coordinateMask; }
+    UINT getY() const { return (packed >> coordinateBits) & coordinateMask; }
+    UINT getZ() const { return (packed >> (coordinateBits * 2)) & coordinateMask; }
+    UINT getFace() const { return (packed >> faceShift) & faceMask; }
+    UINT getTextureId() const { return packed >> textureShift; }
 };
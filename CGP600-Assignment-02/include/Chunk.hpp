@@ -0,0 +1,105 @@
+#pragma once
+
+#include "Block.hpp"
+#include <atomic>
+#include <cstdint>
+#include <mutex>
+#include <vector>
+
+// A volume of blocks stored as packed indices into a table of block values
+// Once shared with a snapshot a chunk is only read, and reads may come from any thread
+class Chunk
+{
+    private:
+        int width, height, depth;
+
+        // Entry 0 is always air, so a zeroed chunk is empty
+        std::vector<Block> palette;
+        // Number of blocks using each palette entry, rebuilt if the chunk can't be decompressed
+        mutable std::vector<UINT> paletteCounts;
+        mutable std::vector<UINT> freePaletteEntries;
+
+        UINT bitsPerBlock = 4; // Always 4, 8 or 16 so an index never straddles two words
+        // Empty while compressed, and rebuilt on first access
+        mutable std::vector<uint64_t> data;
+        mutable std::vector<uint8_t> compressedData;
+        mutable std::atomic<bool> compressed;
+        // Held while inflating, so readers on different threads don't inflate the same chunk at once
+        mutable std::mutex decompressionMutex;
+        UINT blockCount = 0;
+
+        // One bit per block, kept alongside the indices and never compressed
+        std::vector<uint64_t> occupancy;
+        // One set per face, with a bit for each solid block that has air on that side
+        // Blocks outside the chunk count as air here, and the map fixes up the faces against its neighbours
+        std::vector<uint64_t> exposure[6];
+
+        mutable uint64_t lastAccess = 0;
+
+        UINT getPaletteIndex(int index) const;
+        void setPaletteIndex(int index, UINT value);
+        UINT findOrAddPaletteEntry(Block value);
+        void releasePaletteEntry(UINT paletteIndex);
+        void resizeData(UINT bits);
+        void ensureDecompressed() const;
+        // Unpack compressedData, returning false if it's corrupt
+        bool inflate(std::vector<uint64_t>& decodedOut) const;
+        // Index of the block next to this one, or -1 if it's outside the chunk
+        int getNeighbourIndex(int index, int face) const;
+    public:
+        // Faces are numbered -x, +x, -y, +y, -z, +z, so face ^ 1 is the opposite face
+        static const int faceCount = 6;
+        static const int topFace = 3;
+
+        Chunk(int width, int height, int depth);
+        Chunk(const Chunk& other);
+        Chunk& operator=(const Chunk& other) = delete;
+
+        int getWidth() const;
+        int getHeight() const;
+        int getDepth() const;
+        int getBlockIndex(int x, int y, int z) const;
+
+        void addBlock(int index, Block value);
+        void addBlock(int x, int y, int z, Block value);
+        void removeBlock(int index);
+        void removeBlock(int x, int y, int z);
+
+        // Returns nullptr for air. The pointer is invalidated by the next edit.
+        const Block* getBlock(int index) const;
+        const Block* getBlock(int x, int y, int z) const;
+
+        // Checks the occupancy bits only, so never has to decompress
+        bool isSolid(int index) const;
+        bool isSolid(int x, int y, int z) const;
+        const std::vector<uint64_t>& getOccupancy() const;
+
+        // Bit f is set if face f of the block can be seen, and nothing is set for air or buried blocks
+        UINT getExposedFaces(int index) const;
+        UINT getExposedFaces(int x, int y, int z) const;
+        const std::vector<uint64_t>& getExposure(int face) const;
+        void setFaceExposed(int index, int face, bool exposed);
+        // Rebuild a whole face set from the occupancy of each block's neighbour on that side
+        void refreshExposure(int face, const uint64_t* neighbours);
+
+        bool isEmpty() const;
+        UINT getBlockCount() const;
+        UINT getBitsPerBlock() const;
+        std::size_t getPaletteSize() const;
+
+        // Run-length code the indices down each column, then LZ the result
+        // Any access decompresses the chunk again. Left uncompressed if the result wouldn't decompress to the same blocks.
+        void compress();
+        void decompress() const;
+        bool isCompressed() const;
+
+        void setLastAccess(uint64_t tick) const;
+        uint64_t getLastAccess() const;
+
+        // Bytes the indices would take uncompressed, whether or not they currently are
+        std::size_t getUncompressedSize() const;
+        std::size_t getCompressedSize() const;
+
+        // Bytes used by the packed or compressed indices, the occupancy and exposure bits and the palette
+        std::size_t getMemoryUsage() const;
+};
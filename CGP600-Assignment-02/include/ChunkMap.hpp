@@ -0,0 +1,121 @@
+#pragma once
+
+#include "Chunk.hpp"
+#include "Occupancy.hpp"
+#include <memory>
+#include <unordered_map>
+
+struct ChunkCoordinate
+{
+    int x, y, z;
+};
+
+inline bool operator==(const ChunkCoordinate& a, const ChunkCoordinate& b)
+{
+    return a.x == b.x && a.y == b.y && a.z == b.z;
+}
+
+inline bool operator!=(const ChunkCoordinate& a, const ChunkCoordinate& b)
+{
+    return !(a == b);
+}
+
+struct ChunkCoordinateHash
+{
+    std::size_t operator()(const ChunkCoordinate& coordinate) const
+    {
+        // Large primes spread neighbouring coordinates across buckets
+        return ((std::size_t)(unsigned int)coordinate.x * 73856093u) ^ ((std::size_t)(unsigned int)coordinate.y * 19349663u) ^ ((std::size_t)(unsigned int)coordinate.z * 83492791u);
+    }
+};
+
+struct CompressionStatistics
+{
+    std::size_t compressedBytes; // Memory held by compressed chunks
+    std::size_t uncompressedBytes; // Memory held by chunks that are ready to read
+    UINT compressedChunkCount;
+    UINT decompressionCount;
+    double decompressionSeconds;
+};
+
+class WorldSnapshot;
+
+// An unbounded world made of fixed-size chunks, only storing the chunks that contain blocks
+// Chunks that haven't been used recently are compressed once the memory budget is exceeded
+// Edits are made on the updating thread, and published as versions that can be read on other threads through snapshots
+class ChunkMap
+{
+    public:
+        static const int chunkSize = 32;
+
+        typedef std::unordered_map<ChunkCoordinate, std::shared_ptr<Chunk>, ChunkCoordinateHash> ChunkTable;
+    private:
+        ChunkTable chunks;
+
+        uint64_t version = 0;
+        // The last one handed out, kept so asking again for the same version doesn't build another
+        mutable std::shared_ptr<const WorldSnapshot> snapshot;
+
+        std::size_t memoryBudget = 32 * 1024 * 1024;
+        mutable uint64_t accessClock = 0;
+        mutable UINT decompressionCount = 0;
+        mutable double decompressionSeconds = 0.0;
+
+        // Mark a chunk as recently used and inflate it if needed
+        void touch(const Chunk* chunk) const;
+        // Copy a chunk that a snapshot still shares before it's changed, so the snapshot never sees the edit
+        Chunk* makeWritable(std::shared_ptr<Chunk>& chunk);
+        // After a block is added or removed, fix up the faces between it and the blocks in neighbouring chunks
+        void updateBorderExposure(int x, int y, int z, Chunk* chunk);
+        // Rebuild the faces between a chunk and each of its neighbours, after it's been replaced or removed
+        void refreshChunkExposure(ChunkCoordinate coordinate);
+    public:
+        // Floor division so negative coordinates land in the right chunk
+        static ChunkCoordinate getChunkCoordinate(int x, int y, int z);
+        static int getLocalCoordinate(int value);
+
+        void addBlock(int x, int y, int z, Block value);
+        void removeBlock(int x, int y, int z);
+        const Block* getBlock(int x, int y, int z) const;
+        // Reads the occupancy bits only, so it's cheap and doesn't inflate or touch the chunk
+        bool isSolid(int x, int y, int z) const;
+        // Which faces of a block have air beside them, kept up to date by every edit
+        UINT getExposedFaces(int x, int y, int z) const;
+
+        // Returns nullptr if the chunk has no blocks
+        // The non-const version is for editing, so copies the chunk if a snapshot shares it
+        Chunk* getChunk(ChunkCoordinate coordinate);
+        const Chunk* getChunk(ChunkCoordinate coordinate) const;
+        Chunk* getOrCreateChunk(ChunkCoordinate coordinate);
+        void setChunk(ChunkCoordinate coordinate, std::unique_ptr<Chunk> chunk);
+        // The same, but for chunks whose exposure already takes their neighbours into account, so none is refreshed
+        void setGeneratedChunk(ChunkCoordinate coordinate, std::unique_ptr<Chunk> chunk);
+
+        // Iterating doesn't count as an access, so use getChunk to read the blocks
+        const ChunkTable& getChunks() const;
+
+        // Face masks for the chunk size, shared by every occupancy kernel
+        static const Occupancy::FaceMasks& getFaceMasks();
+        // Find the solid blocks with solid neighbours on all six sides, and those with nothing above them
+        // Neighbours in missing chunks count as air
+        // Read straight from the exposure bits, so it's cheap enough to call after edits
+        void findInteriorBlocks(ChunkCoordinate coordinate, std::vector<uint64_t>& interiorOut, std::vector<uint64_t>& uncoveredOut) const;
+        std::size_t getChunkCount() const;
+        std::size_t getMemoryUsage() const;
+
+        // Limit on the memory used by block indices, compressed or not, in bytes
+        // The occupancy, exposure and palette are never compressed, so aren't counted
+        void setMemoryBudget(std::size_t bytes);
+        std::size_t getMemoryBudget() const;
+        // Compress the least recently used chunks until the block indices fit in the budget
+        void enforceMemoryBudget();
+        CompressionStatistics getCompressionStatistics() const;
+
+        // Mark the edits so far as a new version. Nothing is copied until someone asks for a snapshot of it.
+        void publish();
+        // The last published version, or nullptr if nothing has been published
+        // Call it from the editing thread, before editing again, then hand the snapshot to whichever threads need it
+        // Building one only copies pointers, but until it's let go the next edit to each chunk copies that chunk
+        std::shared_ptr<const WorldSnapshot> getSnapshot() const;
+        uint64_t getVersion() const;
+};
@@ -0,0 +1,38 @@
+#pragma once
+
+#include "Chunk.hpp"
+#include "BlockInstance.hpp"
+#include <vector>
+
+// 24 bytes per vertex, with the normal and tangents worked out from the face in the shader
+struct ChunkVertex
+{
+    float x, y, z; // Relative to the chunk's origin
+    float u, v; // One unit per block, so merged quads tile the texture
+    UINT faceAndTexture; // Face (-x, +x, -y, +y, -z, +z) in the low 3 bits, texture id above
+};
+
+struct ChunkMesh
+{
+    std::vector<ChunkVertex> vertices;
+    std::vector<UINT> indices; // Two clockwise triangles per quad
+};
+
+// Turns the visible faces of a chunk into quads
+// Faces come from the chunk's exposure bits, so faces against solid blocks in neighbouring chunks are already culled
+class ChunkMesher
+{
+    private:
+        // Texture id + 1 for each visible face in the slice being meshed, or 0 for none
+        std::vector<UINT> mask;
+
+        void buildMask(const Chunk& chunk, int face, int slice);
+        void addQuad(ChunkMesh& meshOut, int face, int slice, int u, int v, int width, int height, UINT textureId) const;
+    public:
+        // Merge neighbouring faces with the same texture into as few rectangles as possible
+        void buildGreedyMesh(const Chunk& chunk, ChunkMesh& meshOut);
+        // A quad for every visible face, as a baseline for the greedy mesh
+        void buildFaceMesh(const Chunk& chunk, ChunkMesh& meshOut);
+        // Append an instance for every visible face, with coordinates relative to the chunk
+        static void buildFaceInstances(const Chunk& chunk, std::vector<BlockInstance>& instancesOut);
+};
@@ -0,0 +1,19 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+namespace Compression
+{
+    // Append an unsigned value using 7 bits per byte, high bit set on all but the last byte
+    void writeVarint(std::vector<uint8_t>& output, uint32_t value);
+
+    // Read a value written by writeVarint, returning false if the input ends early
+    bool readVarint(const uint8_t* input, std::size_t size, std::size_t* position, uint32_t* value);
+
+    // Byte-level LZ77 in the style of LZ4, fast rather than small
+    std::vector<uint8_t> lzCompress(const uint8_t* input, std::size_t size);
+
+    // Returns false if the input is corrupt or doesn't expand to exactly expectedSize bytes
+    bool lzDecompress(const uint8_t* input, std::size_t size, std::size_t expectedSize, std::vector<uint8_t>& output);
+}
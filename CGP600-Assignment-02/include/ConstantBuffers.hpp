@@ -19,3 +19,8 @@ struct PixelConstantBuffer
     float pointLightFalloff;
     DirectX::XMFLOAT3 padding;
 };
+
+struct ChunkConstantBuffer
+{
+    DirectX::XMINT4 origin;
+};
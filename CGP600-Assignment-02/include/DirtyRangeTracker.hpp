@@ -0,0 +1,28 @@
+#pragma once
+
+#include <vector>
+#include <Windows.h>
+
+struct DirtyRange
+{
+    UINT begin, end; // end is one past the last changed element
+};
+
+// Collects the parts of an array that have changed since it was last uploaded
+// Ranges are kept sorted, with overlapping and touching ranges merged
+class DirtyRangeTracker
+{
+    private:
+        std::vector<DirtyRange> ranges;
+    public:
+        void markDirty(UINT index);
+        void markDirty(UINT begin, UINT end);
+        // Join ranges separated by no more than gap clean elements, trading a little extra copying for fewer uploads
+        void coalesce(UINT gap);
+        void clear();
+
+        const std::vector<DirtyRange>& getRanges() const;
+        bool isEmpty() const;
+        // Total elements covered by the ranges
+        UINT getDirtyCount() const;
+};
@@ -0,0 +1,68 @@
+#pragma once
+
+#include <cmath>
+
+// Several octaves of any noise with PerlinNoise's noise() and 0 to 1 range, each at twice the frequency and half the amplitude of the last
+// The octave count is a template argument, so the octaves are unrolled and their total amplitude is a constant
+// Works with as many coordinates as the noise takes, for example fbm<4>(simplex, x, z) for a heightmap
+namespace FractalNoise
+{
+    template <int octaves>
+    constexpr float totalAmplitude()
+    {
+        if constexpr (octaves <= 1)
+        {
+            return 1.f;
+        }
+        else
+        {
+            return 1.f + 0.5f * totalAmplitude<octaves - 1>();
+        }
+    }
+
+    // From -1 to 1 for each octave
+    template <int octaves, typename Noise, typename ... Coordinates>
+    float sumOctaves(const Noise& noise, float frequency, Coordinates... coordinates)
+    {
+        const float value = noise.noise((coordinates * frequency)...) * 2.f - 1.f;
+        if constexpr (octaves <= 1)
+        {
+            return value;
+        }
+        else
+        {
+            return value + 0.5f * sumOctaves<octaves - 1>(noise, frequency * 2.f, coordinates...);
+        }
+    }
+
+    // Sharp crests where the noise crosses its midpoint, from 0 to 1 for each octave
+    template <int octaves, typename Noise, typename ... Coordinates>
+    float sumRidges(const Noise& noise, float frequency, Coordinates... coordinates)
+    {
+        const float ridge = 1.f - fabsf(noise.noise((coordinates * frequency)...) * 2.f - 1.f);
+        if constexpr (octaves <= 1)
+        {
+            return ridge * ridge;
+        }
+        else
+        {
+            return ridge * ridge + 0.5f * sumRidges<octaves - 1>(noise, frequency * 2.f, coordinates...);
+        }
+    }
+
+    // Fractional Brownian motion, from 0 to 1
+    template <int octaves, typename Noise, typename ... Coordinates>
+    float fbm(const Noise& noise, Coordinates... coordinates)
+    {
+        static_assert(octaves > 0, "fbm needs at least one octave");
+        return (sumOctaves<octaves>(noise, 1.f, coordinates...) / totalAmplitude<octaves>() + 1.f) / 2.f;
+    }
+
+    // Ridged multifractal, from 0 to 1, for mountain ranges and ravines
+    template <int octaves, typename Noise, typename ... Coordinates>
+    float ridged(const Noise& noise, Coordinates... coordinates)
+    {
+        static_assert(octaves > 0, "ridged needs at least one octave");
+        return sumRidges<octaves>(noise, 1.f, coordinates...) / totalAmplitude<octaves>();
+    }
+}
@@ -0,0 +1,10 @@
+#pragma once
+
+#include "TexturePacker.hpp"
+
+// Decodes image files to RGBA on the CPU, without going near the device
+namespace ImageLoader
+{
+    // Anything WIC can read. Safe to call from any thread.
+    bool loadFile(const wchar_t* fileName, TextureImage& output);
+}
@@ -0,0 +1,27 @@
+#pragma once
+
+#include <cstddef>
+#include <Windows.h>
+
+// A read-only view of a whole file, paged in by the OS as it's touched
+class MappedFile
+{
+    private:
+        HANDLE file = INVALID_HANDLE_VALUE;
+        HANDLE mapping = nullptr;
+        const void* data = nullptr;
+        std::size_t size = 0;
+    public:
+        MappedFile() = default;
+        MappedFile(const MappedFile&) = delete;
+        MappedFile& operator=(const MappedFile&) = delete;
+        ~MappedFile();
+
+        // Closes anything already open, and returns false if the file can't be opened
+        bool open(const char* fileName);
+        void close();
+
+        // Null for an empty file
+        const void* getData() const;
+        std::size_t getSize() const;
+};
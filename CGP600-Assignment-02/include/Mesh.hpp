@@ -2,6 +2,8 @@
 
 #include "Vertex.hpp"
 #include "ConstantBuffers.hpp"
+#include "Assets.hpp"
+#include <memory>
 #include <vector>
 #include <d3d11.h>
 #include <mutex>
@@ -9,18 +11,11 @@
 class Mesh
 {
     private:
-        std::vector<Vertex> vertices;
-        ID3D11Buffer* vertexBuffer = nullptr;
-        std::vector<int> indices;
-        ID3D11Buffer* indexBuffer = nullptr;
-
-        ID3D11VertexShader* vertexShader = nullptr;
-        ID3D11PixelShader* pixelShader = nullptr;
-        ID3D11InputLayout* inputLayout = nullptr;
-        ID3D11SamplerState* sampler0 = nullptr;
-
-        ID3D11ShaderResourceView* texture = nullptr;
-        ID3D11ShaderResourceView* normalMap = nullptr;
+        // Shared with every other mesh using the same files, only the transform is this mesh's own
+        std::shared_ptr<const MeshData> meshData;
+        std::shared_ptr<const ShaderProgram> shaderProgram;
+        std::shared_ptr<const Texture> texture;
+        std::shared_ptr<const Texture> normalMap;
 
         DirectX::XMVECTOR position;
         DirectX::XMVECTOR rotation;
@@ -29,14 +24,13 @@ class Mesh
 		mutable std::mutex mutex;
     public:
         Mesh();
-        ~Mesh();
-
-        void loadFromFile(const char* fileName);
-        std::vector<Vertex>* getVertices();
 
-        HRESULT initialiseVertexBuffer(ID3D11Device* device, ID3D11DeviceContext* immediateContext);
+        // Loads the baked copy of the OBJ file if it's up to date, otherwise bakes it again
+        HRESULT loadFromFile(ID3D11Device* device, const char* fileName);
+        void getBounds(DirectX::XMFLOAT3* minimumOut, DirectX::XMFLOAT3* maximumOut) const;
 
         ID3D11Buffer* getVertexBuffer(UINT* vertexCount) const;
+        ID3D11Buffer* getIndexBuffer(UINT* indexCount) const;
 
         HRESULT loadTexture(ID3D11Device* device, const wchar_t* fileName, const wchar_t* normalMapFileName);
         ID3D11ShaderResourceView* getTexture() const;
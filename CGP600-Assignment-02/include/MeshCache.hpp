@@ -0,0 +1,84 @@
+#pragma once
+
+#include "Vertex.hpp"
+#include "ObjParser.hpp"
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+#include <Windows.h>
+
+// Start of a baked mesh file, followed by vertexCount PackedVertex and indexCount UINT
+struct MeshCacheHeader
+{
+    uint32_t magic;
+    uint32_t version;
+    uint32_t vertexSize; // sizeof(PackedVertex) when it was baked
+    uint32_t reserved;
+    uint64_t sourceHash; // Of the whole OBJ file
+    // The OBJ file's size and last write time when it was baked, so an unchanged file isn't hashed again
+    uint64_t sourceSize;
+    uint64_t sourceWriteTime;
+    uint32_t vertexCount;
+    uint32_t indexCount;
+    float boundsMinimum[3];
+    float boundsMaximum[3];
+};
+
+// Points straight into a baked file, so nothing is copied
+struct MeshCacheView
+{
+    const MeshCacheHeader* header;
+    const PackedVertex* vertices;
+    const UINT* indices;
+};
+
+// What welding and cache optimisation did to a mesh, for the -bake report and benchmarks
+struct MeshBuildStatistics
+{
+    std::size_t unweldedVertexCount = 0;
+    std::size_t vertexCount = 0;
+    float weldedACMR = 0.f;
+    float optimisedACMR = 0.f;
+};
+
+// Meshes ready to upload, baked from OBJ files so startup doesn't have to parse them
+// Each bake records a hash of the source, so a changed model is baked again the next time it's loaded
+// The source's size and write time are recorded too, and only when they differ is it read and hashed
+namespace MeshCache
+{
+    const uint32_t magic = 0x4853454Du; // "MESH"
+    // Bump whenever the header, PackedVertex or the way meshes are built changes
+    const uint32_t version = 3;
+
+    // 64-bit FNV-1a
+    uint64_t hashContent(const void* data, std::size_t size);
+
+    // models/character.obj is baked to models/character.mesh
+    std::string getCachePath(const char* objFileName);
+
+    // Triangles sharing a vertex wherever their corners match in the file, with the tangents of the faces around it averaged
+    // Ordered for the vertex cache
+    void buildMesh(const ObjData& data, std::vector<Vertex>& verticesOut, std::vector<UINT>& indicesOut, MeshBuildStatistics* statisticsOut = nullptr);
+
+    std::vector<uint8_t> serialise(const std::vector<Vertex>& vertices, const std::vector<UINT>& indices, uint64_t sourceHash);
+
+    // Returns false if the data is cut short or from another version
+    bool read(const void* data, std::size_t size, MeshCacheView& viewOut);
+    // The same, and also false if it was baked from a different source
+    bool read(const void* data, std::size_t size, uint64_t sourceHash, MeshCacheView& viewOut);
+
+    // Size and last write time of a file, returning false if it doesn't exist
+    bool getSourceStamp(const char* fileName, uint64_t* sizeOut, uint64_t* writeTimeOut);
+    // Record them in a baked file, which bake leaves as zero
+    void setSourceStamp(std::vector<uint8_t>& baked, uint64_t size, uint64_t writeTime);
+
+    // Everything from OBJ text to the bytes of a baked file
+    // Returns false if the OBJ is malformed, though what could be read is still baked
+    bool bake(std::string_view source, std::vector<uint8_t>& bakedOut, MeshBuildStatistics* statisticsOut = nullptr);
+    bool saveFile(const char* fileName, const std::vector<uint8_t>& baked);
+
+    // Bake every OBJ file in a directory, returning how many were baked
+    int bakeDirectory(const char* directory);
+}
@@ -0,0 +1,25 @@
+#pragma once
+
+#include "Vertex.hpp"
+#include <cstddef>
+#include <vector>
+#include <Windows.h>
+
+// Turns a triangle soup into an indexed mesh that's kind to the GPU's vertex caches
+namespace MeshOptimiser
+{
+    // Merge vertices that are identical byte for byte, returning an index for each of the original vertices
+    std::vector<UINT> weldVertices(std::vector<Vertex>& vertices);
+
+    // Reorder triangles so their vertices are still in the post-transform cache when they're used again
+    // Tom Forsyth's linear-speed vertex cache optimisation
+    void optimiseVertexCache(std::vector<UINT>& indices, std::size_t vertexCount);
+
+    // Renumber vertices in the order the triangles first use them, so fetches walk forwards through memory
+    // Vertices that no triangle uses are dropped
+    void optimiseVertexFetch(std::vector<Vertex>& vertices, std::vector<UINT>& indices);
+
+    // Average cache miss ratio, the vertices transformed per triangle with a FIFO cache of the given size
+    // 3 for an unindexed mesh, approaching 0.5 for a regular grid
+    float calculateACMR(const std::vector<UINT>& indices, std::size_t vertexCount, UINT cacheSize = 16);
+}
@@ -0,0 +1,34 @@
+#pragma once
+
+#include <cstddef>
+#include <string>
+#include <string_view>
+#include <vector>
+
+// One corner of a triangle, as zero-based indices into the arrays, or -1 if the file left it out
+struct ObjCorner
+{
+    int position;
+    int textureCoord;
+    int normal;
+};
+
+struct ObjData
+{
+    std::vector<float> positions; // x, y, z
+    std::vector<float> textureCoords; // u, v
+    std::vector<float> normals; // x, y, z
+    std::vector<ObjCorner> corners; // Three per triangle, with polygons split into fans
+};
+
+// Reads the geometry out of Wavefront OBJ files without allocating per line
+// Only v, vt, vn and f lines are read, and everything else is skipped
+namespace ObjParser
+{
+    // Large files are split at line breaks and parsed on up to threadCount threads
+    // Returns false if a face refers to something that doesn't exist
+    bool parse(std::string_view text, ObjData& dataOut, unsigned int threadCount = 1);
+
+    // The whole file is read in one go
+    bool parseFile(const char* fileName, ObjData& dataOut, unsigned int threadCount = 1);
+}
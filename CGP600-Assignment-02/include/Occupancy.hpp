@@ -0,0 +1,52 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// Word-parallel kernels over 1-bit-per-block occupancy sets
+// Bit i of a set is block i in a chunk's linear layout, x + width * (y + height * z),
+// so shifting a set by 1, width or width * height moves every block one step along x, y or z
+namespace Occupancy
+{
+    // Which bits of a set lie on each face of the chunk
+    struct FaceMasks
+    {
+        int width, height, depth;
+        std::size_t wordCount;
+        std::vector<uint64_t> first[3]; // Blocks with x, y or z equal to 0
+        std::vector<uint64_t> last[3]; // Blocks with x, y or z at the far edge
+    };
+
+    FaceMasks buildFaceMasks(int width, int height, int depth);
+
+    // Bit i of the output is bit i + shift of the input, with zeros shifted in from either end
+    void shiftBits(uint64_t* output, const uint64_t* input, std::size_t count, std::ptrdiff_t shift);
+    void andBits(uint64_t* output, const uint64_t* a, const uint64_t* b, std::size_t count);
+    // a & ~b
+    void andNotBits(uint64_t* output, const uint64_t* a, const uint64_t* b, std::size_t count);
+    void orBits(uint64_t* output, const uint64_t* a, const uint64_t* b, std::size_t count);
+
+    // Occupancy of the block one step along an axis (0, 1 or 2) in the given direction (+1 or -1)
+    // Blocks on the face take their neighbour from the adjoining chunk, which may be null for air
+    void neighbourBits(uint64_t* output, const FaceMasks& masks, const uint64_t* occupancy, const uint64_t* adjoining, int axis, int direction);
+
+    bool testBit(const std::vector<uint64_t>& bits, int index);
+    void setBit(std::vector<uint64_t>& bits, int index, bool value);
+    int countTrailingZeros(uint64_t value);
+
+    // Call function(index) for every set bit, lowest first
+    template <typename Function>
+    void forEachBit(const std::vector<uint64_t>& bits, Function function)
+    {
+        for (std::size_t word = 0; word < bits.size(); word++)
+        {
+            uint64_t remaining = bits[word];
+            while (remaining)
+            {
+                function((int)(word * 64 + countTrailingZeros(remaining)));
+                remaining &= remaining - 1;
+            }
+        }
+    }
+}
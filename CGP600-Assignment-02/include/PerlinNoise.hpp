@@ -1,18 +1,33 @@
 #pragma once
 
+#include <cstddef>
+#include <cstdint>
 #include <vector>
-#include <Windows.h>
 
 class PerlinNoise
 {
     private:
-        std::vector<UINT> permutation;
+        std::vector<uint32_t> permutation;
 
-        float fade(float time);
-        float lerp(float time, float a, float b);
-        float gradient(int hash, float x, float y, float z);
+        float fade(float time) const;
+        float lerp(float time, float a, float b) const;
+        float gradient(int hash, float x, float y, float z) const;
     public:
+        // What block positions are divided by before sampling
+        static constexpr float scaleFactor = 32.f;
+
         PerlinNoise(unsigned int seed);
-        float noise(float x, float y, float z);
-        std::vector<UINT> getPermutation();
+        float noise(float x, float y, float z) const;
+        // The same as noise at each point, to the bit, but several points at a time with SSE2 or AVX2
+        void noise8(const float x[8], const float y[8], const float z[8], float output[8]) const;
+        void noise16(const float x[16], const float y[16], const float z[16], float output[16]) const;
+        // The noise at each block in a region, x first
+        void sampleRegion(int x, int y, int z, int width, int height, int depth, std::vector<float>& valuesOut) const;
+        // Close to sampleRegion, from noise every latticeSpacing blocks along each axis and trilinear interpolation in between
+        // The lattice lines up with multiples of the spacing in world space, so neighbouring regions meet without seams
+        // Returns how many points of noise it took
+        std::size_t sampleRegionLattice(int x, int y, int z, int width, int height, int depth, int latticeSpacing, std::vector<float>& valuesOut) const;
+        // Which blocks in a region are solid, noise above 0.5 being solid
+        void generateRegion(int x, int y, int z, int width, int height, int depth, std::vector<bool>& blockValuesOut) const;
+        std::vector<uint32_t> getPermutation();
 };
@@ -0,0 +1,20 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+// Simplex noise in two, three and four dimensions, seeded and shuffled the same way as PerlinNoise so one seed gives both the same permutation
+// Each sample only visits the corners of one simplex (3, 4 or 5 of them) instead of a whole cube's 8, so it grows much more slowly with dimension
+// Like PerlinNoise, results are from 0 to 1
+class SimplexNoise
+{
+    private:
+        std::vector<uint32_t> permutation;
+        std::vector<uint32_t> permutationMod12; // Which of the 12 edge gradients a 2D or 3D corner uses
+    public:
+        SimplexNoise(unsigned int seed);
+        float noise(float x, float y) const;
+        float noise(float x, float y, float z) const;
+        float noise(float x, float y, float z, float w) const;
+        std::vector<uint32_t> getPermutation();
+};
@@ -0,0 +1,21 @@
+#pragma once
+
+#include <vector>
+#include <Windows.h>
+
+// Hands out indices into a fixed array, re-using freed ones before growing the array
+class SlotAllocator
+{
+    private:
+        std::vector<UINT> freeSlots;
+        UINT slotCount = 0;
+    public:
+        UINT allocate();
+        void release(UINT slot);
+        void clear();
+
+        // One past the highest slot ever handed out, which is how much of the array has to be drawn
+        UINT getSlotCount() const;
+        UINT getUsedCount() const;
+        UINT getFreeCount() const;
+};
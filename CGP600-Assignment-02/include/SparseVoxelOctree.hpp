@@ -0,0 +1,79 @@
+#pragma once
+
+#include "Block.hpp"
+#include "ChunkMap.hpp"
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+
+// A cubic region of blocks stored as an octree where uniform subtrees collapse to a single value
+// With deduplication on, identical subtrees are shared, turning the tree into a DAG
+class SparseVoxelOctree
+{
+    private:
+        // A reference is either an index into the node pool, or a uniform value with the top bit set
+        typedef uint32_t NodeReference;
+        static const NodeReference uniformFlag = 0x80000000u;
+
+        struct Node
+        {
+            NodeReference children[8];
+        };
+
+        struct NodeHash
+        {
+            std::size_t operator()(const Node& node) const;
+        };
+
+        struct NodeEqual
+        {
+            bool operator()(const Node& a, const Node& b) const;
+        };
+
+        int originX, originY, originZ;
+        int levels; // The region is 2^levels blocks along each side
+        bool deduplicate;
+
+        // Entry 0 is always air
+        std::vector<Block> palette;
+
+        std::vector<Node> nodes;
+        std::vector<UINT> referenceCounts;
+        std::vector<NodeReference> freeNodes;
+        std::unordered_map<Node, NodeReference, NodeHash, NodeEqual> uniqueNodes;
+
+        NodeReference root;
+
+        static bool isUniform(NodeReference reference);
+        static NodeReference makeUniform(UINT value);
+        static UINT getUniformValue(NodeReference reference);
+        static int getChildIndex(int x, int y, int z, int half);
+
+        UINT findOrAddPaletteEntry(Block value);
+        void retain(NodeReference reference);
+        void release(NodeReference reference);
+        // Takes ownership of the children and collapses or shares the node where possible
+        NodeReference makeNode(const NodeReference children[8]);
+        NodeReference setValue(NodeReference reference, int level, int x, int y, int z, UINT value);
+        NodeReference buildRegion(const ChunkMap& map, int x, int y, int z, int level);
+        bool raycastNode(NodeReference reference, int level, int minX, int minY, int minZ,
+            const float origin[3], const float direction[3], float maxDistance, int blockOut[3], float* distanceOut) const;
+    public:
+        SparseVoxelOctree(int originX, int originY, int originZ, int levels, bool deduplicate);
+
+        // Replace the contents with the blocks from a chunk map that fall inside the region
+        void build(const ChunkMap& map);
+
+        bool contains(int x, int y, int z) const;
+        void addBlock(int x, int y, int z, Block value);
+        void removeBlock(int x, int y, int z);
+        // Returns nullptr for air or positions outside the region
+        const Block* getBlock(int x, int y, int z) const;
+
+        // Find the first block along a ray, skipping whole empty subtrees at once
+        bool raycast(const float origin[3], const float direction[3], float maxDistance, int blockOut[3], float* distanceOut) const;
+
+        int getSize() const;
+        std::size_t getNodeCount() const;
+        std::size_t getMemoryUsage() const;
+};
@@ -0,0 +1,63 @@
+#pragma once
+
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <functional>
+#include <initializer_list>
+#include <mutex>
+#include <string>
+#include <vector>
+
+// Work split into named tasks that run on a pool of threads as soon as everything they depend on has finished
+// Each thread keeps the tasks it made ready, newest first, so work on the same data tends to stay on one thread, and idle threads steal the oldest from the others
+// Serial tasks are all run one after another on the thread that called run, for anything using the immediate context
+class TaskGraph
+{
+    public:
+        typedef std::size_t TaskId;
+    private:
+        struct Task
+        {
+            std::string name;
+            std::function<void()> work;
+            bool serial;
+            std::vector<TaskId> dependents;
+            int dependencyCount = 0;
+            int remainingDependencies = 0;
+            // Seconds since run was called
+            double startSeconds = 0.0;
+            double endSeconds = 0.0;
+            unsigned int threadIndex = 0;
+        };
+
+        std::vector<Task> tasks;
+        std::mutex mutex;
+        std::condition_variable condition;
+        std::vector<std::deque<TaskId>> queues; // One per thread
+        std::deque<TaskId> readySerial;
+        std::size_t finishedCount = 0;
+        std::chrono::high_resolution_clock::time_point startTime;
+        double totalSeconds = 0.0;
+        unsigned int threadCount = 0;
+
+        TaskId add(const char* name, std::function<void()> work, const TaskId* dependencies, std::size_t dependencyCount, bool serial);
+        // Serial work first for thread 0, then its own newest task, then the oldest from another thread. Needs mutex.
+        bool takeTask(unsigned int threadIndex, TaskId& idOut);
+        // Run ready tasks until every task has finished. Thread 0 is the one that called run.
+        void work(unsigned int threadIndex);
+    public:
+        // Dependencies have to have been added already, so there can't be any cycles
+        TaskId addTask(const char* name, std::function<void()> work, std::initializer_list<TaskId> dependencies = {});
+        TaskId addSerialTask(const char* name, std::function<void()> work, std::initializer_list<TaskId> dependencies = {});
+        // For when the number of dependencies isn't known up front
+        TaskId addTask(const char* name, std::function<void()> work, const std::vector<TaskId>& dependencies);
+
+        // Blocks until every task has run. Can be run again, and each task runs once each time.
+        void run(unsigned int threadCount);
+
+        double getTotalSeconds() const;
+        // When each task started and how long it took, in the order they were added
+        void printReport(const char* title) const;
+};
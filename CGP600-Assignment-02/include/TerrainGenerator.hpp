@@ -0,0 +1,102 @@
+#pragma once
+
+#include "ChunkMap.hpp"
+#include "PerlinNoise.hpp"
+#include "TaskGraph.hpp"
+#include <cstddef>
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+// Makes the starting world a chunk at a time on a pool of threads, in stages that run as soon as the chunks they read are ready:
+// density from the noise, then exposure against the neighbouring chunks, then grass on whatever has air above it
+// Each stage only writes to its own chunk, so a seed always gives the same world whatever the thread count
+class TerrainGenerator
+{
+    public:
+        // How density is decided for each block
+        static const int fullNoiseMode = 0; // 3D noise at every block
+        static const int heightmapMode = 1; // A 2D height per column first, with 3D noise only in a band around it for overhangs and caves
+
+        struct Settings
+        {
+            int mode = fullNoiseMode;
+            // Full noise mode only: sample noise every this many blocks and interpolate in between, or at every block if 1
+            int latticeSpacing = 1;
+            // The rest are only used by the heightmap mode, and are in blocks
+            float surfaceHeight = 32.f;
+            float heightVariation = 16.f; // Furthest the surface goes above or below surfaceHeight
+            int heightOctaves = 4;
+            int surfaceBand = 6; // 3D noise is only evaluated this far above and below the surface
+            // How far the 3D noise can move the surface, as a fraction of the band
+            // Kept below 1 so the edges of the band always agree with the blocks filled in beyond it
+            float overhangStrength = 0.8f;
+        };
+
+        struct Statistics
+        {
+            int chunkCount = 0;
+            std::size_t blockCount = 0;
+            unsigned int threadCount = 0;
+            // Blocks that needed 3D noise, blocks interpolated from a coarser lattice of it, and blocks decided by the heightmap alone
+            std::size_t voxelsEvaluated = 0;
+            std::size_t voxelsInterpolated = 0;
+            std::size_t voxelsFilled = 0;
+            std::size_t latticeSamples = 0;
+            // Points of 2D noise for the heightmap, worked out once per column of chunks
+            std::size_t heightmapSamples = 0;
+            // Added up over every chunk, so on several threads they can come to more than the total
+            double densitySeconds = 0.0;
+            double exposureSeconds = 0.0;
+            double surfaceSeconds = 0.0;
+            double totalSeconds = 0.0;
+        };
+    private:
+        PerlinNoise noise;
+        Settings settings;
+        Statistics statistics;
+
+        struct DensityCounts
+        {
+            std::size_t evaluated = 0;
+            std::size_t interpolated = 0;
+            std::size_t latticeSamples = 0;
+        };
+
+        // Shared by the tasks of one run, which each only write to their own chunk's entries
+        int chunksWide = 0, chunksHigh = 0, chunksDeep = 0;
+        std::vector<std::unique_ptr<Chunk>> chunks;
+        std::vector<ChunkCoordinate> coordinates;
+        std::vector<DensityCounts> densityCounts;
+        std::vector<std::vector<float>> columnHeights; // Heightmap mode only, one per column of chunks, x first
+        std::vector<std::chrono::high_resolution_clock::time_point> columnStartTimes;
+        std::vector<double> columnSeconds;
+        std::vector<std::chrono::high_resolution_clock::time_point> startTimes; // When each chunk's density started
+        std::vector<double> stageSeconds[3]; // Time spent on each stage of each chunk
+
+        // Index of the chunk on the other side of a face, or -1 if it's outside the volume
+        int getNeighbour(int index, int face) const;
+
+        // Which blocks of a chunk are solid, and how they were worked out
+        // In heightmap mode, heights are the ones generateHeights gave for the chunk's column
+        DensityCounts generateDensity(ChunkCoordinate coordinate, const std::vector<float>& heights, std::vector<bool>& blockValuesOut) const;
+        // Height of the surface at each column of a chunk, x first, from octaves of noise on a flat slice
+        void generateHeights(int originX, int originZ, std::vector<float>& heightsOut) const;
+    public:
+        TerrainGenerator(unsigned int seed);
+        TerrainGenerator(unsigned int seed, const Settings& settings);
+
+        // Chunks (0, 0, 0) up to but not including (chunksWide, chunksHigh, chunksDeep), into a map with nothing around them
+        // Anything outside that volume counts as air
+        void generate(int chunksWide, int chunksHigh, int chunksDeep, unsigned int threadCount, ChunkMap& output);
+        // The same stages added to someone else's graph, so they share its threads with whatever else it's running
+        // Returns the last task, which fills output. The generator has to outlive the graph's run.
+        TaskGraph::TaskId addTasks(TaskGraph& graph, int chunksWide, int chunksHigh, int chunksDeep, ChunkMap& output);
+
+        const Statistics& getStatistics() const;
+        void printReport() const;
+
+        // 64-bit FNV-1a over every chunk's blocks and exposure, in coordinate order, for checking two worlds match
+        static uint64_t hashChunks(const ChunkMap& chunks);
+};
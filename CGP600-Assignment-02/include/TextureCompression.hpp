@@ -0,0 +1,64 @@
+#pragma once
+
+#include "TexturePacker.hpp"
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// Block compressed mips, laid out like TextureArray
+struct CompressedTexture
+{
+    unsigned int width = 0;
+    unsigned int height = 0;
+    unsigned int mipCount = 0;
+    unsigned int layerCount = 0;
+    unsigned int format = 0;
+    std::vector<uint8_t> data;
+    std::vector<std::size_t> offsets; // Into data, one per subresource
+
+    const uint8_t* getMip(unsigned int layer, unsigned int mip) const;
+    unsigned int getMipWidth(unsigned int mip) const;
+    unsigned int getMipHeight(unsigned int mip) const;
+    // Bytes from one row of 4x4 blocks to the next
+    unsigned int getRowPitch(unsigned int mip) const;
+};
+
+// BC1, BC3 and BC5 encoding on the CPU, for baking textures to a quarter or an eighth of their size
+namespace TextureCompression
+{
+    // The same values as the DXGI formats, so they can be passed straight to D3D
+    const unsigned int bc1Format = 71; // RGB, for opaque albedo
+    const unsigned int bc3Format = 77; // RGB plus a separate alpha channel
+    const unsigned int bc5Format = 83; // Two channels, for normal maps with z worked out in the shader
+
+    // 0 takes the corners of the colours' bounding box, 1 fits a line through them, and 2 refines that line against the result
+    const int maxQuality = 2;
+
+    // Each encodes one 4x4 block of RGBA pixels, and each decoder writes the same layout back
+    void encodeBC1(const uint8_t block[64], uint8_t output[8], int quality);
+    void encodeBC4(const uint8_t block[64], int channel, uint8_t output[8], int quality);
+    void encodeBC3(const uint8_t block[64], uint8_t output[16], int quality);
+    void encodeBC5(const uint8_t block[64], uint8_t output[16], int quality);
+    void decodeBC1(const uint8_t input[8], uint8_t block[64]);
+    void decodeBC4(const uint8_t input[8], int channel, uint8_t block[64]);
+    void decodeBC3(const uint8_t input[16], uint8_t block[64]);
+    // Blue comes back as zero and alpha as opaque
+    void decodeBC5(const uint8_t input[16], uint8_t block[64]);
+
+    std::size_t getBlockSize(unsigned int format);
+    std::size_t getCompressedSize(unsigned int width, unsigned int height, unsigned int format);
+
+    // Edges of images that aren't a multiple of four are padded by repeating the last row and column
+    std::vector<uint8_t> compressImage(const TextureImage& image, unsigned int format, int quality);
+    void decompressImage(const uint8_t* data, unsigned int width, unsigned int height, unsigned int format, TextureImage& output);
+    void compress(const TextureArray& source, unsigned int format, int quality, CompressedTexture& output);
+
+    bool isOpaque(const TextureImage& image);
+    // Over the first channelCount channels. Infinite if they match exactly.
+    double calculatePSNR(const TextureImage& original, const TextureImage& compressed, unsigned int channelCount);
+
+    // DDS with the DX10 header, which DirectXTK's DDS loader can read
+    std::vector<uint8_t> writeDDS(const CompressedTexture& texture);
+    // Only reads back what writeDDS writes
+    bool readDDS(const void* data, std::size_t size, CompressedTexture& output);
+}
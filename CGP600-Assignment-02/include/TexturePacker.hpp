@@ -0,0 +1,47 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// RGBA, eight bits a channel, with rows packed tightly
+struct TextureImage
+{
+    unsigned int width = 0;
+    unsigned int height = 0;
+    std::vector<uint8_t> pixels;
+};
+
+// Every layer with its whole mip chain in one block, ordered the way D3D numbers subresources: all of layer 0's mips, then layer 1's...
+struct TextureArray
+{
+    unsigned int width = 0;
+    unsigned int height = 0;
+    unsigned int mipCount = 0;
+    unsigned int layerCount = 0;
+    std::vector<uint8_t> data;
+    std::vector<std::size_t> offsets; // Into data, one per subresource
+
+    const uint8_t* getMip(unsigned int layer, unsigned int mip) const;
+    unsigned int getMipWidth(unsigned int mip) const;
+    unsigned int getMipHeight(unsigned int mip) const;
+};
+
+// Packs block textures into arrays the shaders index straight by texture id, with mips made on the CPU
+namespace TexturePacker
+{
+    // Down to 1x1, so 256x256 has 9
+    unsigned int getMipCount(unsigned int width, unsigned int height);
+
+    // Average each 2x2 square, rounding to nearest, using SSE2 where it's available
+    // Normal maps have their averaged normals made unit length again
+    void downsample(const TextureImage& source, TextureImage& output, bool normalMap);
+    // The same thing one channel at a time, for checking downsample against
+    void downsampleReference(const TextureImage& source, TextureImage& output, bool normalMap);
+
+    // Stands in for an image that couldn't be loaded
+    TextureImage makeSolid(unsigned int width, unsigned int height, uint8_t red, uint8_t green, uint8_t blue, uint8_t alpha);
+
+    // Layer i ends up at array index i. Returns false if the layers aren't all the same size.
+    bool pack(const std::vector<TextureImage>& layers, bool normalMap, TextureArray& output);
+}
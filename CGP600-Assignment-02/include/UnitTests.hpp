@@ -21,6 +21,36 @@ namespace UnitTests
     // Transform
     bool hierarchy();
 
+    // World
+    bool chunk();
+    bool chunkPalette();
+    bool chunkMap();
+    bool sparseVoxelOctree();
+    bool sparseVoxelOctreeRaycast();
+    bool lzCompression();
+    bool chunkCompression();
+    bool chunkExposure();
+    bool occupancyShift();
+    bool occupancyInterior();
+    bool voxelGrid();
+    bool worldSnapshot();
+    bool slotAllocator();
+    bool dirtyRangeTracker();
+    bool chunkMesher();
+    bool faceInstances();
+    bool blockInstancePacking();
+    bool vertexPacking();
+    bool meshOptimiser();
+    bool objParser();
+    bool meshCache();
+    bool assetCache();
+    bool taskGraph();
+    bool texturePacker();
+    bool textureCompression();
+    bool perlinNoise();
+    bool terrainGenerator();
+    bool simplexNoise();
+
     char* successString(bool success);
     void runTest(bool (*function)(), bool* result);
     bool runTests();
@@ -0,0 +1,25 @@
+#pragma once
+
+#include "Vertex.hpp"
+#include <cstdint>
+
+// Conversions between Vertex and the compact PackedVertex the shaders read
+namespace VertexPacking
+{
+    // IEEE half precision, rounding to nearest even
+    uint16_t floatToHalf(float value);
+    float halfToFloat(uint16_t value);
+
+    // [-1, 1] to and from 16-bit signed normalised integers
+    int16_t floatToSnorm16(float value);
+    float snorm16ToFloat(int16_t value);
+
+    // A unit vector folded onto an octahedron and flattened to two snorm16 values
+    void octahedralEncode(float x, float y, float z, int16_t output[2]);
+    void octahedralDecode(const int16_t input[2], float output[3]);
+
+    // The tangent is made perpendicular to the normal, and the binormal is rebuilt from the two and a sign
+    PackedVertex packVertex(const Vertex& vertex);
+    // The same maths as the vertex shader, for checking the packing on the CPU
+    Vertex unpackVertex(const PackedVertex& vertex);
+}
@@ -0,0 +1,165 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// Rows along x, then y, then z
+// Neighbours along x share a cache line, but neighbours along z are a whole slice apart
+struct LinearLayout
+{
+    template <int Width, int Height, int Depth>
+    static constexpr std::size_t index(int x, int y, int z)
+    {
+        return (std::size_t)x + (std::size_t)Width * ((std::size_t)y + (std::size_t)Height * (std::size_t)z);
+    }
+
+    template <int Width, int Height, int Depth>
+    static constexpr std::size_t size()
+    {
+        return (std::size_t)Width * Height * Depth;
+    }
+
+    // Move one block along an axis without going back to coordinates
+    template <int Width, int Height, int Depth, int Axis>
+    static constexpr std::size_t increment(std::size_t index)
+    {
+        return index + (Axis == 0 ? 1 : Axis == 1 ? Width : (std::size_t)Width * Height);
+    }
+
+    template <int Width, int Height, int Depth, int Axis>
+    static constexpr std::size_t decrement(std::size_t index)
+    {
+        return index - (Axis == 0 ? 1 : Axis == 1 ? Width : (std::size_t)Width * Height);
+    }
+};
+
+// Z-order curve with the bits of x, y and z interleaved, so any small cube of blocks sits close together in memory
+// Coordinates are limited to 10 bits each
+struct MortonLayout
+{
+    // Bits 0, 3, 6... hold x, with y and z one and two bits above
+    static const uint32_t xMask = 0x09249249u;
+
+    static constexpr uint32_t spreadBits(uint32_t value)
+    {
+        value &= 0x3FFu;
+        value = (value | (value << 16)) & 0x030000FFu;
+        value = (value | (value << 8)) & 0x0300F00Fu;
+        value = (value | (value << 4)) & 0x030C30C3u;
+        value = (value | (value << 2)) & 0x09249249u;
+        return value;
+    }
+
+    template <int Width, int Height, int Depth>
+    static constexpr std::size_t index(int x, int y, int z)
+    {
+        return spreadBits((uint32_t)x) | (spreadBits((uint32_t)y) << 1) | (spreadBits((uint32_t)z) << 2);
+    }
+
+    // Interleaving is monotonic in each coordinate, so the far corner has the largest index
+    template <int Width, int Height, int Depth>
+    static constexpr std::size_t size()
+    {
+        return index<Width, Height, Depth>(Width - 1, Height - 1, Depth - 1) + 1;
+    }
+
+    // Fill the other axes' bits with ones so the carry skips straight over them
+    template <int Width, int Height, int Depth, int Axis>
+    static constexpr std::size_t increment(std::size_t index)
+    {
+        return ((((uint32_t)index | ~(xMask << Axis)) + 1u) & (xMask << Axis)) | ((uint32_t)index & ~(xMask << Axis));
+    }
+
+    template <int Width, int Height, int Depth, int Axis>
+    static constexpr std::size_t decrement(std::size_t index)
+    {
+        return ((((uint32_t)index & (xMask << Axis)) - 1u) & (xMask << Axis)) | ((uint32_t)index & ~(xMask << Axis));
+    }
+};
+
+// A fixed-size grid of values with all the index maths resolved at compile time
+template <typename T, int Width, int Height, int Depth, typename Layout = LinearLayout>
+class VoxelGrid
+{
+    private:
+        std::vector<T> values;
+    public:
+        static constexpr int getWidth() { return Width; }
+        static constexpr int getHeight() { return Height; }
+        static constexpr int getDepth() { return Depth; }
+        static constexpr std::size_t getSize() { return Layout::template size<Width, Height, Depth>(); }
+
+        static constexpr std::size_t getIndex(int x, int y, int z)
+        {
+            return Layout::template index<Width, Height, Depth>(x, y, z);
+        }
+
+        // Step an index one block along an axis (0, 1 or 2)
+        // The caller is responsible for staying inside the grid
+        template <int Axis>
+        static constexpr std::size_t increment(std::size_t index)
+        {
+            return Layout::template increment<Width, Height, Depth, Axis>(index);
+        }
+
+        template <int Axis>
+        static constexpr std::size_t decrement(std::size_t index)
+        {
+            return Layout::template decrement<Width, Height, Depth, Axis>(index);
+        }
+
+        static constexpr bool contains(int x, int y, int z)
+        {
+            return x >= 0 && x < Width && y >= 0 && y < Height && z >= 0 && z < Depth;
+        }
+
+        VoxelGrid(const T& value = T()) :
+            values(getSize(), value)
+        {
+        }
+
+        void fill(const T& value)
+        {
+            values.assign(getSize(), value);
+        }
+
+        T& at(int x, int y, int z)
+        {
+            return values[getIndex(x, y, z)];
+        }
+
+        const T& at(int x, int y, int z) const
+        {
+            return values[getIndex(x, y, z)];
+        }
+
+        T& operator[](std::size_t index)
+        {
+            return values[index];
+        }
+
+        const T& operator[](std::size_t index) const
+        {
+            return values[index];
+        }
+
+        // Visit every block in the cube from (minX, minY, minZ) to (maxX, maxY, maxZ) inclusive, stepping indices rather than recomputing them
+        template <typename Function>
+        void forEachInBox(int minX, int minY, int minZ, int maxX, int maxY, int maxZ, Function function) const
+        {
+            std::size_t zIndex = getIndex(minX, minY, minZ);
+            for (int z = minZ; z <= maxZ; z++, zIndex = increment<2>(zIndex))
+            {
+                std::size_t yIndex = zIndex;
+                for (int y = minY; y <= maxY; y++, yIndex = increment<1>(yIndex))
+                {
+                    std::size_t index = yIndex;
+                    for (int x = minX; x <= maxX; x++, index = increment<0>(index))
+                    {
+                        function(x, y, z, values[index]);
+                    }
+                }
+            }
+        }
+};
@@ -29,6 +29,9 @@ class Window
         ID3D11BlendState* blendState = NULL;
         std::chrono::high_resolution_clock::time_point updateLastTime;
         std::chrono::high_resolution_clock::time_point renderLastTime;
+        // For reporting the time to first frame
+        std::chrono::high_resolution_clock::time_point createTime;
+        bool firstFramePresented = false;
         WorldManager worldManager;
         mutable std::mutex mutex;
 
@@ -1,38 +1,70 @@
 #pragma once
 
 #include "Block.hpp"
+#include "ChunkMap.hpp"
+#include "WorldSnapshot.hpp"
 #include "BlockObject.hpp"
 #include "DirectionalLight.hpp"
 #include "PointLight.hpp"
 #include "Player.hpp"
 #include "Enemy.hpp"
 #include "BlockInstance.hpp"
-#include "PerlinNoiseCompute.hpp"
+#include "SlotAllocator.hpp"
+#include "DirtyRangeTracker.hpp"
 #include <memory>
+#include <mutex>
 #include <vector>
 #include <map>
+#include <unordered_map>
 #include <SpriteFont.h>
 
 class WorldManager
 {
     private:
+        // Size of the area generated when the world is created, in blocks
+        // The world itself is unbounded, so these don't limit editing
         const int width = 64;
         const int height = 64;
         const int depth = 64;
+        // Generation seed, so every run makes the same world
+        const unsigned int seed = 1337;
 
-        std::vector<std::unique_ptr<Block>> blocks;
+        ChunkMap blocks;
+
+        // Every visible block face keeps a slot in its chunk's instance array
+        // Edits patch the slots around them, and the render thread uploads only the ranges that changed
+        struct ChunkInstances
+        {
+            std::vector<BlockInstance> instances;
+            std::unordered_map<UINT, UINT> slots; // Keyed by getFaceKey
+            SlotAllocator slotAllocator;
+            DirtyRangeTracker dirty;
+            // Owned by the render thread
+            ID3D11Buffer* buffer = nullptr;
+            UINT bufferCapacity = 0;
+        };
+        std::unordered_map<ChunkCoordinate, ChunkInstances, ChunkCoordinateHash> chunkInstances;
+        std::mutex instanceMutex; // Only held while patching or uploading slots
+        // One draw per chunk with anything to show, refreshed by uploadInstances. Render thread only.
+        struct InstanceDraw
+        {
+            ChunkCoordinate coordinate;
+            ID3D11Buffer* buffer;
+            UINT instanceCount;
+        };
+        std::vector<InstanceDraw> instanceDraws;
+        ID3D11Buffer* chunkConstantBuffer = nullptr;
+        // Set by edits, so a new version is only published when something changed
+        bool worldChanged = false;
 
-        ID3D11Buffer* instanceBuffer = nullptr;
-        std::vector<BlockInstance> instances;
         ID3D11Device* device = nullptr;
         ID3D11DeviceContext* immediateContext = nullptr;
         std::unique_ptr<BlockObject> blockObject;
         Mesh skybox;
+        // Albedo then normal maps, as arrays indexed by texture id
         std::vector<ID3D11ShaderResourceView*> textures;
         std::unique_ptr<SpriteBatch> spriteBatch;
         std::unique_ptr<SpriteFont> spriteFont;
-        PerlinNoiseCompute perlinNoiseCompute;
-        mutable std::mutex mutex;
 
         DirectionalLight directionalLight;
         PointLight pointLight;
@@ -40,10 +72,19 @@ class WorldManager
         Player player;
         std::vector<std::unique_ptr<Enemy>> enemies;
 
-        void blockRaytrace(Segment ray, int* blockIndexOut, Hit* hitOut);
-        int getBlockIndex(int x, int y, int z);
-        void removeBlock(int index);
-        void buildInstanceBuffer();
+        void blockRaytrace(Segment ray, Hit* hitOut);
+        // Position of a face within its chunk, from local coordinates
+        static UINT getFaceKey(int x, int y, int z, int face);
+        // Give each visible face of a block a slot, and free the slots of faces that are now hidden. Needs instanceMutex.
+        void updateInstance(int x, int y, int z);
+        // An edit can change what's visible of the block and its six neighbours, and nothing else
+        void updateInstancesAround(int x, int y, int z);
+        // Fill the instance array from scratch, only needed when the world is first made
+        void buildInstances();
+        // Copy the changed slots to the GPU, growing the buffers if needed. Render thread only.
+        void uploadInstances();
+        // Upload the baked block textures, or decode and pack them, making their mips on the CPU so nothing needs the immediate context
+        void loadBlockTextures();
         void handleCharacterCollision(Character& character);
     public:
         WorldManager();
@@ -51,7 +92,10 @@ class WorldManager
         void initialise(HWND* windowHandle, ID3D11Device* device, ID3D11DeviceContext* immediateContext);
         void addBlock(int x, int y, int z, Block value);
         void removeBlock(int x, int y, int z);
-        std::unique_ptr<Block>& getBlock(int x, int y, int z);
+        const Block* getBlock(int x, int y, int z);
+        // A consistent view of the world as of the last update that changed it
+        // Take it on the update thread, after which it can be read from any thread
+        std::shared_ptr<const WorldSnapshot> getSnapshot() const;
         void renderFrame(float deltaTime, std::vector<ID3D11Buffer*>& constantBuffers, ID3D11BlendState* blendState);
         void update(float deltaTime);
         void setCameraAspectRatio(UINT width, UINT height);
@@ -0,0 +1,27 @@
+#pragma once
+
+#include "ChunkMap.hpp"
+
+// An immutable view of the world at one published version
+// Chunks are shared with the map until it next edits them, so holding a snapshot is cheap
+// and it can be read from any thread while the world carries on changing
+class WorldSnapshot
+{
+    public:
+        typedef std::unordered_map<ChunkCoordinate, std::shared_ptr<const Chunk>, ChunkCoordinateHash> ChunkTable;
+    private:
+        uint64_t version;
+        ChunkTable chunks;
+    public:
+        WorldSnapshot(uint64_t version, ChunkTable chunks);
+
+        uint64_t getVersion() const;
+
+        const Block* getBlock(int x, int y, int z) const;
+        bool isSolid(int x, int y, int z) const;
+
+        // Returns nullptr if the chunk has no blocks
+        const Chunk* getChunk(ChunkCoordinate coordinate) const;
+        const ChunkTable& getChunks() const;
+        std::size_t getChunkCount() const;
+};
@@ -14,16 +14,18 @@ cbuffer PixelConstantBuffer
     float3 padding;
 };
 
+// Origin of the chunk being drawn, in blocks
+cbuffer ChunkConstantBuffer : register(b2)
+{
+    int4 chunkOrigin;
+};
+
+// Packed the same way as BlockInstance
+// Bits 0-14 hold x, y and z relative to the chunk, five bits each, then the face in 15-17 and the texture in 18-31
 struct VIn
 {
-    float4 position : POSITION;
-    float4 colour : COLOR;
-    float2 texcoord : TEXCOORD;
-    float4 normal : NORMAL;
-    float4 tangent : TANGENT;
-    float4 binormal : BINORMAL;
-    float4 instancePosition : INST_POSITION;
-    uint textureId : TEXID;
+    uint instance : INSTANCE;
+    uint vertexId : SV_VertexID;
 };
 
 struct VOut
@@ -38,49 +40,92 @@ struct VOut
     uint textureId : TEXID;
 };
 
-Texture2D textures[4];
+// One layer per texture id, each with its own mips
+Texture2DArray albedoTextures : register(t0);
+Texture2DArray normalTextures : register(t1);
 SamplerState sampler0;
 
+static const float3 axes[3] = {
+    float3(1.f, 0.f, 0.f),
+    float3(0.f, 1.f, 0.f),
+    float3(0.f, 0.f, 1.f)
+};
+
+// Corners of a face, matching ChunkMesher, wound so the face points outwards
+static const float2 cornerOffsets[4] = {
+    float2(0.f, 0.f),
+    float2(1.f, 0.f),
+    float2(1.f, 1.f),
+    float2(0.f, 1.f)
+};
+static const uint positiveCorners[6] = { 0, 1, 2, 0, 2, 3 };
+static const uint negativeCorners[6] = { 0, 2, 1, 0, 3, 2 };
+
+// Empty slots in the instance buffer
+static const uint emptyFace = 7;
+
 VOut VShader(VIn input)
 {
-    float directionalDiffuse = dot(normalize(lightDirection), input.normal);
+    float3 instancePosition = float3(chunkOrigin.xyz) + float3(input.instance & 31, (input.instance >> 5) & 31, (input.instance >> 10) & 31);
+    uint face = (input.instance >> 15) & 7;
+    uint textureId = input.instance >> 18;
+
+    // Faces go -x, +x, -y, +y, -z, +z
+    uint axis = face / 2;
+    uint uAxis = (axis + 1) % 3;
+    uint vAxis = (axis + 2) % 3;
+    bool positive = (face & 1) != 0;
+
+    float2 offset = cornerOffsets[positive ? positiveCorners[input.vertexId] : negativeCorners[input.vertexId]];
+    float3 normal = axes[axis] * (positive ? 1.f : -1.f);
+    float3 position = instancePosition + normal * 0.5f + (offset.x - 0.5f) * axes[uAxis] + (offset.y - 0.5f) * axes[vAxis];
+
+    // Keep the textures upright on the sides, the same way round as the block model had them
+    float2 texcoord = offset;
+    float3 tangent = axes[uAxis];
+    float3 binormal = axes[vAxis];
+    if (axis == 0)
+    {
+        texcoord = float2(offset.y, 1.f - offset.x);
+        tangent = axes[vAxis];
+        binormal = -axes[uAxis];
+    }
+    else if (axis == 2)
+    {
+        texcoord = float2(offset.x, 1.f - offset.y);
+        binormal = -axes[vAxis];
+    }
+
+    float directionalDiffuse = dot(normalize(lightDirection.xyz), normal);
     directionalDiffuse = saturate(directionalDiffuse);
 
     VOut output;
-    output.position = mul(worldViewProjection, float4(input.position.xyz + input.instancePosition.xyz, 1.f));
-    output.worldPosition = float4(input.position.xyz + input.instancePosition.xyz, 1.f);
+    output.position = mul(worldViewProjection, float4(position, 1.f));
+    output.worldPosition = float4(position, 1.f);
     output.colour = ambientLightColour + (directionalDiffuse * directionalLightColour);
-    output.texcoord = input.texcoord;
-	output.normal = input.normal;
-    output.tangent = input.tangent;
-    output.binormal = input.binormal;
-    output.textureId = input.textureId;
+    output.texcoord = texcoord;
+    output.normal = float4(normal, 0.f);
+    output.tangent = float4(tangent, 0.f);
+    output.binormal = float4(binormal, 0.f);
+    output.textureId = textureId;
+
+    // Empty instance slots are pushed behind the near plane so nothing is drawn
+    if (face == emptyFace)
+    {
+        output.position = float4(0.f, 0.f, -1.f, 1.f);
+    }
+
     return output;
 }
 
 float4 PShader(VOut input) : SV_TARGET
 {
-    float4 textureColour;
-    float4 normalColour;
+    float3 texcoord = float3(input.texcoord, input.textureId);
+    float4 textureColour = albedoTextures.Sample(sampler0, texcoord);
+    float2 normalXY = (normalTextures.Sample(sampler0, texcoord).xy * 2.f) - 1.f;
 
-    switch (input.textureId)
-    {
-        default:
-        case 0:
-        {
-            textureColour = textures[0].Sample(sampler0, input.texcoord);
-            normalColour = textures[1].Sample(sampler0, input.texcoord);
-            break;
-        }
-        case 1:
-        {
-            textureColour = textures[2].Sample(sampler0, input.texcoord);
-            normalColour = textures[3].Sample(sampler0, input.texcoord);
-            break;
-        }
-    }
-    
-    float3 normal = (normalColour.xyz * 2.f) - 1.f;
+    // Normal maps are baked to two channels, so z is worked out from x and y
+    float3 normal = float3(normalXY, sqrt(saturate(1.f - dot(normalXY, normalXY))));
     float3x3 TBN = float3x3(input.tangent.xyz, input.binormal.xyz, input.normal.xyz);
     TBN = transpose(TBN);
     normal = mul(TBN, normal);
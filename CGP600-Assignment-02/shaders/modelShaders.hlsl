@@ -14,14 +14,14 @@ cbuffer PixelConstantBuffer
     float3 padding;
 };
 
+// Packed the same way as PackedVertex
 struct VIn
 {
-    float4 position : POSITION;
+    float4 position : POSITION; // w holds the sign of the binormal
     float4 colour : COLOR;
     float2 texcoord : TEXCOORD;
-    float4 normal : NORMAL;
-    float4 tangent : TANGENT;
-    float4 binormal : BINORMAL;
+    float2 normal : NORMAL; // Octahedral
+    float2 tangent : TANGENT; // Octahedral
 };
 
 struct VOut
@@ -38,25 +38,42 @@ struct VOut
 Texture2D textures[2];
 SamplerState sampler0;
 
+float3 octahedralDecode(float2 encoded)
+{
+    float3 result = float3(encoded, 1.f - abs(encoded.x) - abs(encoded.y));
+    if (result.z < 0.f)
+    {
+        result.xy = (1.f - abs(result.yx)) * (result.xy >= 0.f ? 1.f : -1.f);
+    }
+    return normalize(result);
+}
+
 VOut VShader(VIn input)
 {
-    float directionalDiffuse = dot(normalize(lightDirection), input.normal);
+    float3 normal = octahedralDecode(input.normal);
+    float3 tangent = octahedralDecode(input.tangent);
+    float3 binormal = cross(normal, tangent) * input.position.w;
+    float4 position = float4(input.position.xyz, 1.f);
+
+    float directionalDiffuse = dot(normalize(lightDirection.xyz), normal);
     directionalDiffuse = saturate(directionalDiffuse);
 
     VOut output;
-    output.position = mul(worldViewProjection, input.position);
-    output.worldPosition = input.position;
+    output.position = mul(worldViewProjection, position);
+    output.worldPosition = position;
     output.colour = ambientLightColour + (directionalDiffuse * directionalLightColour);
     output.texcoord = input.texcoord;
-	output.normal = input.normal.xyz;
-    output.tangent = input.tangent.xyz;
-    output.binormal = input.binormal.xyz;
+    output.normal = normal;
+    output.tangent = tangent;
+    output.binormal = binormal;
     return output;
 }
 
 float4 PShader(VOut input) : SV_TARGET
 {
-    float3 normal = (textures[1].Sample(sampler0, input.texcoord).xyz * 2.f) - 1.f;
+    // Normal maps are baked to two channels, so z is worked out from x and y
+    float2 normalXY = (textures[1].Sample(sampler0, input.texcoord).xy * 2.f) - 1.f;
+    float3 normal = float3(normalXY, sqrt(saturate(1.f - dot(normalXY, normalXY))));
     normal = (normal.x * input.tangent) + (normal.y * input.binormal) + (normal.z * input.normal);
 
     float4 pointLightDirection = pointLightPosition - input.worldPosition;
@@ -14,14 +14,14 @@ cbuffer PixelConstantBuffer
     float3 padding;
 };
 
+// Packed the same way as PackedVertex, though the sky only needs the position and texture coordinates
 struct VIn
 {
     float4 position : POSITION;
     float4 colour : COLOR;
     float2 texcoord : TEXCOORD;
-    float3 normal : NORMAL;
-    float3 tangent : TANGENT;
-    float3 binormal : BINORMAL;
+    float2 normal : NORMAL;
+    float2 tangent : TANGENT;
 };
 
 struct VOut
@@ -37,7 +37,7 @@ SamplerState sampler0;
 VOut VShader(VIn input)
 {
     VOut output;
-    output.position = mul(worldViewProjection, input.position);
+    output.position = mul(worldViewProjection, float4(input.position.xyz, 1.f));
     output.colour = input.colour;
     output.texcoord = input.texcoord;
     return output;
@@ -0,0 +1,321 @@
+#include "Assets.hpp"
+#include "ImageLoader.hpp"
+#include "TextureCompression.hpp"
+#include <filesystem>
+#include <string>
+#include <string_view>
+#include <stdio.h>
+#include <Windows.h>
+#include <WICTextureLoader.h>
+#include <DDSTextureLoader.h>
+#include <d3dcompiler.h>
+
+using namespace DirectX;
+
+MeshData::~MeshData()
+{
+    if (vertexBuffer) vertexBuffer->Release();
+    if (indexBuffer) indexBuffer->Release();
+}
+
+Texture::~Texture()
+{
+    if (view) view->Release();
+}
+
+ShaderProgram::~ShaderProgram()
+{
+    if (sampler) sampler->Release();
+    if (inputLayout) inputLayout->Release();
+    if (vertexShader) vertexShader->Release();
+    if (pixelShader) pixelShader->Release();
+}
+
+static AssetCache<MeshData> meshes;
+static AssetCache<Texture, std::wstring> textures;
+static AssetCache<ShaderProgram, std::wstring> shaderPrograms;
+
+static std::shared_ptr<MeshData> loadMesh(ID3D11Device* device, const char* fileName)
+{
+    std::shared_ptr<MeshData> mesh = std::make_shared<MeshData>();
+
+    const std::string cachePath = MeshCache::getCachePath(fileName);
+    uint64_t sourceSize = 0, sourceWriteTime = 0;
+    const bool sourceFound = MeshCache::getSourceStamp(fileName, &sourceSize, &sourceWriteTime);
+
+    // A cache that's up to date is used without touching the source, and so is one shipped without it
+    MeshCacheView cached = {};
+    const bool cacheValid = mesh->cacheFile.open(cachePath.c_str()) && MeshCache::read(mesh->cacheFile.getData(), mesh->cacheFile.getSize(), cached);
+    if (cacheValid && (!sourceFound || (cached.header->sourceSize == sourceSize && cached.header->sourceWriteTime == sourceWriteTime)))
+    {
+        mesh->view = cached;
+    }
+    else
+    {
+        MappedFile source;
+        if (!source.open(fileName))
+        {
+            OutputDebugString((std::string("#### Failed to load file: ") + std::string(fileName) + " ####\n").c_str());
+            return nullptr;
+        }
+        const uint64_t sourceHash = MeshCache::hashContent(source.getData(), source.getSize());
+
+        if (cacheValid && cached.header->sourceHash == sourceHash)
+        {
+            // Touched but not changed, so only the stamp needs bringing up to date
+            const uint8_t* cacheData = (const uint8_t*)mesh->cacheFile.getData();
+            mesh->bakedData.assign(cacheData, cacheData + mesh->cacheFile.getSize());
+        }
+        else if (!MeshCache::bake(std::string_view((const char*)source.getData(), source.getSize()), mesh->bakedData))
+        {
+            // A model that doesn't parse is never cached, so it's tried again every launch until it's fixed
+            OutputDebugString((std::string("#### Failed to parse file: ") + std::string(fileName) + " ####\n").c_str());
+            return nullptr;
+        }
+        mesh->cacheFile.close();
+
+        MeshCache::setSourceStamp(mesh->bakedData, sourceSize, sourceWriteTime);
+        if (!MeshCache::saveFile(cachePath.c_str(), mesh->bakedData))
+        {
+            OutputDebugString((std::string("#### Failed to write mesh cache: ") + cachePath + " ####\n").c_str());
+        }
+
+        MeshCache::read(mesh->bakedData.data(), mesh->bakedData.size(), sourceHash, mesh->view);
+    }
+
+    // Vertices were packed when the mesh was baked, so they go straight across
+    D3D11_BUFFER_DESC vertexBufferDescription;
+    ZeroMemory(&vertexBufferDescription, sizeof(vertexBufferDescription));
+    vertexBufferDescription.Usage = D3D11_USAGE_IMMUTABLE;
+    vertexBufferDescription.ByteWidth = (UINT)(mesh->view.header->vertexCount * sizeof(PackedVertex));
+    vertexBufferDescription.BindFlags = D3D11_BIND_VERTEX_BUFFER;
+
+    D3D11_SUBRESOURCE_DATA vertexData;
+    ZeroMemory(&vertexData, sizeof(vertexData));
+    vertexData.pSysMem = mesh->view.vertices;
+
+    if (FAILED(device->CreateBuffer(&vertexBufferDescription, &vertexData, &mesh->vertexBuffer)))
+    {
+        OutputDebugString("#### Failed to create vertex buffer! ####\n");
+        return nullptr;
+    }
+
+    D3D11_BUFFER_DESC indexBufferDescription;
+    ZeroMemory(&indexBufferDescription, sizeof(indexBufferDescription));
+    indexBufferDescription.Usage = D3D11_USAGE_IMMUTABLE;
+    indexBufferDescription.ByteWidth = (UINT)(mesh->view.header->indexCount * sizeof(UINT));
+    indexBufferDescription.BindFlags = D3D11_BIND_INDEX_BUFFER;
+
+    D3D11_SUBRESOURCE_DATA indexData;
+    ZeroMemory(&indexData, sizeof(indexData));
+    indexData.pSysMem = mesh->view.indices;
+
+    if (FAILED(device->CreateBuffer(&indexBufferDescription, &indexData, &mesh->indexBuffer)))
+    {
+        OutputDebugString("#### Failed to create index buffer! ####\n");
+        return nullptr;
+    }
+
+    return mesh;
+}
+
+static std::shared_ptr<Texture> loadTexture(ID3D11Device* device, const wchar_t* fileName)
+{
+    std::shared_ptr<Texture> texture = std::make_shared<Texture>();
+
+    // Baked textures are already compressed and have their mips, so they're used whenever they're up to date
+    const std::wstring bakedPath = Assets::getBakedTexturePath(fileName);
+    if (!bakedPath.empty() && SUCCEEDED(CreateDDSTextureFromFile(device, bakedPath.c_str(), NULL, &texture->view)))
+    {
+        return texture;
+    }
+
+    if (FAILED(CreateWICTextureFromFile(device, fileName, NULL, &texture->view)))
+    {
+        OutputDebugString("#### Failed to load texture! ####\n");
+        return nullptr;
+    }
+
+    return texture;
+}
+
+static ID3DBlob* compileShader(const wchar_t* path, const char* entryPoint, const char* target)
+{
+    UINT flags = D3DCOMPILE_ENABLE_STRICTNESS;
+#ifdef _DEBUG
+    flags |= D3DCOMPILE_DEBUG;
+#endif
+
+    ID3DBlob* shader = nullptr;
+    ID3DBlob* error = nullptr;
+    HRESULT result = D3DCompileFromFile(path, NULL, D3D_COMPILE_STANDARD_FILE_INCLUDE, entryPoint, target, flags, NULL, &shader, &error);
+    if (error != 0)
+    {
+        OutputDebugString((char*)error->GetBufferPointer());
+        error->Release();
+    }
+
+    if (FAILED(result))
+    {
+        if (shader) shader->Release();
+        return nullptr;
+    }
+
+    return shader;
+}
+
+static std::shared_ptr<ShaderProgram> loadShaderProgram(ID3D11Device* device, const wchar_t* path,
+    const D3D11_INPUT_ELEMENT_DESC* inputElementDescriptions, UINT descriptionCount)
+{
+    std::shared_ptr<ShaderProgram> program = std::make_shared<ShaderProgram>();
+
+    ID3DBlob* vertShader = compileShader(path, "VShader", "vs_5_0");
+    if (!vertShader)
+    {
+        OutputDebugString("#### Failed to compile vertex shader! ####\n");
+        return nullptr;
+    }
+
+    ID3DBlob* pixShader = compileShader(path, "PShader", "ps_5_0");
+    if (!pixShader)
+    {
+        OutputDebugString("#### Failed to compile pixel shader! ####\n");
+        vertShader->Release();
+        return nullptr;
+    }
+
+    HRESULT result = device->CreateVertexShader(vertShader->GetBufferPointer(), vertShader->GetBufferSize(), NULL, &program->vertexShader);
+    if (FAILED(result))
+    {
+        OutputDebugString("#### Failed to create vertex shader! ####\n");
+    }
+
+    result = device->CreatePixelShader(pixShader->GetBufferPointer(), pixShader->GetBufferSize(), NULL, &program->pixelShader);
+    if (FAILED(result))
+    {
+        OutputDebugString("#### Failed to create pixel shader! ####\n");
+    }
+
+    result = device->CreateInputLayout(
+        inputElementDescriptions,
+        descriptionCount,
+        vertShader->GetBufferPointer(),
+        vertShader->GetBufferSize(),
+        &program->inputLayout
+    );
+
+    if (FAILED(result))
+    {
+        OutputDebugString("#### Failed to create input layout! ####\n");
+    }
+
+    vertShader->Release();
+    pixShader->Release();
+
+    D3D11_SAMPLER_DESC samplerDescription;
+    ZeroMemory(&samplerDescription, sizeof(samplerDescription));
+    samplerDescription.Filter = D3D11_FILTER_ANISOTROPIC;
+    samplerDescription.AddressU = D3D11_TEXTURE_ADDRESS_WRAP;
+    samplerDescription.AddressV = D3D11_TEXTURE_ADDRESS_WRAP;
+    samplerDescription.AddressW = D3D11_TEXTURE_ADDRESS_WRAP;
+    samplerDescription.MaxLOD = D3D11_FLOAT32_MAX;
+
+    result = device->CreateSamplerState(&samplerDescription, &program->sampler);
+
+    if (FAILED(result))
+    {
+        OutputDebugString("#### Failed to create sampler state! ####\n");
+    }
+
+    if (!program->vertexShader || !program->pixelShader || !program->inputLayout) return nullptr;
+
+    return program;
+}
+
+namespace Assets
+{
+    std::shared_ptr<const MeshData> getMesh(ID3D11Device* device, const char* fileName)
+    {
+        return meshes.get(fileName, [device, fileName]() { return loadMesh(device, fileName); });
+    }
+
+    std::shared_ptr<const Texture> getTexture(ID3D11Device* device, const wchar_t* fileName)
+    {
+        return textures.get(fileName, [device, fileName]() { return loadTexture(device, fileName); });
+    }
+
+    std::shared_ptr<const ShaderProgram> getShaderProgram(ID3D11Device* device, const wchar_t* path,
+        const D3D11_INPUT_ELEMENT_DESC* inputElementDescriptions, UINT descriptionCount)
+    {
+        return shaderPrograms.get(path, [device, path, inputElementDescriptions, descriptionCount]()
+        {
+            return loadShaderProgram(device, path, inputElementDescriptions, descriptionCount);
+        });
+    }
+
+    std::wstring getBakedTexturePath(const wchar_t* fileName)
+    {
+        std::filesystem::path bakedPath(fileName);
+        bakedPath.replace_extension(".dds");
+
+        std::error_code error;
+        const std::filesystem::file_time_type bakedTime = std::filesystem::last_write_time(bakedPath, error);
+        if (error) return std::wstring();
+
+        // A missing source is fine, since the baked file can be shipped on its own
+        const std::filesystem::file_time_type sourceTime = std::filesystem::last_write_time(fileName, error);
+        if (!error && sourceTime > bakedTime) return std::wstring();
+
+        return bakedPath.wstring();
+    }
+
+    int bakeTextures(const char* directory, int quality)
+    {
+        int count = 0;
+        std::error_code error;
+
+        for (const std::filesystem::directory_entry& entry : std::filesystem::directory_iterator(directory, error))
+        {
+            if (!entry.is_regular_file() || entry.path().extension() != ".png") continue;
+
+            const std::string sourcePath = entry.path().string();
+            TextureImage image;
+            if (!ImageLoader::loadFile(entry.path().wstring().c_str(), image))
+            {
+                printf("#### Failed to load %s ####\n", sourcePath.c_str());
+                continue;
+            }
+
+            const bool normalMap = entry.path().stem().string().find("-normal") != std::string::npos;
+            const unsigned int format = normalMap ? TextureCompression::bc5Format :
+                (TextureCompression::isOpaque(image) ? TextureCompression::bc1Format : TextureCompression::bc3Format);
+
+            TextureArray array;
+            TexturePacker::pack({ image }, normalMap, array);
+            CompressedTexture texture;
+            TextureCompression::compress(array, format, quality, texture);
+
+            std::filesystem::path bakedPath = entry.path();
+            bakedPath.replace_extension(".dds");
+            const std::vector<uint8_t> baked = TextureCompression::writeDDS(texture);
+            if (!MeshCache::saveFile(bakedPath.string().c_str(), baked))
+            {
+                printf("#### Failed to write %s ####\n", bakedPath.string().c_str());
+                continue;
+            }
+
+            printf("%s: baked to %s, %zu KB from %zu KB\n", sourcePath.c_str(), bakedPath.string().c_str(), baked.size() / 1024, array.data.size() / 1024);
+            count++;
+        }
+
+        return count;
+    }
+
+    void printStatistics()
+    {
+        printf("Assets:\n");
+        printf("\tMeshes:          %3zu loaded, %llu hits, %llu misses\n", meshes.getLiveCount(), meshes.getHitCount(), meshes.getMissCount());
+        printf("\tTextures:        %3zu loaded, %llu hits, %llu misses\n", textures.getLiveCount(), textures.getHitCount(), textures.getMissCount());
+        printf("\tShader programs: %3zu loaded, %llu hits, %llu misses\n", shaderPrograms.getLiveCount(), shaderPrograms.getHitCount(), shaderPrograms.getMissCount());
+    }
+}
@@ -0,0 +1,819 @@
+#include "Benchmarks.hpp"
+#include "VoxelGrid.hpp"
+#include "ChunkMap.hpp"
+#include "ChunkMesher.hpp"
+#include "SparseVoxelOctree.hpp"
+#include "PerlinNoise.hpp"
+#include "SimplexNoise.hpp"
+#include "FractalNoise.hpp"
+#include "TerrainGenerator.hpp"
+#include "MeshOptimiser.hpp"
+#include "ObjParser.hpp"
+#include "MeshCache.hpp"
+#include "TexturePacker.hpp"
+#include "TextureCompression.hpp"
+#include "Utility.hpp"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstring>
+#include <random>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <stdio.h>
+
+namespace Benchmarks
+{
+    static double secondsSince(std::chrono::high_resolution_clock::time_point start)
+    {
+        return std::chrono::duration<double>(std::chrono::high_resolution_clock::now() - start).count();
+    }
+
+    // Sum every block in a cube around each centre, the same shape of scan as collision (radius 2) and raycast (radius 4) queries
+    // Distinct 64 byte cache lines per query stand in for cache misses, since they don't depend on the machine
+    template <typename Grid>
+    static void measureNeighbourhood(const char* name, const Grid& grid, const std::vector<int>& centres, int radius)
+    {
+        uint64_t sum = 0;
+        std::size_t lineTotal = 0;
+        std::vector<std::size_t> lines;
+
+        std::chrono::high_resolution_clock::time_point start = std::chrono::high_resolution_clock::now();
+        for (std::size_t i = 0; i < centres.size(); i += 3)
+        {
+            grid.forEachInBox(centres[i] - radius, centres[i + 1] - radius, centres[i + 2] - radius,
+                centres[i] + radius, centres[i + 1] + radius, centres[i + 2] + radius,
+                [&sum](int x, int y, int z, uint8_t value)
+            {
+                sum += value;
+            });
+        }
+        const double seconds = secondsSince(start);
+
+        for (std::size_t i = 0; i < centres.size(); i += 3)
+        {
+            lines.clear();
+            for (int z = centres[i + 2] - radius; z <= centres[i + 2] + radius; z++)
+            {
+                for (int y = centres[i + 1] - radius; y <= centres[i + 1] + radius; y++)
+                {
+                    for (int x = centres[i] - radius; x <= centres[i] + radius; x++)
+                    {
+                        lines.push_back(Grid::getIndex(x, y, z) / 64);
+                    }
+                }
+            }
+            std::sort(lines.begin(), lines.end());
+            lineTotal += std::unique(lines.begin(), lines.end()) - lines.begin();
+        }
+
+        const std::size_t queryCount = centres.size() / 3;
+        printf("\t%-8s radius %d: %8.1f ns/query, %6.1f cache lines/query (checksum %llu)\n", name, radius,
+            seconds * 1e9 / queryCount, (double)lineTotal / queryCount, (unsigned long long)sum);
+    }
+
+    void voxelGridLayout()
+    {
+        // Large enough that the grid doesn't fit in cache
+        const int size = 256;
+        const int queryCount = 100000;
+        VoxelGrid<uint8_t, size, size, size, LinearLayout> linear;
+        VoxelGrid<uint8_t, size, size, size, MortonLayout> morton;
+
+        std::mt19937 random(1234);
+        for (int z = 0; z < size; z++)
+        {
+            for (int y = 0; y < size; y++)
+            {
+                for (int x = 0; x < size; x++)
+                {
+                    const uint8_t value = (uint8_t)(random() & 1);
+                    linear.at(x, y, z) = value;
+                    morton.at(x, y, z) = value;
+                }
+            }
+        }
+
+        for (int radius = 2; radius <= 4; radius += 2)
+        {
+            std::uniform_int_distribution<int> distribution(radius, size - 1 - radius);
+            std::vector<int> centres(queryCount * 3);
+            for (int& centre : centres)
+            {
+                centre = distribution(random);
+            }
+
+            measureNeighbourhood("Linear", linear, centres, radius);
+            measureNeighbourhood("Morton", morton, centres, radius);
+        }
+    }
+
+    // Mesh the same chunk repeatedly, reporting quads against one quad per visible face
+    static void measureChunkMesh(const char* name, const Chunk& chunk)
+    {
+        const int repeats = 50;
+        ChunkMesher mesher;
+        ChunkMesh greedy, faces;
+
+        std::chrono::high_resolution_clock::time_point start = std::chrono::high_resolution_clock::now();
+        for (int i = 0; i < repeats; i++)
+        {
+            mesher.buildFaceMesh(chunk, faces);
+        }
+        const double faceSeconds = secondsSince(start) / repeats;
+
+        start = std::chrono::high_resolution_clock::now();
+        for (int i = 0; i < repeats; i++)
+        {
+            mesher.buildGreedyMesh(chunk, greedy);
+        }
+        const double greedySeconds = secondsSince(start) / repeats;
+
+        // What instanced cubes used to draw, 36 vertices for every block with a face showing
+        std::size_t cubeVertices = 0;
+        for (int i = 0; i < chunk.getWidth() * chunk.getHeight() * chunk.getDepth(); i++)
+        {
+            cubeVertices += chunk.getExposedFaces(i) ? 36 : 0;
+        }
+
+        printf("\t%-8s cubes: %7zu vertices, per face: %6zu vertices %6zu indices %7.3f ms, greedy: %6zu vertices %6zu indices %7.3f ms\n", name,
+            cubeVertices, faces.vertices.size(), faces.indices.size(), faceSeconds * 1000.0,
+            greedy.vertices.size(), greedy.indices.size(), greedySeconds * 1000.0);
+    }
+
+    void chunkMeshing()
+    {
+        const int size = ChunkMap::chunkSize;
+        std::mt19937 random(1234);
+
+        // Rolling hills with grass on top, the common case
+        ChunkMap terrain;
+        for (int z = 0; z < size; z++)
+        {
+            for (int x = 0; x < size; x++)
+            {
+                const int height = 12 + (int)(6.f * sinf(x * 0.3f) + 4.f * cosf(z * 0.2f));
+                for (int y = 0; y < height; y++)
+                {
+                    terrain.addBlock(x, y, z, { (UINT)(y == height - 1 ? 1 : 0) });
+                }
+            }
+        }
+        measureChunkMesh("Terrain", *terrain.getChunks().at({ 0, 0, 0 }));
+
+        // Half the blocks missing at random, close to the worst case
+        ChunkMap noise;
+        for (int z = 0; z < size; z++)
+        {
+            for (int y = 0; y < size; y++)
+            {
+                for (int x = 0; x < size; x++)
+                {
+                    if (random() & 1)
+                    {
+                        noise.addBlock(x, y, z, { (UINT)(random() & 1) });
+                    }
+                }
+            }
+        }
+        measureChunkMesh("Noise", *noise.getChunks().at({ 0, 0, 0 }));
+    }
+
+    void faceInstancing()
+    {
+        const int size = ChunkMap::chunkSize;
+        const int repeats = 20;
+
+        // A few chunks of hills, about the size of the generated world
+        ChunkMap terrain;
+        for (int z = 0; z < size * 4; z++)
+        {
+            for (int x = 0; x < size * 4; x++)
+            {
+                const int height = 24 + (int)(10.f * sinf(x * 0.1f) + 8.f * cosf(z * 0.07f));
+                for (int y = 0; y < height; y++)
+                {
+                    terrain.addBlock(x, y, z, { (UINT)(y == height - 1 ? 1 : 0) });
+                }
+            }
+        }
+
+        std::vector<BlockInstance> instances;
+        std::chrono::high_resolution_clock::time_point start = std::chrono::high_resolution_clock::now();
+        for (int i = 0; i < repeats; i++)
+        {
+            instances.clear();
+            for (const auto& entry : terrain.getChunks())
+            {
+                ChunkMesher::buildFaceInstances(*entry.second, instances);
+            }
+        }
+        const double seconds = secondsSince(start) / repeats;
+
+        // One cube instance for every block with any face showing
+        std::size_t blockCount = 0;
+        for (const auto& entry : terrain.getChunks())
+        {
+            const Chunk& chunk = *entry.second;
+            for (int i = 0; i < chunk.getWidth() * chunk.getHeight() * chunk.getDepth(); i++)
+            {
+                blockCount += chunk.getExposedFaces(i) ? 1 : 0;
+            }
+        }
+
+        // Cubes were a float4 position and a texture id, 20 bytes each
+        printf("\tCubes: %7zu instances %8zu vertices %8zu bytes\n", blockCount, blockCount * 36, blockCount * 20);
+        printf("\tFaces: %7zu instances %8zu vertices %8zu bytes, built in %.3f ms\n",
+            instances.size(), instances.size() * 6, instances.size() * sizeof(BlockInstance), seconds * 1000.0);
+    }
+
+    void perlinNoise()
+    {
+        const PerlinNoise perlin(42);
+        const int pointCount = 1 << 20;
+        std::vector<float> x(pointCount), y(pointCount), z(pointCount), output(pointCount);
+        std::default_random_engine random(9);
+        std::uniform_real_distribution<float> coordinate(0.f, 256.f);
+        for (int i = 0; i < pointCount; i++)
+        {
+            x[i] = coordinate(random);
+            y[i] = coordinate(random);
+            z[i] = coordinate(random);
+        }
+
+        double seconds[3];
+        for (int version = 0; version < 3; version++)
+        {
+            std::chrono::high_resolution_clock::time_point start = std::chrono::high_resolution_clock::now();
+            if (version == 0)
+            {
+                for (int i = 0; i < pointCount; i++)
+                {
+                    output[i] = perlin.noise(x[i], y[i], z[i]);
+                }
+            }
+            else if (version == 1)
+            {
+                for (int i = 0; i < pointCount; i += 8)
+                {
+                    perlin.noise8(&x[i], &y[i], &z[i], &output[i]);
+                }
+            }
+            else
+            {
+                for (int i = 0; i < pointCount; i += 16)
+                {
+                    perlin.noise16(&x[i], &y[i], &z[i], &output[i]);
+                }
+            }
+            seconds[version] = secondsSince(start);
+        }
+
+        // One chunk's worth of blocks
+        const int repeats = 10;
+        std::vector<bool> blockValues;
+        std::chrono::high_resolution_clock::time_point start = std::chrono::high_resolution_clock::now();
+        for (int i = 0; i < repeats; i++)
+        {
+            perlin.generateRegion(0, 0, 0, ChunkMap::chunkSize, ChunkMap::chunkSize, ChunkMap::chunkSize, blockValues);
+        }
+        const double regionSeconds = secondsSince(start) / repeats;
+
+        printf("\t%d points\n", pointCount);
+        printf("\tScalar:             %8.1f ms, %6.1f million points/s\n", seconds[0] * 1000.0, pointCount / seconds[0] / 1000000.0);
+        printf("\tnoise8:             %8.1f ms, %6.1f million points/s (%.1fx)\n", seconds[1] * 1000.0, pointCount / seconds[1] / 1000000.0, seconds[0] / seconds[1]);
+        printf("\tnoise16:            %8.1f ms, %6.1f million points/s (%.1fx)\n", seconds[2] * 1000.0, pointCount / seconds[2] / 1000000.0, seconds[0] / seconds[2]);
+        printf("\tOne %d^3 chunk:     %8.3f ms\n", ChunkMap::chunkSize, regionSeconds * 1000.0);
+    }
+
+    void latticeNoise()
+    {
+        // The starting world's noise a chunk at a time, at full resolution and then from coarser and coarser lattices
+        const PerlinNoise perlin(42);
+        const int size = ChunkMap::chunkSize;
+        const int chunksWide = 4, chunksHigh = 2, chunksDeep = 4;
+        const int chunkCount = chunksWide * chunksHigh * chunksDeep;
+
+        std::vector<std::vector<float>> exact(chunkCount);
+        std::chrono::high_resolution_clock::time_point start = std::chrono::high_resolution_clock::now();
+        for (int chunk = 0; chunk < chunkCount; chunk++)
+        {
+            perlin.sampleRegion(chunk % chunksWide * size, chunk / chunksWide % chunksHigh * size, chunk / (chunksWide * chunksHigh) * size, size, size, size, exact[chunk]);
+        }
+        const double exactSeconds = secondsSince(start);
+        const std::size_t voxelCount = (std::size_t)chunkCount * size * size * size;
+
+        printf("\t%d chunks, %zu voxels\n", chunkCount, voxelCount);
+        printf("\tFull resolution:    %8.1f ms\n", exactSeconds * 1000.0);
+
+        const int spacings[] = { 2, 4, 8 };
+        std::vector<float> approximate;
+        for (int spacing : spacings)
+        {
+            std::size_t samples = 0;
+            std::size_t blocksDiffering = 0;
+            double errorTotal = 0.0, maxError = 0.0;
+            double seconds = 0.0;
+
+            for (int chunk = 0; chunk < chunkCount; chunk++)
+            {
+                start = std::chrono::high_resolution_clock::now();
+                samples += perlin.sampleRegionLattice(chunk % chunksWide * size, chunk / chunksWide % chunksHigh * size, chunk / (chunksWide * chunksHigh) * size,
+                    size, size, size, spacing, approximate);
+                seconds += secondsSince(start);
+
+                for (std::size_t i = 0; i < approximate.size(); i++)
+                {
+                    const double error = fabs((double)approximate[i] - exact[chunk][i]);
+                    errorTotal += error;
+                    maxError = Utility::max(maxError, error);
+                    if ((approximate[i] > 0.5f) != (exact[chunk][i] > 0.5f))
+                    {
+                        blocksDiffering++;
+                    }
+                }
+            }
+
+            printf("\tEvery %d blocks:     %8.1f ms (%.1fx), %.1fx fewer samples, error %.5f mean, %.5f max, %.3f%% of blocks differ\n", spacing, seconds * 1000.0,
+                exactSeconds / seconds, (double)voxelCount / samples, errorTotal / voxelCount, maxError, 100.0 * blocksDiffering / voxelCount);
+        }
+    }
+
+    // Nanoseconds per call of sample(x, y, z, w) over the points, and the sum of the results so none of it is optimised away
+    template <typename Sample>
+    static double measureNoise(const std::vector<float>& points, Sample sample, double& sumOut)
+    {
+        std::chrono::high_resolution_clock::time_point start = std::chrono::high_resolution_clock::now();
+        float sum = 0.f;
+        for (std::size_t i = 0; i < points.size(); i += 4)
+        {
+            sum += sample(points[i], points[i + 1], points[i + 2], points[i + 3]);
+        }
+        sumOut += sum;
+        return secondsSince(start) * 1000000000.0 / (points.size() / 4);
+    }
+
+    void simplexNoise()
+    {
+        const PerlinNoise perlin(42);
+        const SimplexNoise simplex(42);
+        const int pointCount = 1 << 18;
+        std::vector<float> points(pointCount * 4);
+        std::default_random_engine random(9);
+        std::uniform_real_distribution<float> coordinate(0.f, 256.f);
+        for (float& point : points)
+        {
+            point = coordinate(random);
+        }
+
+        double sum = 0.0;
+        const double perlinTime = measureNoise(points, [&](float x, float y, float z, float) { return perlin.noise(x, y, z); }, sum);
+        const double simplex2Time = measureNoise(points, [&](float x, float y, float, float) { return simplex.noise(x, y); }, sum);
+        const double simplex3Time = measureNoise(points, [&](float x, float y, float z, float) { return simplex.noise(x, y, z); }, sum);
+        const double simplex4Time = measureNoise(points, [&](float x, float y, float z, float w) { return simplex.noise(x, y, z, w); }, sum);
+
+        printf("\t%d points per run\n", pointCount);
+        printf("\tPerlin 3D:          %8.1f ns per sample\n", perlinTime);
+        printf("\tSimplex 2D:         %8.1f ns per sample (%.2fx Perlin 3D)\n", simplex2Time, perlinTime / simplex2Time);
+        printf("\tSimplex 3D:         %8.1f ns per sample (%.2fx)\n", simplex3Time, perlinTime / simplex3Time);
+        printf("\tSimplex 4D:         %8.1f ns per sample (%.2fx)\n", simplex4Time, perlinTime / simplex4Time);
+
+        // Octaves multiply the cost of each, so the gap carries through to fractal terrain
+        const double perlinFbm = measureNoise(points, [&](float x, float y, float z, float) { return FractalNoise::fbm<6>(perlin, x, y, z); }, sum);
+        const double simplexFbm = measureNoise(points, [&](float x, float y, float z, float) { return FractalNoise::fbm<6>(simplex, x, y, z); }, sum);
+        const double simplexRidged = measureNoise(points, [&](float x, float y, float z, float) { return FractalNoise::ridged<6>(simplex, x, y, z); }, sum);
+        printf("\tPerlin 3D fbm x6:   %8.1f ns per sample\n", perlinFbm);
+        printf("\tSimplex 3D fbm x6:  %8.1f ns per sample (%.2fx)\n", simplexFbm, perlinFbm / simplexFbm);
+        printf("\tSimplex 3D ridged x6: %6.1f ns per sample (%.2fx)\n", simplexRidged, perlinFbm / simplexRidged);
+        printf("\tChecksum %.1f\n", sum);
+    }
+
+    void terrainGeneration()
+    {
+        // Four times the area of the starting world, on one thread and then doubling up to every core
+        const int chunksWide = 4, chunksHigh = 2, chunksDeep = 4;
+        const unsigned int maxThreads = Utility::max(std::thread::hardware_concurrency(), 1u);
+        double singleSeconds = 0.0;
+        uint64_t firstHash = 0;
+
+        for (unsigned int threadCount = 1; ; threadCount = Utility::min(threadCount * 2, maxThreads))
+        {
+            ChunkMap terrain;
+            TerrainGenerator generator(7);
+            generator.generate(chunksWide, chunksHigh, chunksDeep, threadCount, terrain);
+
+            const TerrainGenerator::Statistics& statistics = generator.getStatistics();
+            const uint64_t hash = TerrainGenerator::hashChunks(terrain);
+            if (threadCount == 1)
+            {
+                singleSeconds = statistics.totalSeconds;
+                firstHash = hash;
+                printf("\t%d chunks, %zu blocks\n", statistics.chunkCount, statistics.blockCount);
+            }
+
+            printf("\t%2u threads:         %8.1f ms, %6.1f chunks/s (%.1fx)%s\n", threadCount, statistics.totalSeconds * 1000.0,
+                statistics.chunkCount / statistics.totalSeconds, singleSeconds / statistics.totalSeconds, hash == firstHash ? "" : " (world differs!)");
+
+            if (threadCount == maxThreads) break;
+        }
+
+        // Eight chunks tall on every thread, with noise everywhere and then only around a heightmap's surface
+        const int tallChunksHigh = 8;
+        for (int mode = TerrainGenerator::fullNoiseMode; mode <= TerrainGenerator::heightmapMode; mode++)
+        {
+            TerrainGenerator::Settings settings;
+            settings.mode = mode;
+            settings.surfaceHeight = 128.f;
+
+            ChunkMap terrain;
+            TerrainGenerator generator(7, settings);
+            generator.generate(chunksWide, tallChunksHigh, chunksDeep, maxThreads, terrain);
+
+            const TerrainGenerator::Statistics& statistics = generator.getStatistics();
+            printf("\t%s %8.1f ms, %zu voxels evaluated, %zu filled, %zu points of noise\n", mode == TerrainGenerator::heightmapMode ? "Heightmap, tall:" : "Full noise, tall:",
+                statistics.totalSeconds * 1000.0, statistics.voxelsEvaluated, statistics.voxelsFilled, statistics.voxelsEvaluated + statistics.heightmapSamples);
+        }
+    }
+
+    void blockStorage()
+    {
+        // The starting world, 64 blocks each way, in chunks against an octree of the same area and the old pointer-per-block grid
+        const int size = 64;
+        const int chunksEach = size / ChunkMap::chunkSize;
+        ChunkMap blocks;
+        TerrainGenerator generator(1337);
+        generator.generate(chunksEach, chunksEach, chunksEach, 1, blocks);
+
+        int octreeLevels = 0;
+        while ((1 << octreeLevels) < size)
+        {
+            octreeLevels++;
+        }
+
+        std::chrono::high_resolution_clock::time_point start = std::chrono::high_resolution_clock::now();
+        SparseVoxelOctree octree(0, 0, 0, octreeLevels, true);
+        octree.build(blocks);
+        const double buildSeconds = secondsSince(start);
+
+        const std::size_t gridBytes = (std::size_t)size * size * size * sizeof(std::unique_ptr<Block>) + generator.getStatistics().blockCount * sizeof(Block);
+        printf("\t%zu blocks\n", generator.getStatistics().blockCount);
+        printf("\tChunks:             %8zu bytes\n", blocks.getMemoryUsage());
+        printf("\tOctree:             %8zu bytes, built in %.1f ms\n", octree.getMemoryUsage(), buildSeconds * 1000.0);
+        printf("\tPointer grid:       %8zu bytes\n", gridBytes);
+    }
+
+    void meshOptimisation()
+    {
+        // A smooth sphere as a triangle soup in a random order, like a model straight out of the OBJ loader
+        const int rings = 64;
+        const int segments = 128;
+        const float pi = 3.14159265f;
+        std::vector<std::vector<Vertex>> triangles;
+        for (int ring = 0; ring < rings; ring++)
+        {
+            for (int segment = 0; segment < segments; segment++)
+            {
+                Vertex corners[4];
+                for (int corner = 0; corner < 4; corner++)
+                {
+                    const float u = (float)(segment + ((corner == 1 || corner == 2) ? 1 : 0)) / segments;
+                    const float v = (float)(ring + ((corner >= 2) ? 1 : 0)) / rings;
+                    const float x = sinf(v * pi) * cosf(u * 2.f * pi);
+                    const float y = cosf(v * pi);
+                    const float z = sinf(v * pi) * sinf(u * 2.f * pi);
+
+                    corners[corner] = Vertex();
+                    corners[corner].position = DirectX::XMFLOAT4(x, y, z, 1.f);
+                    corners[corner].colour = DirectX::XMFLOAT4(1.f, 1.f, 1.f, 1.f);
+                    corners[corner].textureCoord = DirectX::XMFLOAT2(u, v);
+                    corners[corner].normal = DirectX::XMFLOAT4(x, y, z, 0.f);
+                }
+                triangles.push_back({ corners[0], corners[1], corners[2] });
+                triangles.push_back({ corners[0], corners[2], corners[3] });
+            }
+        }
+        std::shuffle(triangles.begin(), triangles.end(), std::mt19937(1234));
+
+        std::vector<Vertex> vertices;
+        for (const std::vector<Vertex>& triangle : triangles)
+        {
+            vertices.insert(vertices.end(), triangle.begin(), triangle.end());
+        }
+        const std::size_t unweldedCount = vertices.size();
+
+        std::chrono::high_resolution_clock::time_point start = std::chrono::high_resolution_clock::now();
+        std::vector<UINT> indices = MeshOptimiser::weldVertices(vertices);
+        const double weldSeconds = secondsSince(start);
+        const float weldedACMR = MeshOptimiser::calculateACMR(indices, vertices.size());
+
+        start = std::chrono::high_resolution_clock::now();
+        MeshOptimiser::optimiseVertexCache(indices, vertices.size());
+        const double cacheSeconds = secondsSince(start);
+
+        start = std::chrono::high_resolution_clock::now();
+        MeshOptimiser::optimiseVertexFetch(vertices, indices);
+        const double fetchSeconds = secondsSince(start);
+
+        printf("\tSphere: %zu triangles, %zu vertices welded to %zu in %.3f ms\n", triangles.size(), unweldedCount, vertices.size(), weldSeconds * 1000.0);
+        printf("\tACMR (16 entry FIFO): 3.000 unindexed, %.3f welded, %.3f optimised in %.3f ms, fetch order in %.3f ms\n",
+            weldedACMR, MeshOptimiser::calculateACMR(indices, vertices.size()), cacheSeconds * 1000.0, fetchSeconds * 1000.0);
+        printf("\tACMR (32 entry FIFO): %.3f optimised\n", MeshOptimiser::calculateACMR(indices, vertices.size(), 32));
+    }
+
+    // The loader as it was before ObjParser, a getline and two splits per face corner
+    static void parseObjWithSplit(const std::string& text, ObjData& dataOut)
+    {
+        dataOut = ObjData();
+        std::istringstream file(text);
+
+        std::string line;
+        while (std::getline(file, line))
+        {
+            std::vector<std::string> data = Utility::split(line, ' ');
+
+            if (data[0] == "v")
+            {
+                for (int i = 1; i <= 3; i++)
+                {
+                    dataOut.positions.push_back((float)std::atof(data[i].c_str()));
+                }
+            }
+            else if (data[0] == "vt")
+            {
+                for (int i = 1; i <= 2; i++)
+                {
+                    dataOut.textureCoords.push_back((float)std::atof(data[i].c_str()));
+                }
+            }
+            else if (data[0] == "vn")
+            {
+                for (int i = 1; i <= 3; i++)
+                {
+                    dataOut.normals.push_back((float)std::atof(data[i].c_str()));
+                }
+            }
+            else if (data[0] == "f")
+            {
+                for (int i = 1; i <= 3; i++)
+                {
+                    std::vector<std::string> vertexData = Utility::split(data[i], '/');
+                    dataOut.corners.push_back({ std::atoi(vertexData[0].c_str()) - 1, std::atoi(vertexData[1].c_str()) - 1, std::atoi(vertexData[2].c_str()) - 1 });
+                }
+            }
+        }
+    }
+
+    void objParsing()
+    {
+        // A rippled grid of a million vertices and two million triangles, written the way exporters write them
+        const int size = 1000;
+        std::string text;
+        text.reserve(128u * 1024u * 1024u);
+        char line[128];
+
+        for (int y = 0; y <= size; y++)
+        {
+            for (int x = 0; x <= size; x++)
+            {
+                snprintf(line, sizeof(line), "v %.6f %.6f %.6f\nvt %.6f %.6f\n", x * 0.01f, sinf(x * 0.1f) * cosf(y * 0.1f), y * 0.01f, (float)x / size, (float)y / size);
+                text += line;
+            }
+        }
+        text += "vn 0.000000 1.000000 0.000000\n";
+        for (int y = 0; y < size; y++)
+        {
+            for (int x = 0; x < size; x++)
+            {
+                const int corner = y * (size + 1) + x + 1;
+                snprintf(line, sizeof(line), "f %d/%d/1 %d/%d/1 %d/%d/1\nf %d/%d/1 %d/%d/1 %d/%d/1\n",
+                    corner, corner, corner + size + 1, corner + size + 1, corner + size + 2, corner + size + 2,
+                    corner, corner, corner + size + 2, corner + size + 2, corner + 1, corner + 1);
+                text += line;
+            }
+        }
+
+        ObjData legacy, single, threaded;
+        const unsigned int threadCount = Utility::max(std::thread::hardware_concurrency(), 1u);
+
+        std::chrono::high_resolution_clock::time_point start = std::chrono::high_resolution_clock::now();
+        parseObjWithSplit(text, legacy);
+        const double legacySeconds = secondsSince(start);
+
+        start = std::chrono::high_resolution_clock::now();
+        ObjParser::parse(text, single, 1);
+        const double singleSeconds = secondsSince(start);
+
+        start = std::chrono::high_resolution_clock::now();
+        ObjParser::parse(text, threaded, threadCount);
+        const double threadedSeconds = secondsSince(start);
+
+        const bool matches = legacy.positions == single.positions && legacy.corners.size() == single.corners.size() && single.positions == threaded.positions;
+        printf("\t%.1f MB, %zu triangles%s\n", text.size() / (1024.0 * 1024.0), single.corners.size() / 3, matches ? "" : " (results differ!)");
+        printf("\tSplit and atof:     %8.1f ms\n", legacySeconds * 1000.0);
+        printf("\tObjParser:          %8.1f ms (%.1fx)\n", singleSeconds * 1000.0, legacySeconds / singleSeconds);
+        printf("\tObjParser, %2u threads: %5.1f ms (%.1fx)\n", threadCount, threadedSeconds * 1000.0, legacySeconds / threadedSeconds);
+    }
+
+    void meshCacheLoading()
+    {
+        // A smaller version of the objParsing grid, since baking also welds and optimises it
+        const int size = 300;
+        std::string text;
+        char line[128];
+
+        for (int y = 0; y <= size; y++)
+        {
+            for (int x = 0; x <= size; x++)
+            {
+                snprintf(line, sizeof(line), "v %.6f %.6f %.6f\nvt %.6f %.6f\n", x * 0.01f, sinf(x * 0.1f) * cosf(y * 0.1f), y * 0.01f, (float)x / size, (float)y / size);
+                text += line;
+            }
+        }
+        text += "vn 0.000000 1.000000 0.000000\n";
+        for (int y = 0; y < size; y++)
+        {
+            for (int x = 0; x < size; x++)
+            {
+                const int corner = y * (size + 1) + x + 1;
+                snprintf(line, sizeof(line), "f %d/%d/1 %d/%d/1 %d/%d/1 %d/%d/1\n",
+                    corner, corner, corner + size + 1, corner + size + 1, corner + size + 2, corner + size + 2, corner + 1, corner + 1);
+                text += line;
+            }
+        }
+
+        std::chrono::high_resolution_clock::time_point start = std::chrono::high_resolution_clock::now();
+        std::vector<uint8_t> baked;
+        MeshBuildStatistics statistics;
+        MeshCache::bake(text, baked, &statistics);
+        const double bakeSeconds = secondsSince(start);
+
+        // What a warm start does: compare the source's size and write time with the header, then copy everything into the vertex and index buffers
+        MeshCache::setSourceStamp(baked, text.size(), 1);
+        start = std::chrono::high_resolution_clock::now();
+        MeshCacheView view;
+        const bool valid = MeshCache::read(baked.data(), baked.size(), view) && view.header->sourceSize == text.size() && view.header->sourceWriteTime == 1;
+        std::vector<uint8_t> upload(baked.size() - sizeof(MeshCacheHeader));
+        if (valid)
+        {
+            memcpy(upload.data(), view.vertices, upload.size());
+        }
+        const double loadSeconds = secondsSince(start);
+
+        // What it did before the stamp, when the whole source was hashed every time
+        start = std::chrono::high_resolution_clock::now();
+        const uint64_t hash = MeshCache::hashContent(text.data(), text.size());
+        const bool hashValid = MeshCache::read(baked.data(), baked.size(), hash, view);
+        const double hashSeconds = secondsSince(start) + loadSeconds;
+
+        printf("\t%.1f MB of OBJ baked to %.1f MB%s\n", text.size() / (1024.0 * 1024.0), baked.size() / (1024.0 * 1024.0), valid && hashValid ? "" : " (cache rejected!)");
+        printf("\t%zu vertices welded to %zu, ACMR %.3f welded, %.3f optimised\n", statistics.unweldedVertexCount, statistics.vertexCount, statistics.weldedACMR, statistics.optimisedACMR);
+        printf("\tParse and bake:     %8.1f ms\n", bakeSeconds * 1000.0);
+        printf("\tHash and load:      %8.1f ms (%.1fx)\n", hashSeconds * 1000.0, bakeSeconds / hashSeconds);
+        printf("\tStamp and load:     %8.1f ms (%.1fx)\n", loadSeconds * 1000.0, bakeSeconds / loadSeconds);
+    }
+
+    void textureMips()
+    {
+        // A full chain for a 1024x1024 texture, each mip made from the last
+        TextureImage base;
+        base.width = 1024;
+        base.height = 1024;
+        base.pixels.resize(base.width * base.height * 4);
+        std::default_random_engine random(3);
+        std::uniform_int_distribution<int> byte(0, 255);
+        for (uint8_t& value : base.pixels)
+        {
+            value = (uint8_t)byte(random);
+        }
+
+        const int repeats = 20;
+        double seconds[2] = {};
+
+        for (int version = 0; version < 2; version++)
+        {
+            std::chrono::high_resolution_clock::time_point start = std::chrono::high_resolution_clock::now();
+            for (int repeat = 0; repeat < repeats; repeat++)
+            {
+                TextureImage previous = base, next;
+                while (previous.width > 1 || previous.height > 1)
+                {
+                    if (version == 0)
+                    {
+                        TexturePacker::downsampleReference(previous, next, false);
+                    }
+                    else
+                    {
+                        TexturePacker::downsample(previous, next, false);
+                    }
+                    std::swap(previous, next);
+                }
+            }
+            seconds[version] = secondsSince(start) / repeats;
+        }
+
+        TextureImage reference, fast;
+        TexturePacker::downsampleReference(base, reference, false);
+        TexturePacker::downsample(base, fast, false);
+        const bool matches = reference.pixels == fast.pixels;
+
+        printf("\t1024x1024 mip chain%s\n", matches ? "" : " (results differ!)");
+        printf("\tScalar:             %8.3f ms\n", seconds[0] * 1000.0);
+        printf("\tSSE2:               %8.3f ms (%.1fx)\n", seconds[1] * 1000.0, seconds[0] / seconds[1]);
+    }
+
+    void textureCompression()
+    {
+        // A 512x512 image of smooth gradients with some grain, which is what block textures mostly are
+        TextureImage image;
+        image.width = 512;
+        image.height = 512;
+        image.pixels.resize(image.width * image.height * 4);
+        std::default_random_engine random(5);
+        std::uniform_int_distribution<int> noise(-8, 8);
+        for (unsigned int y = 0; y < image.height; y++)
+        {
+            for (unsigned int x = 0; x < image.width; x++)
+            {
+                uint8_t* pixel = &image.pixels[(y * image.width + x) * 4];
+                pixel[0] = (uint8_t)Utility::clamp((int)(128 + 100 * sinf(x * 0.05f)) + noise(random), 0, 255);
+                pixel[1] = (uint8_t)Utility::clamp((int)(128 + 100 * cosf(y * 0.03f)) + noise(random), 0, 255);
+                pixel[2] = (uint8_t)Utility::clamp((int)((x + y) / 4) + noise(random), 0, 255);
+                pixel[3] = 255;
+            }
+        }
+
+        const double megapixels = image.width * image.height / 1000000.0;
+        const unsigned int formats[] = { TextureCompression::bc1Format, TextureCompression::bc5Format };
+        const char* names[] = { "BC1", "BC5" };
+        const unsigned int channelCounts[] = { 3, 2 };
+
+        printf("\t512x512, %zu KB uncompressed\n", image.pixels.size() / 1024);
+        for (int i = 0; i < 2; i++)
+        {
+            for (int quality = 0; quality <= TextureCompression::maxQuality; quality++)
+            {
+                const int repeats = 5;
+                std::vector<uint8_t> compressed;
+                std::chrono::high_resolution_clock::time_point start = std::chrono::high_resolution_clock::now();
+                for (int repeat = 0; repeat < repeats; repeat++)
+                {
+                    compressed = TextureCompression::compressImage(image, formats[i], quality);
+                }
+                const double seconds = secondsSince(start) / repeats;
+
+                TextureImage decompressed;
+                TextureCompression::decompressImage(compressed.data(), image.width, image.height, formats[i], decompressed);
+                printf("\t%s quality %d:    %8.1f ms, %6.1f MPixels/s, %4zu KB, %.2f dB\n", names[i], quality, seconds * 1000.0, megapixels / seconds,
+                    compressed.size() / 1024, TextureCompression::calculatePSNR(image, decompressed, channelCounts[i]));
+            }
+        }
+    }
+
+    void runBenchmarks()
+    {
+        printf("Benchmarks:\n");
+
+        // World
+        printf("Voxel grid layout:\n");
+        voxelGridLayout();
+
+        printf("Chunk meshing:\n");
+        chunkMeshing();
+
+        printf("Face instancing:\n");
+        faceInstancing();
+
+        printf("Perlin noise:\n");
+        perlinNoise();
+
+        printf("Lattice noise:\n");
+        latticeNoise();
+
+        printf("Simplex noise:\n");
+        simplexNoise();
+
+        printf("Terrain generation:\n");
+        terrainGeneration();
+
+        printf("Block storage:\n");
+        blockStorage();
+
+        // Models
+        printf("Mesh optimisation:\n");
+        meshOptimisation();
+
+        printf("OBJ parsing:\n");
+        objParsing();
+
+        printf("Mesh cache loading:\n");
+        meshCacheLoading();
+
+        // Textures
+        printf("Texture mips:\n");
+        textureMips();
+
+        printf("Texture compression:\n");
+        textureCompression();
+    }
+}
@@ -2,8 +2,7 @@
 
 BlockObject::BlockObject(ID3D11Device* device, ID3D11DeviceContext* immediateContext)
 {
-    mesh.loadFromFile("models/block.obj");
-	mesh.initialiseVertexBuffer(device, immediateContext);
+    mesh.loadFromFile(device, "models/block.obj");
 
     setSize(DirectX::XMVectorSet(1.f, 1.f, 1.f, 0.f));
 }
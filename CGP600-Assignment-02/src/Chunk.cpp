@@ -0,0 +1,516 @@
+#include "Chunk.hpp"
+#include "Compression.hpp"
+#include "Occupancy.hpp"
+
+UINT Chunk::getPaletteIndex(int index) const
+{
+    const std::size_t bit = (std::size_t)index * bitsPerBlock;
+    const uint64_t mask = (1ull << bitsPerBlock) - 1ull;
+
+    return (UINT)((data[bit >> 6] >> (bit & 63)) & mask);
+}
+
+void Chunk::setPaletteIndex(int index, UINT value)
+{
+    const std::size_t bit = (std::size_t)index * bitsPerBlock;
+    const uint64_t mask = (1ull << bitsPerBlock) - 1ull;
+
+    uint64_t& word = data[bit >> 6];
+    word &= ~(mask << (bit & 63));
+    word |= ((uint64_t)value & mask) << (bit & 63);
+}
+
+UINT Chunk::findOrAddPaletteEntry(Block value)
+{
+    // Re-use an existing entry if the value is already in the palette
+    for (UINT i = 1; i < (UINT)palette.size(); i++)
+    {
+        if (paletteCounts[i] > 0 && palette[i] == value)
+        {
+            return i;
+        }
+    }
+
+    // Fill a gap left by a value that is no longer used
+    if (!freePaletteEntries.empty())
+    {
+        UINT paletteIndex = freePaletteEntries.back();
+        freePaletteEntries.pop_back();
+        palette[paletteIndex] = value;
+        return paletteIndex;
+    }
+
+    // Widen the indices if the new entry won't fit
+    // A chunk can never hold more than 2^16 distinct values in practice, so 16 bits is the ceiling
+    if (palette.size() >= (1ull << bitsPerBlock) && bitsPerBlock < 16)
+    {
+        resizeData(bitsPerBlock * 2);
+    }
+
+    palette.push_back(value);
+    paletteCounts.push_back(0);
+    return (UINT)palette.size() - 1;
+}
+
+void Chunk::releasePaletteEntry(UINT paletteIndex)
+{
+    if (paletteIndex == 0) return;
+
+    paletteCounts[paletteIndex]--;
+    if (paletteCounts[paletteIndex] == 0)
+    {
+        freePaletteEntries.push_back(paletteIndex);
+    }
+}
+
+void Chunk::resizeData(UINT bits)
+{
+    ensureDecompressed();
+
+    // Unpack with the old width, then repack with the new one
+    const int blockTotal = width * height * depth;
+    std::vector<UINT> unpacked(blockTotal);
+    for (int i = 0; i < blockTotal; i++)
+    {
+        unpacked[i] = getPaletteIndex(i);
+    }
+
+    bitsPerBlock = bits;
+    data.assign(((std::size_t)blockTotal * bitsPerBlock + 63) / 64, 0);
+
+    for (int i = 0; i < blockTotal; i++)
+    {
+        setPaletteIndex(i, unpacked[i]);
+    }
+}
+
+void Chunk::ensureDecompressed() const
+{
+    if (compressed.load(std::memory_order_acquire))
+    {
+        decompress();
+    }
+}
+
+int Chunk::getNeighbourIndex(int index, int face) const
+{
+    const int coordinates[3] = { index % width, (index / width) % height, index / (width * height) };
+    const int extents[3] = { width, height, depth };
+    const int strides[3] = { 1, width, width * height };
+
+    const int axis = face / 2;
+    if (face & 1)
+    {
+        return (coordinates[axis] + 1 < extents[axis]) ? index + strides[axis] : -1;
+    }
+
+    return (coordinates[axis] > 0) ? index - strides[axis] : -1;
+}
+
+Chunk::Chunk(int width, int height, int depth) :
+    width(width),
+    height(height),
+    depth(depth),
+    palette(1, Block{ 0 }),
+    paletteCounts(1, 0),
+    compressed(false)
+{
+    data.assign(((std::size_t)width * height * depth * bitsPerBlock + 63) / 64, 0);
+    occupancy.assign(((std::size_t)width * height * depth + 63) / 64, 0);
+    for (int face = 0; face < faceCount; face++)
+    {
+        exposure[face].assign(occupancy.size(), 0);
+    }
+}
+
+Chunk::Chunk(const Chunk& other) :
+    width(other.width),
+    height(other.height),
+    depth(other.depth),
+    palette(other.palette),
+    paletteCounts(other.paletteCounts),
+    freePaletteEntries(other.freePaletteEntries),
+    bitsPerBlock(other.bitsPerBlock),
+    blockCount(other.blockCount),
+    occupancy(other.occupancy),
+    lastAccess(other.lastAccess)
+{
+    for (int face = 0; face < faceCount; face++)
+    {
+        exposure[face] = other.exposure[face];
+    }
+
+    // Another thread may be inflating the original while it's copied
+    std::lock_guard<std::mutex> guard(other.decompressionMutex);
+    data = other.data;
+    compressedData = other.compressedData;
+    compressed.store(other.compressed.load());
+}
+
+int Chunk::getWidth() const
+{
+    return width;
+}
+
+int Chunk::getHeight() const
+{
+    return height;
+}
+
+int Chunk::getDepth() const
+{
+    return depth;
+}
+
+int Chunk::getBlockIndex(int x, int y, int z) const
+{
+    return x + width * (y + height * z);
+}
+
+void Chunk::addBlock(int index, Block value)
+{
+    ensureDecompressed();
+
+    UINT previous = getPaletteIndex(index);
+    if (previous != 0 && palette[previous] == value) return;
+
+    // Look up the new value before releasing the old one, so a block never frees its own entry
+    UINT paletteIndex = findOrAddPaletteEntry(value);
+    paletteCounts[paletteIndex]++;
+
+    if (previous == 0)
+    {
+        blockCount++;
+        Occupancy::setBit(occupancy, index, true);
+
+        // The new block hides the faces of its neighbours, and shows its own where there's nothing beside it
+        for (int face = 0; face < faceCount; face++)
+        {
+            const int neighbour = getNeighbourIndex(index, face);
+            if (neighbour >= 0 && Occupancy::testBit(occupancy, neighbour))
+            {
+                Occupancy::setBit(exposure[face ^ 1], neighbour, false);
+            }
+            else
+            {
+                Occupancy::setBit(exposure[face], index, true);
+            }
+        }
+    }
+    else
+    {
+        releasePaletteEntry(previous);
+    }
+
+    setPaletteIndex(index, paletteIndex);
+}
+
+void Chunk::addBlock(int x, int y, int z, Block value)
+{
+    addBlock(getBlockIndex(x, y, z), value);
+}
+
+void Chunk::removeBlock(int index)
+{
+    ensureDecompressed();
+
+    UINT previous = getPaletteIndex(index);
+    if (previous == 0) return;
+
+    releasePaletteEntry(previous);
+    blockCount--;
+    Occupancy::setBit(occupancy, index, false);
+    setPaletteIndex(index, 0);
+
+    // Uncover the neighbours' faces that were against this block
+    for (int face = 0; face < faceCount; face++)
+    {
+        Occupancy::setBit(exposure[face], index, false);
+
+        const int neighbour = getNeighbourIndex(index, face);
+        if (neighbour >= 0 && Occupancy::testBit(occupancy, neighbour))
+        {
+            Occupancy::setBit(exposure[face ^ 1], neighbour, true);
+        }
+    }
+}
+
+void Chunk::removeBlock(int x, int y, int z)
+{
+    removeBlock(getBlockIndex(x, y, z));
+}
+
+const Block* Chunk::getBlock(int index) const
+{
+    ensureDecompressed();
+
+    UINT paletteIndex = getPaletteIndex(index);
+    return paletteIndex == 0 ? nullptr : &palette[paletteIndex];
+}
+
+const Block* Chunk::getBlock(int x, int y, int z) const
+{
+    return getBlock(getBlockIndex(x, y, z));
+}
+
+bool Chunk::isSolid(int index) const
+{
+    return Occupancy::testBit(occupancy, index);
+}
+
+bool Chunk::isSolid(int x, int y, int z) const
+{
+    return isSolid(getBlockIndex(x, y, z));
+}
+
+const std::vector<uint64_t>& Chunk::getOccupancy() const
+{
+    return occupancy;
+}
+
+UINT Chunk::getExposedFaces(int index) const
+{
+    UINT faces = 0;
+    for (int face = 0; face < faceCount; face++)
+    {
+        faces |= (UINT)Occupancy::testBit(exposure[face], index) << face;
+    }
+
+    return faces;
+}
+
+UINT Chunk::getExposedFaces(int x, int y, int z) const
+{
+    return getExposedFaces(getBlockIndex(x, y, z));
+}
+
+const std::vector<uint64_t>& Chunk::getExposure(int face) const
+{
+    return exposure[face];
+}
+
+void Chunk::setFaceExposed(int index, int face, bool exposed)
+{
+    Occupancy::setBit(exposure[face], index, exposed);
+}
+
+void Chunk::refreshExposure(int face, const uint64_t* neighbours)
+{
+    Occupancy::andNotBits(exposure[face].data(), occupancy.data(), neighbours, occupancy.size());
+}
+
+bool Chunk::isEmpty() const
+{
+    return blockCount == 0;
+}
+
+UINT Chunk::getBlockCount() const
+{
+    return blockCount;
+}
+
+UINT Chunk::getBitsPerBlock() const
+{
+    return bitsPerBlock;
+}
+
+std::size_t Chunk::getPaletteSize() const
+{
+    return palette.size();
+}
+
+bool Chunk::inflate(std::vector<uint64_t>& decodedOut) const
+{
+    const std::size_t wordCount = ((std::size_t)width * height * depth * bitsPerBlock + 63) / 64;
+
+    std::size_t position = 0;
+    uint32_t runsSize = 0;
+    std::vector<uint8_t> runs;
+    if (!Compression::readVarint(compressedData.data(), compressedData.size(), &position, &runsSize) ||
+        !Compression::lzDecompress(compressedData.data() + position, compressedData.size() - position, runsSize, runs))
+    {
+        return false;
+    }
+
+    // The data starts zeroed, so only the non-air runs need to be written
+    decodedOut.assign(wordCount, 0);
+    const uint64_t mask = (1ull << bitsPerBlock) - 1ull;
+    std::size_t runPosition = 0;
+    int x = 0, y = 0, z = 0;
+    uint32_t value, length;
+    while (runPosition < runs.size())
+    {
+        if (!Compression::readVarint(runs.data(), runs.size(), &runPosition, &value) ||
+            !Compression::readVarint(runs.data(), runs.size(), &runPosition, &length))
+        {
+            return false;
+        }
+
+        for (uint32_t i = 0; i < length; i++)
+        {
+            // Runs past the end of the chunk mean the data is corrupt
+            if (z == depth) return false;
+
+            if (value != 0)
+            {
+                const std::size_t bit = (std::size_t)getBlockIndex(x, y, z) * bitsPerBlock;
+                decodedOut[bit >> 6] |= ((uint64_t)value & mask) << (bit & 63);
+            }
+
+            // Step down the column, then across x, then along z
+            if (++y == height)
+            {
+                y = 0;
+                if (++x == width)
+                {
+                    x = 0;
+                    z++;
+                }
+            }
+        }
+    }
+
+    // As would runs that stop short of it
+    return z == depth;
+}
+
+void Chunk::compress()
+{
+    if (compressed) return;
+
+    // Terrain is mostly solid at the bottom of a column and air at the top, so runs go down columns
+    std::vector<uint8_t> runs;
+    UINT runValue = getPaletteIndex(0);
+    uint32_t runLength = 0;
+
+    for (int z = 0; z < depth; z++)
+    {
+        for (int x = 0; x < width; x++)
+        {
+            for (int y = 0; y < height; y++)
+            {
+                UINT value = getPaletteIndex(getBlockIndex(x, y, z));
+                if (value == runValue)
+                {
+                    runLength++;
+                    continue;
+                }
+
+                Compression::writeVarint(runs, runValue);
+                Compression::writeVarint(runs, runLength);
+                runValue = value;
+                runLength = 1;
+            }
+        }
+    }
+    Compression::writeVarint(runs, runValue);
+    Compression::writeVarint(runs, runLength);
+
+    compressedData = Compression::lzCompress(runs.data(), runs.size());
+    // Keep the uncompressed size in front so decompression can size its buffer
+    std::vector<uint8_t> header;
+    Compression::writeVarint(header, (uint32_t)runs.size());
+    compressedData.insert(compressedData.begin(), header.begin(), header.end());
+    compressedData.shrink_to_fit();
+
+    // Only let go of the indices once they're known to come back the same
+    std::vector<uint64_t> check;
+    if (!inflate(check) || check != data)
+    {
+        OutputDebugString("#### Chunk didn't survive compression, keeping it uncompressed ####\n");
+        compressedData.clear();
+        compressedData.shrink_to_fit();
+        return;
+    }
+
+    data.clear();
+    data.shrink_to_fit();
+    compressed.store(true, std::memory_order_release);
+}
+
+void Chunk::decompress() const
+{
+    std::lock_guard<std::mutex> guard(decompressionMutex);
+    if (!compressed.load(std::memory_order_acquire)) return;
+
+    std::vector<uint64_t> decoded;
+    if (!inflate(decoded))
+    {
+        // compress() checks its output, so this is memory going bad underneath it
+        // The occupancy was never compressed, so every solid block stays solid as the most used value, and nothing else has to change
+        OutputDebugString("#### Failed to decompress chunk, filling its solid blocks with one value ####\n");
+
+        UINT fill = 0;
+        for (UINT i = 1; i < (UINT)paletteCounts.size(); i++)
+        {
+            if (fill == 0 || paletteCounts[i] > paletteCounts[fill])
+            {
+                fill = i;
+            }
+        }
+
+        decoded.assign(((std::size_t)width * height * depth * bitsPerBlock + 63) / 64, 0);
+        const int blockTotal = width * height * depth;
+        for (int index = 0; index < blockTotal; index++)
+        {
+            if (Occupancy::testBit(occupancy, index))
+            {
+                const std::size_t bit = (std::size_t)index * bitsPerBlock;
+                decoded[bit >> 6] |= (uint64_t)fill << (bit & 63);
+            }
+        }
+
+        freePaletteEntries.clear();
+        for (UINT i = 1; i < (UINT)paletteCounts.size(); i++)
+        {
+            paletteCounts[i] = (i == fill) ? blockCount : 0;
+            if (i != fill)
+            {
+                freePaletteEntries.push_back(i);
+            }
+        }
+    }
+    data.swap(decoded);
+
+    compressedData.clear();
+    compressedData.shrink_to_fit();
+
+    // Readers that skip the lock only look at the data after seeing this
+    compressed.store(false, std::memory_order_release);
+}
+
+bool Chunk::isCompressed() const
+{
+    return compressed.load(std::memory_order_acquire);
+}
+
+void Chunk::setLastAccess(uint64_t tick) const
+{
+    lastAccess = tick;
+}
+
+uint64_t Chunk::getLastAccess() const
+{
+    return lastAccess;
+}
+
+std::size_t Chunk::getUncompressedSize() const
+{
+    return (((std::size_t)width * height * depth * bitsPerBlock + 63) / 64) * sizeof(uint64_t);
+}
+
+std::size_t Chunk::getCompressedSize() const
+{
+    std::lock_guard<std::mutex> guard(decompressionMutex);
+    return compressedData.size();
+}
+
+std::size_t Chunk::getMemoryUsage() const
+{
+    std::lock_guard<std::mutex> guard(decompressionMutex);
+    return data.size() * sizeof(uint64_t) +
+        compressedData.size() +
+        occupancy.size() * sizeof(uint64_t) * (1 + faceCount) +
+        palette.size() * (sizeof(Block) + sizeof(UINT)) +
+        freePaletteEntries.size() * sizeof(UINT);
+}
@@ -0,0 +1,359 @@
+#include "ChunkMap.hpp"
+#include "WorldSnapshot.hpp"
+#include <algorithm>
+#include <chrono>
+
+static int floorDivide(int value, int divisor)
+{
+    return (value >= 0) ? (value / divisor) : ((value - divisor + 1) / divisor);
+}
+
+void ChunkMap::touch(const Chunk* chunk) const
+{
+    chunk->setLastAccess(++accessClock);
+
+    if (chunk->isCompressed())
+    {
+        std::chrono::high_resolution_clock::time_point start = std::chrono::high_resolution_clock::now();
+        chunk->decompress();
+        decompressionSeconds += std::chrono::duration<double>(std::chrono::high_resolution_clock::now() - start).count();
+        decompressionCount++;
+    }
+}
+
+Chunk* ChunkMap::makeWritable(std::shared_ptr<Chunk>& chunk)
+{
+    // Only this thread makes snapshots, so a count of one can't go up behind our back
+    if (chunk.use_count() > 1)
+    {
+        chunk = std::make_shared<Chunk>(*chunk);
+    }
+
+    return chunk.get();
+}
+
+void ChunkMap::updateBorderExposure(int x, int y, int z, Chunk* chunk)
+{
+    const int local[3] = { getLocalCoordinate(x), getLocalCoordinate(y), getLocalCoordinate(z) };
+    const int index = chunk->getBlockIndex(local[0], local[1], local[2]);
+    const bool solid = chunk->isSolid(index);
+
+    for (int face = 0; face < Chunk::faceCount; face++)
+    {
+        const int axis = face / 2;
+        const int direction = (face & 1) ? 1 : -1;
+
+        // Faces inside the chunk were already handled by the chunk itself
+        if (local[axis] != (direction > 0 ? chunkSize - 1 : 0)) continue;
+
+        int neighbour[3] = { x, y, z };
+        neighbour[axis] += direction;
+        auto adjoining = chunks.find(getChunkCoordinate(neighbour[0], neighbour[1], neighbour[2]));
+        if (adjoining == chunks.end()) continue;
+
+        const int neighbourIndex = adjoining->second->getBlockIndex(
+            getLocalCoordinate(neighbour[0]), getLocalCoordinate(neighbour[1]), getLocalCoordinate(neighbour[2]));
+        if (!adjoining->second->isSolid(neighbourIndex)) continue;
+
+        // The chunk assumed air on the other side, so only a solid neighbour changes anything
+        if (solid)
+        {
+            chunk->setFaceExposed(index, face, false);
+        }
+        makeWritable(adjoining->second)->setFaceExposed(neighbourIndex, face ^ 1, !solid);
+    }
+}
+
+void ChunkMap::refreshChunkExposure(ChunkCoordinate coordinate)
+{
+    const Occupancy::FaceMasks& masks = getFaceMasks();
+    std::vector<uint64_t> neighbours(masks.wordCount);
+
+    auto iterator = chunks.find(coordinate);
+    Chunk* chunk = (iterator == chunks.end()) ? nullptr : makeWritable(iterator->second);
+
+    for (int face = 0; face < Chunk::faceCount; face++)
+    {
+        const int axis = face / 2;
+        const int direction = (face & 1) ? 1 : -1;
+
+        ChunkCoordinate adjoiningCoordinate = coordinate;
+        (axis == 0 ? adjoiningCoordinate.x : axis == 1 ? adjoiningCoordinate.y : adjoiningCoordinate.z) += direction;
+        auto adjoining = chunks.find(adjoiningCoordinate);
+        Chunk* adjoiningChunk = (adjoining == chunks.end()) ? nullptr : adjoining->second.get();
+
+        if (chunk)
+        {
+            Occupancy::neighbourBits(neighbours.data(), masks, chunk->getOccupancy().data(),
+                adjoiningChunk ? adjoiningChunk->getOccupancy().data() : nullptr, axis, direction);
+            chunk->refreshExposure(face, neighbours.data());
+        }
+
+        if (adjoiningChunk)
+        {
+            Occupancy::neighbourBits(neighbours.data(), masks, adjoiningChunk->getOccupancy().data(),
+                chunk ? chunk->getOccupancy().data() : nullptr, axis, -direction);
+            makeWritable(adjoining->second)->refreshExposure(face ^ 1, neighbours.data());
+        }
+    }
+}
+
+ChunkCoordinate ChunkMap::getChunkCoordinate(int x, int y, int z)
+{
+    return { floorDivide(x, chunkSize), floorDivide(y, chunkSize), floorDivide(z, chunkSize) };
+}
+
+int ChunkMap::getLocalCoordinate(int value)
+{
+    return value - floorDivide(value, chunkSize) * chunkSize;
+}
+
+void ChunkMap::addBlock(int x, int y, int z, Block value)
+{
+    Chunk* chunk = getOrCreateChunk(getChunkCoordinate(x, y, z));
+    const bool wasSolid = chunk->isSolid(getLocalCoordinate(x), getLocalCoordinate(y), getLocalCoordinate(z));
+    chunk->addBlock(getLocalCoordinate(x), getLocalCoordinate(y), getLocalCoordinate(z), value);
+
+    if (!wasSolid)
+    {
+        updateBorderExposure(x, y, z, chunk);
+    }
+}
+
+void ChunkMap::removeBlock(int x, int y, int z)
+{
+    ChunkCoordinate coordinate = getChunkCoordinate(x, y, z);
+    auto iterator = chunks.find(coordinate);
+    if (iterator == chunks.end()) return;
+
+    touch(iterator->second.get());
+    if (!iterator->second->isSolid(getLocalCoordinate(x), getLocalCoordinate(y), getLocalCoordinate(z))) return;
+
+    Chunk* chunk = makeWritable(iterator->second);
+    chunk->removeBlock(getLocalCoordinate(x), getLocalCoordinate(y), getLocalCoordinate(z));
+    updateBorderExposure(x, y, z, chunk);
+
+    // Drop chunks that have been dug out completely so they cost nothing to skip
+    if (iterator->second->isEmpty())
+    {
+        chunks.erase(iterator);
+    }
+}
+
+const Block* ChunkMap::getBlock(int x, int y, int z) const
+{
+    const Chunk* chunk = getChunk(getChunkCoordinate(x, y, z));
+    if (!chunk) return nullptr;
+
+    return chunk->getBlock(getLocalCoordinate(x), getLocalCoordinate(y), getLocalCoordinate(z));
+}
+
+bool ChunkMap::isSolid(int x, int y, int z) const
+{
+    auto iterator = chunks.find(getChunkCoordinate(x, y, z));
+    if (iterator == chunks.end()) return false;
+
+    return iterator->second->isSolid(getLocalCoordinate(x), getLocalCoordinate(y), getLocalCoordinate(z));
+}
+
+UINT ChunkMap::getExposedFaces(int x, int y, int z) const
+{
+    auto iterator = chunks.find(getChunkCoordinate(x, y, z));
+    if (iterator == chunks.end()) return 0;
+
+    return iterator->second->getExposedFaces(getLocalCoordinate(x), getLocalCoordinate(y), getLocalCoordinate(z));
+}
+
+Chunk* ChunkMap::getChunk(ChunkCoordinate coordinate)
+{
+    auto iterator = chunks.find(coordinate);
+    if (iterator == chunks.end()) return nullptr;
+
+    touch(iterator->second.get());
+    return makeWritable(iterator->second);
+}
+
+const Chunk* ChunkMap::getChunk(ChunkCoordinate coordinate) const
+{
+    auto iterator = chunks.find(coordinate);
+    if (iterator == chunks.end()) return nullptr;
+
+    touch(iterator->second.get());
+    return iterator->second.get();
+}
+
+Chunk* ChunkMap::getOrCreateChunk(ChunkCoordinate coordinate)
+{
+    std::shared_ptr<Chunk>& chunk = chunks[coordinate];
+    if (!chunk)
+    {
+        chunk = std::make_shared<Chunk>(chunkSize, chunkSize, chunkSize);
+    }
+
+    touch(chunk.get());
+    return makeWritable(chunk);
+}
+
+void ChunkMap::setChunk(ChunkCoordinate coordinate, std::unique_ptr<Chunk> chunk)
+{
+    setGeneratedChunk(coordinate, std::move(chunk));
+    refreshChunkExposure(coordinate);
+}
+
+void ChunkMap::setGeneratedChunk(ChunkCoordinate coordinate, std::unique_ptr<Chunk> chunk)
+{
+    if (!chunk || chunk->isEmpty())
+    {
+        chunks.erase(coordinate);
+    }
+    else
+    {
+        chunk->setLastAccess(++accessClock);
+        chunks[coordinate] = std::move(chunk);
+    }
+}
+
+const ChunkMap::ChunkTable& ChunkMap::getChunks() const
+{
+    return chunks;
+}
+
+const Occupancy::FaceMasks& ChunkMap::getFaceMasks()
+{
+    static const Occupancy::FaceMasks masks = Occupancy::buildFaceMasks(chunkSize, chunkSize, chunkSize);
+    return masks;
+}
+
+void ChunkMap::findInteriorBlocks(ChunkCoordinate coordinate, std::vector<uint64_t>& interiorOut, std::vector<uint64_t>& uncoveredOut) const
+{
+    const std::size_t count = getFaceMasks().wordCount;
+
+    interiorOut.assign(count, 0);
+    uncoveredOut.assign(count, 0);
+
+    auto iterator = chunks.find(coordinate);
+    if (iterator == chunks.end()) return;
+
+    // Interior blocks are the solid ones with no faces showing
+    const Chunk& chunk = *iterator->second;
+    interiorOut = chunk.getOccupancy();
+    for (int face = 0; face < Chunk::faceCount; face++)
+    {
+        Occupancy::andNotBits(interiorOut.data(), interiorOut.data(), chunk.getExposure(face).data(), count);
+    }
+
+    // Blocks with air above them are the ones that get grass
+    uncoveredOut = chunk.getExposure(Chunk::topFace);
+}
+
+std::size_t ChunkMap::getChunkCount() const
+{
+    return chunks.size();
+}
+
+std::size_t ChunkMap::getMemoryUsage() const
+{
+    std::size_t result = 0;
+
+    for (const auto& chunk : chunks)
+    {
+        result += chunk.second->getMemoryUsage();
+    }
+
+    return result;
+}
+
+void ChunkMap::setMemoryBudget(std::size_t bytes)
+{
+    memoryBudget = bytes;
+}
+
+std::size_t ChunkMap::getMemoryBudget() const
+{
+    return memoryBudget;
+}
+
+void ChunkMap::enforceMemoryBudget()
+{
+    // Only the block indices are ever compressed, so they're all the budget covers
+    std::size_t blockDataBytes = 0;
+    std::vector<std::shared_ptr<Chunk>*> candidates;
+
+    for (auto& chunk : chunks)
+    {
+        if (chunk.second->isCompressed())
+        {
+            blockDataBytes += chunk.second->getCompressedSize();
+        }
+        else
+        {
+            blockDataBytes += chunk.second->getUncompressedSize();
+            candidates.push_back(&chunk.second);
+        }
+    }
+
+    if (blockDataBytes <= memoryBudget) return;
+
+    // Oldest first
+    std::sort(candidates.begin(), candidates.end(), [](const std::shared_ptr<Chunk>* a, const std::shared_ptr<Chunk>* b)
+    {
+        return (*a)->getLastAccess() < (*b)->getLastAccess();
+    });
+
+    for (std::shared_ptr<Chunk>* chunk : candidates)
+    {
+        if (blockDataBytes <= memoryBudget) break;
+
+        // Snapshots keep reading their own copy, and the memory comes back once they let go of it
+        Chunk* writable = makeWritable(*chunk);
+        writable->compress();
+        if (writable->isCompressed())
+        {
+            blockDataBytes -= writable->getUncompressedSize() - writable->getCompressedSize();
+        }
+    }
+}
+
+CompressionStatistics ChunkMap::getCompressionStatistics() const
+{
+    CompressionStatistics statistics = { 0, 0, 0, decompressionCount, decompressionSeconds };
+
+    for (const auto& chunk : chunks)
+    {
+        if (chunk.second->isCompressed())
+        {
+            statistics.compressedBytes += chunk.second->getMemoryUsage();
+            statistics.compressedChunkCount++;
+        }
+        else
+        {
+            statistics.uncompressedBytes += chunk.second->getMemoryUsage();
+        }
+    }
+
+    return statistics;
+}
+
+void ChunkMap::publish()
+{
+    version++;
+}
+
+std::shared_ptr<const WorldSnapshot> ChunkMap::getSnapshot() const
+{
+    if (version == 0) return nullptr;
+
+    // Only built when asked for, since holding one makes the next edit to each chunk copy it first
+    if (!snapshot || snapshot->getVersion() != version)
+    {
+        WorldSnapshot::ChunkTable snapshotChunks(chunks.begin(), chunks.end());
+        snapshot = std::make_shared<WorldSnapshot>(version, std::move(snapshotChunks));
+    }
+
+    return snapshot;
+}
+
+uint64_t ChunkMap::getVersion() const
+{
+    return version;
+}
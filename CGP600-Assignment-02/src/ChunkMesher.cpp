@@ -0,0 +1,196 @@
+#include "ChunkMesher.hpp"
+#include "Occupancy.hpp"
+
+void ChunkMesher::buildMask(const Chunk& chunk, int face, int slice)
+{
+    // The slice runs across the two axes after the face's own
+    const int axis = face / 2;
+    const int uAxis = (axis + 1) % 3;
+    const int vAxis = (axis + 2) % 3;
+    const int extents[3] = { chunk.getWidth(), chunk.getHeight(), chunk.getDepth() };
+    const std::vector<uint64_t>& exposure = chunk.getExposure(face);
+
+    mask.assign((std::size_t)extents[uAxis] * extents[vAxis], 0);
+
+    int coordinates[3];
+    coordinates[axis] = slice;
+    for (int v = 0; v < extents[vAxis]; v++)
+    {
+        coordinates[vAxis] = v;
+        for (int u = 0; u < extents[uAxis]; u++)
+        {
+            coordinates[uAxis] = u;
+            const int index = chunk.getBlockIndex(coordinates[0], coordinates[1], coordinates[2]);
+            if (Occupancy::testBit(exposure, index))
+            {
+                mask[u + extents[uAxis] * v] = chunk.getBlock(index)->textureId + 1;
+            }
+        }
+    }
+}
+
+void ChunkMesher::addQuad(ChunkMesh& meshOut, int face, int slice, int u, int v, int width, int height, UINT textureId) const
+{
+    const int axis = face / 2;
+    const int uAxis = (axis + 1) % 3;
+    const int vAxis = (axis + 2) % 3;
+    const bool positive = (face & 1) != 0;
+
+    // Positive faces sit on the far side of their blocks
+    float corner[3];
+    corner[axis] = (float)(slice + (positive ? 1 : 0));
+    corner[uAxis] = (float)u;
+    corner[vAxis] = (float)v;
+
+    const UINT first = (UINT)meshOut.vertices.size();
+    const float offsets[4][2] = { { 0.f, 0.f }, { (float)width, 0.f }, { (float)width, (float)height }, { 0.f, (float)height } };
+    for (int i = 0; i < 4; i++)
+    {
+        float position[3] = { corner[0], corner[1], corner[2] };
+        position[uAxis] += offsets[i][0];
+        position[vAxis] += offsets[i][1];
+
+        ChunkVertex vertex;
+        vertex.x = position[0];
+        vertex.y = position[1];
+        vertex.z = position[2];
+        vertex.u = offsets[i][0];
+        vertex.v = offsets[i][1];
+        vertex.faceAndTexture = (UINT)face | (textureId << 3);
+        meshOut.vertices.push_back(vertex);
+    }
+
+    // u cross v points along the positive axis, so negative faces wind the other way to stay clockwise from outside
+    const UINT positiveOrder[6] = { 0, 1, 2, 0, 2, 3 };
+    const UINT negativeOrder[6] = { 0, 2, 1, 0, 3, 2 };
+    for (int i = 0; i < 6; i++)
+    {
+        meshOut.indices.push_back(first + (positive ? positiveOrder[i] : negativeOrder[i]));
+    }
+}
+
+void ChunkMesher::buildGreedyMesh(const Chunk& chunk, ChunkMesh& meshOut)
+{
+    meshOut.vertices.clear();
+    meshOut.indices.clear();
+
+    const int extents[3] = { chunk.getWidth(), chunk.getHeight(), chunk.getDepth() };
+
+    for (int face = 0; face < Chunk::faceCount; face++)
+    {
+        const int axis = face / 2;
+        const int uExtent = extents[(axis + 1) % 3];
+        const int vExtent = extents[(axis + 2) % 3];
+
+        for (int slice = 0; slice < extents[axis]; slice++)
+        {
+            buildMask(chunk, face, slice);
+
+            for (int v = 0; v < vExtent; v++)
+            {
+                for (int u = 0; u < uExtent;)
+                {
+                    const UINT value = mask[u + uExtent * v];
+                    if (value == 0)
+                    {
+                        u++;
+                        continue;
+                    }
+
+                    // Grow along u as far as the texture matches
+                    int width = 1;
+                    while (u + width < uExtent && mask[u + width + uExtent * v] == value)
+                    {
+                        width++;
+                    }
+
+                    // Then along v while every face in the next row matches too
+                    int height = 1;
+                    for (; v + height < vExtent; height++)
+                    {
+                        bool rowMatches = true;
+                        for (int i = 0; i < width && rowMatches; i++)
+                        {
+                            rowMatches = mask[u + i + uExtent * (v + height)] == value;
+                        }
+                        if (!rowMatches) break;
+                    }
+
+                    addQuad(meshOut, face, slice, u, v, width, height, value - 1);
+
+                    // Clear the covered faces so they aren't used again
+                    for (int j = 0; j < height; j++)
+                    {
+                        for (int i = 0; i < width; i++)
+                        {
+                            mask[u + i + uExtent * (v + j)] = 0;
+                        }
+                    }
+
+                    u += width;
+                }
+            }
+        }
+    }
+}
+
+void ChunkMesher::buildFaceMesh(const Chunk& chunk, ChunkMesh& meshOut)
+{
+    meshOut.vertices.clear();
+    meshOut.indices.clear();
+
+    const int extents[3] = { chunk.getWidth(), chunk.getHeight(), chunk.getDepth() };
+
+    for (int face = 0; face < Chunk::faceCount; face++)
+    {
+        const int axis = face / 2;
+        const int uExtent = extents[(axis + 1) % 3];
+        const int vExtent = extents[(axis + 2) % 3];
+
+        for (int slice = 0; slice < extents[axis]; slice++)
+        {
+            buildMask(chunk, face, slice);
+
+            for (int v = 0; v < vExtent; v++)
+            {
+                for (int u = 0; u < uExtent; u++)
+                {
+                    const UINT value = mask[u + uExtent * v];
+                    if (value != 0)
+                    {
+                        addQuad(meshOut, face, slice, u, v, 1, 1, value - 1);
+                    }
+                }
+            }
+        }
+    }
+}
+
+void ChunkMesher::buildFaceInstances(const Chunk& chunk, std::vector<BlockInstance>& instancesOut)
+{
+    // Any block with a face showing has a bit in at least one of the sets
+    std::vector<uint64_t> exposed = chunk.getExposure(0);
+    for (int face = 1; face < Chunk::faceCount; face++)
+    {
+        Occupancy::orBits(exposed.data(), exposed.data(), chunk.getExposure(face).data(), exposed.size());
+    }
+
+    const int width = chunk.getWidth();
+    const int height = chunk.getHeight();
+    Occupancy::forEachBit(exposed, [&](int index)
+    {
+        const UINT x = (UINT)(index % width);
+        const UINT y = (UINT)((index / width) % height);
+        const UINT z = (UINT)(index / (width * height));
+        const UINT textureId = chunk.getBlock(index)->textureId;
+
+        const UINT faces = chunk.getExposedFaces(index);
+        for (int face = 0; face < Chunk::faceCount; face++)
+        {
+            if (faces & (1u << face))
+            {
+                instancesOut.push_back(BlockInstance::encode(x, y, z, (UINT)face, textureId));
+            }
+        }
+    });
+}
@@ -0,0 +1,170 @@
+#include "Compression.hpp"
+#include <cstring>
+
+namespace Compression
+{
+    static const std::size_t minimumMatch = 4;
+    static const std::size_t maximumOffset = 65535;
+    static const int hashBits = 12;
+
+    static uint32_t hashSequence(const uint8_t* input)
+    {
+        uint32_t sequence;
+        memcpy(&sequence, input, sizeof(sequence));
+        return (sequence * 2654435761u) >> (32 - hashBits);
+    }
+
+    // Lengths of 15 or more spill into extra bytes of 255 until the remainder fits
+    static void writeLength(std::vector<uint8_t>& output, std::size_t length)
+    {
+        while (length >= 255)
+        {
+            output.push_back(255);
+            length -= 255;
+        }
+        output.push_back((uint8_t)length);
+    }
+
+    static bool readLength(const uint8_t* input, std::size_t size, std::size_t* position, std::size_t* length)
+    {
+        uint8_t byte;
+        do
+        {
+            if (*position >= size) return false;
+            byte = input[(*position)++];
+            *length += byte;
+        } while (byte == 255);
+
+        return true;
+    }
+
+    static void writeSequence(std::vector<uint8_t>& output, const uint8_t* literals, std::size_t literalLength, std::size_t offset, std::size_t matchLength)
+    {
+        const std::size_t encodedMatch = matchLength ? matchLength - minimumMatch : 0;
+        uint8_t token = (uint8_t)(((literalLength < 15 ? literalLength : 15) << 4) | (encodedMatch < 15 ? encodedMatch : 15));
+        output.push_back(token);
+
+        if (literalLength >= 15)
+        {
+            writeLength(output, literalLength - 15);
+        }
+        output.insert(output.end(), literals, literals + literalLength);
+
+        // The final sequence is literals only
+        if (matchLength == 0) return;
+
+        output.push_back((uint8_t)(offset & 0xFF));
+        output.push_back((uint8_t)(offset >> 8));
+        if (encodedMatch >= 15)
+        {
+            writeLength(output, encodedMatch - 15);
+        }
+    }
+
+    void writeVarint(std::vector<uint8_t>& output, uint32_t value)
+    {
+        while (value >= 0x80)
+        {
+            output.push_back((uint8_t)(value | 0x80));
+            value >>= 7;
+        }
+        output.push_back((uint8_t)value);
+    }
+
+    bool readVarint(const uint8_t* input, std::size_t size, std::size_t* position, uint32_t* value)
+    {
+        *value = 0;
+        for (int shift = 0; shift < 35; shift += 7)
+        {
+            if (*position >= size) return false;
+
+            uint8_t byte = input[(*position)++];
+            *value |= (uint32_t)(byte & 0x7F) << shift;
+            if ((byte & 0x80) == 0) return true;
+        }
+
+        return false;
+    }
+
+    std::vector<uint8_t> lzCompress(const uint8_t* input, std::size_t size)
+    {
+        std::vector<uint8_t> output;
+        output.reserve(size / 2 + 16);
+
+        // Most recent position of each hashed 4-byte sequence
+        std::vector<std::size_t> table((std::size_t)1 << hashBits, SIZE_MAX);
+
+        std::size_t literalStart = 0;
+        std::size_t position = 0;
+
+        while (position + minimumMatch <= size)
+        {
+            uint32_t hash = hashSequence(input + position);
+            std::size_t candidate = table[hash];
+            table[hash] = position;
+
+            if (candidate != SIZE_MAX && position - candidate <= maximumOffset &&
+                memcmp(input + candidate, input + position, minimumMatch) == 0)
+            {
+                std::size_t matchLength = minimumMatch;
+                while (position + matchLength < size && input[candidate + matchLength] == input[position + matchLength])
+                {
+                    matchLength++;
+                }
+
+                writeSequence(output, input + literalStart, position - literalStart, position - candidate, matchLength);
+
+                position += matchLength;
+                literalStart = position;
+                continue;
+            }
+
+            position++;
+        }
+
+        writeSequence(output, input + literalStart, size - literalStart, 0, 0);
+
+        return output;
+    }
+
+    bool lzDecompress(const uint8_t* input, std::size_t size, std::size_t expectedSize, std::vector<uint8_t>& output)
+    {
+        output.clear();
+        output.reserve(expectedSize);
+
+        std::size_t position = 0;
+        while (position < size)
+        {
+            uint8_t token = input[position++];
+
+            std::size_t literalLength = token >> 4;
+            if (literalLength == 15 && !readLength(input, size, &position, &literalLength)) return false;
+            if (position + literalLength > size || output.size() + literalLength > expectedSize) return false;
+
+            output.insert(output.end(), input + position, input + position + literalLength);
+            position += literalLength;
+
+            // Literals only means this was the last sequence
+            if (position == size) break;
+
+            if (position + 2 > size) return false;
+            std::size_t offset = (std::size_t)input[position] | ((std::size_t)input[position + 1] << 8);
+            position += 2;
+
+            std::size_t matchLength = token & 0x0F;
+            if (matchLength == 15 && !readLength(input, size, &position, &matchLength)) return false;
+            matchLength += minimumMatch;
+
+            if (offset == 0 || offset > output.size() || output.size() + matchLength > expectedSize) return false;
+
+            // Byte by byte, since a match may overlap the bytes it's producing
+            std::size_t source = output.size() - offset;
+            for (std::size_t i = 0; i < matchLength; i++)
+            {
+                output.push_back(output[source + i]);
+            }
+        }
+
+        return output.size() == expectedSize;
+    }
+}
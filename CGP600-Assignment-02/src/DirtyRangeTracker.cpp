@@ -0,0 +1,75 @@
+#include "DirtyRangeTracker.hpp"
+#include <algorithm>
+
+void DirtyRangeTracker::markDirty(UINT index)
+{
+    markDirty(index, index + 1);
+}
+
+void DirtyRangeTracker::markDirty(UINT begin, UINT end)
+{
+    if (begin >= end) return;
+
+    // First range that ends at or after the new one starts, so could touch it
+    auto first = std::lower_bound(ranges.begin(), ranges.end(), begin, [](const DirtyRange& range, UINT value)
+    {
+        return range.end < value;
+    });
+
+    // Swallow every range the new one overlaps or touches
+    auto last = first;
+    while (last != ranges.end() && last->begin <= end)
+    {
+        if (last->begin < begin) begin = last->begin;
+        if (last->end > end) end = last->end;
+        last++;
+    }
+
+    first = ranges.erase(first, last);
+    ranges.insert(first, DirtyRange{ begin, end });
+}
+
+void DirtyRangeTracker::coalesce(UINT gap)
+{
+    if (ranges.empty()) return;
+
+    std::size_t output = 0;
+    for (std::size_t i = 1; i < ranges.size(); i++)
+    {
+        if (ranges[i].begin - ranges[output].end <= gap)
+        {
+            ranges[output].end = ranges[i].end;
+        }
+        else
+        {
+            ranges[++output] = ranges[i];
+        }
+    }
+    ranges.resize(output + 1);
+}
+
+void DirtyRangeTracker::clear()
+{
+    ranges.clear();
+}
+
+const std::vector<DirtyRange>& DirtyRangeTracker::getRanges() const
+{
+    return ranges;
+}
+
+bool DirtyRangeTracker::isEmpty() const
+{
+    return ranges.empty();
+}
+
+UINT DirtyRangeTracker::getDirtyCount() const
+{
+    UINT count = 0;
+    for (const DirtyRange& range : ranges)
+    {
+        count += range.end - range.begin;
+    }
+
+    return count;
+}
@@ -0,0 +1,37 @@
+#include "ImageLoader.hpp"
+#include <Windows.h>
+#include <wincodec.h>
+
+namespace ImageLoader
+{
+    bool loadFile(const wchar_t* fileName, TextureImage& output)
+    {
+        // Startup tasks run on threads that haven't used COM yet
+        const HRESULT comResult = CoInitializeEx(nullptr, COINIT_MULTITHREADED);
+
+        IWICImagingFactory* factory = nullptr;
+        IWICBitmapDecoder* decoder = nullptr;
+        IWICBitmapFrameDecode* frame = nullptr;
+        IWICFormatConverter* converter = nullptr;
+        bool result = false;
+
+        if (SUCCEEDED(CoCreateInstance(CLSID_WICImagingFactory, nullptr, CLSCTX_INPROC_SERVER, IID_PPV_ARGS(&factory))) &&
+            SUCCEEDED(factory->CreateDecoderFromFilename(fileName, nullptr, GENERIC_READ, WICDecodeMetadataCacheOnDemand, &decoder)) &&
+            SUCCEEDED(decoder->GetFrame(0, &frame)) &&
+            SUCCEEDED(factory->CreateFormatConverter(&converter)) &&
+            SUCCEEDED(converter->Initialize(frame, GUID_WICPixelFormat32bppRGBA, WICBitmapDitherTypeNone, nullptr, 0.0, WICBitmapPaletteTypeCustom)) &&
+            SUCCEEDED(converter->GetSize(&output.width, &output.height)))
+        {
+            output.pixels.resize((std::size_t)output.width * output.height * 4);
+            result = SUCCEEDED(converter->CopyPixels(nullptr, output.width * 4, (UINT)output.pixels.size(), output.pixels.data()));
+        }
+
+        if (converter) converter->Release();
+        if (frame) frame->Release();
+        if (decoder) decoder->Release();
+        if (factory) factory->Release();
+        if (SUCCEEDED(comResult)) CoUninitialize();
+
+        return result;
+    }
+}
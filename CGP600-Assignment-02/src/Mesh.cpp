@@ -1,67 +1,49 @@
 #include "Mesh.hpp"
-#include "Utility.hpp"
-#include <fstream>
-#include <sstream>
-#include <string>
 #include <Windows.h>
-#include <WICTextureLoader.h>
-#include <d3dcompiler.h>
 
 using namespace DirectX;
 
-HRESULT Mesh::initialiseVertexBuffer(ID3D11Device* device, ID3D11DeviceContext* immediateContext)
+ID3D11Buffer* Mesh::getVertexBuffer(UINT* vertexCount) const
 {
 	std::lock_guard<std::mutex> lock(mutex);
 
-    D3D11_BUFFER_DESC vertexBufferDescription;
-    ZeroMemory(&vertexBufferDescription, sizeof(vertexBufferDescription));
-    vertexBufferDescription.Usage = D3D11_USAGE_DYNAMIC;
-    vertexBufferDescription.ByteWidth = (UINT)(vertices.size() * sizeof(Vertex));
-    vertexBufferDescription.BindFlags = D3D11_BIND_VERTEX_BUFFER;
-    vertexBufferDescription.CPUAccessFlags = D3D11_CPU_ACCESS_WRITE;
-
-    HRESULT result = device->CreateBuffer(&vertexBufferDescription, NULL, &vertexBuffer);
-
-    if (FAILED(result))
+    if (!meshData)
     {
-        OutputDebugString("#### Failed to create vertex buffer! ####\n");
-        return result;
+        *vertexCount = 0;
+        return nullptr;
     }
 
-    D3D11_MAPPED_SUBRESOURCE mappedSubresource;
-    immediateContext->Map(vertexBuffer, NULL, D3D11_MAP_WRITE_DISCARD, NULL, &mappedSubresource);
-    memcpy(mappedSubresource.pData, vertices.data(), vertices.size() * sizeof(Vertex));
-    immediateContext->Unmap(vertexBuffer, NULL);
-
-    return S_OK;
+    *vertexCount = meshData->view.header->vertexCount;
+    return meshData->vertexBuffer;
 }
 
-ID3D11Buffer* Mesh::getVertexBuffer(UINT* vertexCount) const
+ID3D11Buffer* Mesh::getIndexBuffer(UINT* indexCount) const
 {
 	std::lock_guard<std::mutex> lock(mutex);
 
-    *vertexCount = (UINT)vertices.size();
-    return vertexBuffer;
+    if (!meshData)
+    {
+        *indexCount = 0;
+        return nullptr;
+    }
+
+    *indexCount = meshData->view.header->indexCount;
+    return meshData->indexBuffer;
 }
 
 HRESULT Mesh::loadTexture(ID3D11Device* device, const wchar_t* fileName, const wchar_t* normalMapFileName)
 {
-	std::lock_guard<std::mutex> lock(mutex);
+    std::shared_ptr<const Texture> loadedTexture = Assets::getTexture(device, fileName);
+    std::shared_ptr<const Texture> loadedNormalMap = Assets::getTexture(device, normalMapFileName);
 
-    HRESULT result = CreateWICTextureFromFile(device, fileName, NULL, &texture);
+	std::lock_guard<std::mutex> lock(mutex);
+    texture = loadedTexture;
+    normalMap = loadedNormalMap;
 
-    if (FAILED(result))
+    if (!texture || !normalMap)
     {
         OutputDebugString("#### Failed to load texture! ####\n");
-        return result;
-    }
-
-    result = CreateWICTextureFromFile(device, normalMapFileName, NULL, &normalMap);
-
-    if (FAILED(result))
-    {
-        OutputDebugString("#### Failed to load normal map! ####\n");
-        return result;
+        return E_FAIL;
     }
 
     return S_OK;
@@ -70,108 +52,41 @@ HRESULT Mesh::loadTexture(ID3D11Device* device, const wchar_t* fileName, const w
 ID3D11ShaderResourceView* Mesh::getTexture() const
 {
 	std::lock_guard<std::mutex> lock(mutex);
-    return texture;
+    return texture ? texture->view : nullptr;
 }
 
 ID3D11ShaderResourceView* Mesh::getNormalMap() const
 {
 	std::lock_guard<std::mutex> lock(mutex);
-    return normalMap;
+    return normalMap ? normalMap->view : nullptr;
 }
 
 void Mesh::loadShaders(LPWSTR path, ID3D11Device* device, D3D11_INPUT_ELEMENT_DESC* inputElementDescriptions, UINT descriptionCount)
 {
-	std::lock_guard<std::mutex> lock(mutex);
-
-    ID3DBlob* vertShader = nullptr;
-    ID3DBlob* pixShader = nullptr;
-    ID3DBlob* error = nullptr;
-
-    UINT flags = D3DCOMPILE_ENABLE_STRICTNESS;
-#ifdef _DEBUG
-    flags |= D3DCOMPILE_DEBUG;
-#endif
-
-    // Vertex shader compile
-    HRESULT result = D3DCompileFromFile(path, NULL, D3D_COMPILE_STANDARD_FILE_INCLUDE, "VShader", "vs_5_0", flags, NULL, &vertShader, &error);
-    if (error != 0)
+    std::shared_ptr<const ShaderProgram> loadedProgram = Assets::getShaderProgram(device, path, inputElementDescriptions, descriptionCount);
+    if (!loadedProgram)
     {
-        OutputDebugString((char*)error->GetBufferPointer());
-        error->Release();
-        if (FAILED(result))
-        {
-            OutputDebugString("#### Failed to compile vertex shader! ####\n");
-            //return result;
-        }
+        OutputDebugString("#### Failed to load shaders! ####\n");
     }
 
-    // Pixel shader compile
-    result = D3DCompileFromFile(path, NULL, D3D_COMPILE_STANDARD_FILE_INCLUDE, "PShader", "ps_5_0", flags, NULL, &pixShader, &error);
-    if (error != 0)
-    {
-        OutputDebugString((char*)error->GetBufferPointer());
-        error->Release();
-        if (FAILED(result))
-        {
-            OutputDebugString("#### Failed to compile pixel shader! ####\n");
-            //return result;
-        }
-    }
-
-    // Vertex shader create
-    result = device->CreateVertexShader(vertShader->GetBufferPointer(), vertShader->GetBufferSize(), NULL, &vertexShader);
-    if (FAILED(result))
-    {
-        OutputDebugString("#### Failed to create vertex shader! ####\n");
-        //return result;
-    }
-
-    // Pixel shader create
-    result = device->CreatePixelShader(pixShader->GetBufferPointer(), pixShader->GetBufferSize(), NULL, &pixelShader);
-    if (FAILED(result))
-    {
-        OutputDebugString("#### Failed to create pixel shader! ####\n");
-        //return result;
-    }
-
-    result = device->CreateInputLayout(
-        inputElementDescriptions,
-        descriptionCount,
-        vertShader->GetBufferPointer(),
-        vertShader->GetBufferSize(),
-        &inputLayout
-    );
-
-    if (FAILED(result))
-    {
-        OutputDebugString("#### Failed to create input layout! ####\n");
-        //return result;
-    }
-
-    D3D11_SAMPLER_DESC samplerDescription;
-    ZeroMemory(&samplerDescription, sizeof(samplerDescription));
-    samplerDescription.Filter = D3D11_FILTER_ANISOTROPIC;
-    samplerDescription.AddressU = D3D11_TEXTURE_ADDRESS_WRAP;
-    samplerDescription.AddressV = D3D11_TEXTURE_ADDRESS_WRAP;
-    samplerDescription.AddressW = D3D11_TEXTURE_ADDRESS_WRAP;
-    samplerDescription.MaxLOD = D3D11_FLOAT32_MAX;
-
-    result = device->CreateSamplerState(&samplerDescription, &sampler0);
-
-    if (FAILED(result))
-    {
-        OutputDebugString("#### Failed to create sampler state! ####");
-        //return result;
-    }
+	std::lock_guard<std::mutex> lock(mutex);
+    shaderProgram = loadedProgram;
 }
 
 void Mesh::setShaders(ID3D11DeviceContext* immediateContext)
 {
-    immediateContext->IASetInputLayout(inputLayout);
-    immediateContext->VSSetShader(vertexShader, 0, 0);
-    immediateContext->PSSetShader(pixelShader, 0, 0);
+    std::shared_ptr<const ShaderProgram> program;
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        program = shaderProgram;
+    }
+    if (!program) return;
+
+    immediateContext->IASetInputLayout(program->inputLayout);
+    immediateContext->VSSetShader(program->vertexShader, 0, 0);
+    immediateContext->PSSetShader(program->pixelShader, 0, 0);
     immediateContext->IASetPrimitiveTopology(D3D11_PRIMITIVE_TOPOLOGY_TRIANGLELIST);
-    immediateContext->PSSetSamplers(0, 1, &sampler0);
+    immediateContext->PSSetSamplers(0, 1, &program->sampler);
 }
 
 Mesh::Mesh()
@@ -181,144 +96,29 @@ Mesh::Mesh()
     scale = XMVectorSet(1.f, 1.f, 1.f, 0.f);
 }
 
-Mesh::~Mesh()
+HRESULT Mesh::loadFromFile(ID3D11Device* device, const char* fileName)
 {
-    if (vertexBuffer) vertexBuffer->Release();
-    if (texture) texture->Release();
-    if (normalMap) normalMap->Release();
-    if (sampler0) sampler0->Release();
-    if (inputLayout) inputLayout->Release();
-    if (vertexShader) vertexShader->Release();
-    if (pixelShader) pixelShader->Release();
-}
+    std::shared_ptr<const MeshData> loadedData = Assets::getMesh(device, fileName);
 
-static void float4Normalize(XMFLOAT4* value)
-{
-    XMStoreFloat4(value, XMVector4Normalize(XMLoadFloat4(value)));
+	std::lock_guard<std::mutex> lock(mutex);
+    meshData = loadedData;
+
+    return meshData ? S_OK : E_FAIL;
 }
 
-void Mesh::loadFromFile(const char* fileName)
+void Mesh::getBounds(XMFLOAT3* minimumOut, XMFLOAT3* maximumOut) const
 {
 	std::lock_guard<std::mutex> lock(mutex);
 
-    std::ifstream file(fileName);
-
-    if (!file)
+    if (!meshData)
     {
-        OutputDebugString((std::string("#### Failed to load file: ") + std::string(fileName) + " ####\n").c_str());
+        *minimumOut = XMFLOAT3(0.f, 0.f, 0.f);
+        *maximumOut = XMFLOAT3(0.f, 0.f, 0.f);
+        return;
     }
 
-    std::vector<Vertex> newVertices;
-    std::vector<XMFLOAT2> textureCoords;
-	std::vector<XMFLOAT4> normals;
-
-    std::string line;
-    while (std::getline(file, line))
-    {
-        std::vector<std::string> data = Utility::split(line, ' ');
-
-        if (data[0] == "v")
-        {
-			Vertex vertex;
-			ZeroMemory(&vertex, sizeof(Vertex));
-			vertex.position = XMFLOAT4((float)std::atof(data[1].c_str()), (float)std::atof(data[2].c_str()), (float)std::atof(data[3].c_str()), 1.f);
-			vertex.colour = XMFLOAT4(1.f, 1.f, 1.f, 1.f);
-            newVertices.push_back(vertex);
-
-            continue;
-        }
-
-        if (data[0] == "vt")
-        {
-            textureCoords.push_back(XMFLOAT2((float)std::atof(data[1].c_str()), (float)std::atof(data[2].c_str())));
-
-            continue;
-        }
-
-		if (data[0] == "vn")
-		{
-			normals.push_back(XMFLOAT4((float)std::atof(data[1].c_str()), (float)std::atof(data[2].c_str()), (float)std::atof(data[3].c_str()), 0.f));
-
-			continue;
-		}
-
-        if (data[0] == "f")
-        {
-            std::vector<Vertex> face(3);
-
-            for (int i = 1; i <= 3; i++)
-            {
-                std::vector<std::string> vertexData = Utility::split(data[i], '/');
-
-                int vertexIndex = std::atoi(vertexData[0].c_str());
-                indices.push_back(vertexIndex);
-                Vertex vertex = newVertices[vertexIndex - 1];
-
-                int textureCoordsIndex = std::atoi(vertexData[1].c_str());
-                vertex.textureCoord = textureCoords[textureCoordsIndex - 1];
-
-				int normalIndex = std::atoi(vertexData[2].c_str());
-				vertex.normal = normals[normalIndex - 1];
-
-                face.push_back(vertex);
-            }
-
-            XMFLOAT3 vector0 = {
-                face[1].position.x - face[0].position.x,
-                face[1].position.y - face[0].position.y,
-                face[1].position.z - face[0].position.z
-            };
-            XMFLOAT3 vector1 = {
-                face[2].position.x - face[0].position.x,
-                face[2].position.y - face[0].position.y,
-                face[2].position.z - face[0].position.z
-            };
-            XMFLOAT2 uVector = {
-                face[1].textureCoord.x - face[0].textureCoord.x,
-                face[2].textureCoord.x - face[0].textureCoord.x
-            };
-            XMFLOAT2 vVector = {
-                face[1].textureCoord.y - face[0].textureCoord.y,
-                face[2].textureCoord.y - face[0].textureCoord.y
-            };
-
-            float denominator = 1.f / ((uVector.x * vVector.y) - (uVector.y * vVector.x));
-            XMFLOAT4 tangent = {
-                ((vVector.y * vector0.x) - (vVector.x * vector1.x)) * denominator,
-                ((vVector.y * vector0.y) - (vVector.x * vector1.y)) * denominator,
-                ((vVector.y * vector0.z) - (vVector.x * vector1.z)) * denominator,
-                0.f
-            };
-
-            XMFLOAT4 binormal = {
-                ((uVector.x * vector1.x) - (uVector.y * vector0.x)) * denominator,
-                ((uVector.x * vector1.y) - (uVector.y * vector0.y)) * denominator,
-                ((uVector.x * vector1.z) - (uVector.y * vector0.z)) * denominator,
-                0.f
-            };
-
-            float4Normalize(&tangent);
-            float4Normalize(&binormal);
-
-            for (int i = 0; i < 3; i++)
-            {
-                face[i].tangent = tangent;
-                face[i].binormal = binormal;
-            }
-
-            vertices.insert(vertices.end(), face.begin(), face.end());
-
-            continue;
-        }
-    }
-
-    file.close();
-}
-
-std::vector<Vertex>* Mesh::getVertices()
-{
-	std::lock_guard<std::mutex> lock(mutex);
-    return &vertices;
+    *minimumOut = XMFLOAT3(meshData->view.header->boundsMinimum);
+    *maximumOut = XMFLOAT3(meshData->view.header->boundsMaximum);
 }
 
 void Mesh::setPosition(XMVECTOR position)
@@ -386,11 +186,14 @@ void Mesh::draw(ID3D11DeviceContext* immediateContext, std::vector<ID3D11Buffer*
 
     UINT vertexCount;
     ID3D11Buffer* vertexBuffer = getVertexBuffer(&vertexCount);
+    UINT indexCount;
+    ID3D11Buffer* indexBuffer = getIndexBuffer(&indexCount);
 
-    UINT strides = sizeof(Vertex);
+    UINT strides = sizeof(PackedVertex);
     UINT offsets = 0;
 
     immediateContext->PSSetShaderResources(0, 2, textures);
     immediateContext->IASetVertexBuffers(0, 1, &vertexBuffer, &strides, &offsets);
-    immediateContext->Draw(vertexCount, 0);
+    immediateContext->IASetIndexBuffer(indexBuffer, DXGI_FORMAT_R32_UINT, 0);
+    immediateContext->DrawIndexed(indexCount, 0, 0);
 }
@@ -0,0 +1,377 @@
+#include "MeshCache.hpp"
+#include "MeshOptimiser.hpp"
+#include "VertexPacking.hpp"
+#include <cmath>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <stdio.h>
+#include <thread>
+#include <unordered_map>
+
+using namespace DirectX;
+
+static void float4Normalize(XMFLOAT4* value)
+{
+    const float length = sqrtf(value->x * value->x + value->y * value->y + value->z * value->z + value->w * value->w);
+    if (length > 0.f)
+    {
+        value->x /= length;
+        value->y /= length;
+        value->z /= length;
+        value->w /= length;
+    }
+}
+
+static float float4Dot(const XMFLOAT4& a, const XMFLOAT4& b)
+{
+    return a.x * b.x + a.y * b.y + a.z * b.z + a.w * b.w;
+}
+
+// value -= direction * amount
+static void float4Subtract(XMFLOAT4* value, const XMFLOAT4& direction, float amount)
+{
+    value->x -= direction.x * amount;
+    value->y -= direction.y * amount;
+    value->z -= direction.z * amount;
+    value->w -= direction.w * amount;
+}
+
+struct ObjCornerHash
+{
+    std::size_t operator()(const ObjCorner& corner) const
+    {
+        return ((std::size_t)(unsigned int)corner.position * 73856093u) ^ ((std::size_t)(unsigned int)corner.textureCoord * 19349663u) ^ ((std::size_t)(unsigned int)corner.normal * 83492791u);
+    }
+};
+
+struct ObjCornerEqual
+{
+    bool operator()(const ObjCorner& a, const ObjCorner& b) const
+    {
+        return a.position == b.position && a.textureCoord == b.textureCoord && a.normal == b.normal;
+    }
+};
+
+namespace MeshCache
+{
+    uint64_t hashContent(const void* data, std::size_t size)
+    {
+        const uint8_t* bytes = (const uint8_t*)data;
+        uint64_t hash = 14695981039346656037ull;
+
+        for (std::size_t i = 0; i < size; i++)
+        {
+            hash = (hash ^ bytes[i]) * 1099511628211ull;
+        }
+
+        return hash;
+    }
+
+    std::string getCachePath(const char* objFileName)
+    {
+        std::string path(objFileName);
+        const std::size_t extension = path.find_last_of('.');
+        const std::size_t directory = path.find_last_of("/\\");
+
+        if (extension != std::string::npos && (directory == std::string::npos || extension > directory))
+        {
+            path.erase(extension);
+        }
+
+        return path + ".mesh";
+    }
+
+    void buildMesh(const ObjData& data, std::vector<Vertex>& verticesOut, std::vector<UINT>& indicesOut, MeshBuildStatistics* statisticsOut)
+    {
+        verticesOut.clear();
+        verticesOut.reserve(data.corners.size());
+        indicesOut.clear();
+        indicesOut.reserve(data.corners.size());
+
+        // Corners are shared by their position, texture coordinate and normal in the file, before tangents make every face different
+        std::unordered_map<ObjCorner, UINT, ObjCornerHash, ObjCornerEqual> cornerVertices;
+        cornerVertices.reserve(data.corners.size());
+
+        for (std::size_t triangle = 0; triangle + 2 < data.corners.size(); triangle += 3)
+        {
+            UINT face[3];
+
+            for (int i = 0; i < 3; i++)
+            {
+                const ObjCorner& corner = data.corners[triangle + i];
+                auto inserted = cornerVertices.insert({ corner, (UINT)verticesOut.size() });
+                face[i] = inserted.first->second;
+                indicesOut.push_back(face[i]);
+                if (!inserted.second) continue;
+
+                Vertex vertex;
+                memset(&vertex, 0, sizeof(Vertex));
+
+                if (corner.position >= 0)
+                {
+                    const float* position = &data.positions[corner.position * 3];
+                    vertex.position = XMFLOAT4(position[0], position[1], position[2], 1.f);
+                }
+                vertex.colour = XMFLOAT4(1.f, 1.f, 1.f, 1.f);
+
+                if (corner.textureCoord >= 0)
+                {
+                    vertex.textureCoord = XMFLOAT2(data.textureCoords[corner.textureCoord * 2], data.textureCoords[corner.textureCoord * 2 + 1]);
+                }
+
+                if (corner.normal >= 0)
+                {
+                    const float* normal = &data.normals[corner.normal * 3];
+                    vertex.normal = XMFLOAT4(normal[0], normal[1], normal[2], 0.f);
+                }
+
+                verticesOut.push_back(vertex);
+            }
+
+            const Vertex& vertex0 = verticesOut[face[0]];
+            const Vertex& vertex1 = verticesOut[face[1]];
+            const Vertex& vertex2 = verticesOut[face[2]];
+
+            XMFLOAT3 vector0 = {
+                vertex1.position.x - vertex0.position.x,
+                vertex1.position.y - vertex0.position.y,
+                vertex1.position.z - vertex0.position.z
+            };
+            XMFLOAT3 vector1 = {
+                vertex2.position.x - vertex0.position.x,
+                vertex2.position.y - vertex0.position.y,
+                vertex2.position.z - vertex0.position.z
+            };
+            XMFLOAT2 uVector = {
+                vertex1.textureCoord.x - vertex0.textureCoord.x,
+                vertex2.textureCoord.x - vertex0.textureCoord.x
+            };
+            XMFLOAT2 vVector = {
+                vertex1.textureCoord.y - vertex0.textureCoord.y,
+                vertex2.textureCoord.y - vertex0.textureCoord.y
+            };
+
+            float denominator = 1.f / ((uVector.x * vVector.y) - (uVector.y * vVector.x));
+            XMFLOAT4 tangent = {
+                ((vVector.y * vector0.x) - (vVector.x * vector1.x)) * denominator,
+                ((vVector.y * vector0.y) - (vVector.x * vector1.y)) * denominator,
+                ((vVector.y * vector0.z) - (vVector.x * vector1.z)) * denominator,
+                0.f
+            };
+
+            XMFLOAT4 binormal = {
+                ((uVector.x * vector1.x) - (uVector.y * vector0.x)) * denominator,
+                ((uVector.x * vector1.y) - (uVector.y * vector0.y)) * denominator,
+                ((uVector.x * vector1.z) - (uVector.y * vector0.z)) * denominator,
+                0.f
+            };
+
+            // Faces with no texture mapping have nothing to add
+            if (!std::isfinite(denominator)) continue;
+
+            float4Normalize(&tangent);
+            float4Normalize(&binormal);
+
+            // Each face adds its own, and the sums are evened out once every face is in
+            for (int i = 0; i < 3; i++)
+            {
+                Vertex& vertex = verticesOut[face[i]];
+                vertex.tangent = XMFLOAT4(vertex.tangent.x + tangent.x, vertex.tangent.y + tangent.y, vertex.tangent.z + tangent.z, 0.f);
+                vertex.binormal = XMFLOAT4(vertex.binormal.x + binormal.x, vertex.binormal.y + binormal.y, vertex.binormal.z + binormal.z, 0.f);
+            }
+        }
+
+        // Gram-Schmidt, so the tangent is square to the normal and the binormal square to both
+        for (Vertex& vertex : verticesOut)
+        {
+            XMFLOAT4 normal = vertex.normal;
+            float4Normalize(&normal);
+
+            float4Subtract(&vertex.tangent, normal, float4Dot(normal, vertex.tangent));
+            float4Normalize(&vertex.tangent);
+            float4Subtract(&vertex.binormal, normal, float4Dot(normal, vertex.binormal));
+            float4Subtract(&vertex.binormal, vertex.tangent, float4Dot(vertex.tangent, vertex.binormal));
+            float4Normalize(&vertex.binormal);
+        }
+
+        // Corners that differ in the file can still come out the same, such as repeated positions, so weld whatever's left
+        const std::size_t unweldedCount = data.corners.size() / 3 * 3;
+        const std::vector<UINT> remap = MeshOptimiser::weldVertices(verticesOut);
+        for (UINT& index : indicesOut)
+        {
+            index = remap[index];
+        }
+
+        // Then order everything for the vertex caches
+        const float weldedACMR = MeshOptimiser::calculateACMR(indicesOut, verticesOut.size());
+        MeshOptimiser::optimiseVertexCache(indicesOut, verticesOut.size());
+        MeshOptimiser::optimiseVertexFetch(verticesOut, indicesOut);
+
+        if (statisticsOut)
+        {
+            statisticsOut->unweldedVertexCount = unweldedCount;
+            statisticsOut->vertexCount = verticesOut.size();
+            statisticsOut->weldedACMR = weldedACMR;
+            statisticsOut->optimisedACMR = MeshOptimiser::calculateACMR(indicesOut, verticesOut.size());
+        }
+    }
+
+    std::vector<uint8_t> serialise(const std::vector<Vertex>& vertices, const std::vector<UINT>& indices, uint64_t sourceHash)
+    {
+        MeshCacheHeader header;
+        memset(&header, 0, sizeof(header));
+        header.magic = magic;
+        header.version = version;
+        header.vertexSize = sizeof(PackedVertex);
+        header.sourceHash = sourceHash;
+        header.vertexCount = (uint32_t)vertices.size();
+        header.indexCount = (uint32_t)indices.size();
+
+        for (int axis = 0; axis < 3; axis++)
+        {
+            header.boundsMinimum[axis] = vertices.empty() ? 0.f : (&vertices[0].position.x)[axis];
+            header.boundsMaximum[axis] = header.boundsMinimum[axis];
+        }
+        for (const Vertex& vertex : vertices)
+        {
+            for (int axis = 0; axis < 3; axis++)
+            {
+                const float value = (&vertex.position.x)[axis];
+                if (value < header.boundsMinimum[axis]) header.boundsMinimum[axis] = value;
+                if (value > header.boundsMaximum[axis]) header.boundsMaximum[axis] = value;
+            }
+        }
+
+        std::vector<uint8_t> result(sizeof(MeshCacheHeader) + vertices.size() * sizeof(PackedVertex) + indices.size() * sizeof(UINT));
+        memcpy(result.data(), &header, sizeof(header));
+
+        PackedVertex* packedVertices = (PackedVertex*)(result.data() + sizeof(MeshCacheHeader));
+        for (std::size_t i = 0; i < vertices.size(); i++)
+        {
+            packedVertices[i] = VertexPacking::packVertex(vertices[i]);
+        }
+
+        if (!indices.empty())
+        {
+            memcpy(packedVertices + vertices.size(), indices.data(), indices.size() * sizeof(UINT));
+        }
+
+        return result;
+    }
+
+    bool read(const void* data, std::size_t size, MeshCacheView& viewOut)
+    {
+        if (!data || size < sizeof(MeshCacheHeader)) return false;
+
+        const MeshCacheHeader* header = (const MeshCacheHeader*)data;
+        if (header->magic != magic || header->version != version || header->vertexSize != sizeof(PackedVertex)) return false;
+
+        // Only the header is checked, so the rest of the file isn't touched until it's uploaded
+        const std::size_t expectedSize = sizeof(MeshCacheHeader) + (std::size_t)header->vertexCount * sizeof(PackedVertex) + (std::size_t)header->indexCount * sizeof(UINT);
+        if (size != expectedSize) return false;
+
+        viewOut.header = header;
+        viewOut.vertices = (const PackedVertex*)(header + 1);
+        viewOut.indices = (const UINT*)(viewOut.vertices + header->vertexCount);
+        return true;
+    }
+
+    bool read(const void* data, std::size_t size, uint64_t sourceHash, MeshCacheView& viewOut)
+    {
+        MeshCacheView view;
+        if (!read(data, size, view) || view.header->sourceHash != sourceHash) return false;
+
+        viewOut = view;
+        return true;
+    }
+
+    bool getSourceStamp(const char* fileName, uint64_t* sizeOut, uint64_t* writeTimeOut)
+    {
+        std::error_code error;
+        const std::uintmax_t size = std::filesystem::file_size(fileName, error);
+        if (error) return false;
+        const std::filesystem::file_time_type writeTime = std::filesystem::last_write_time(fileName, error);
+        if (error) return false;
+
+        *sizeOut = (uint64_t)size;
+        *writeTimeOut = (uint64_t)writeTime.time_since_epoch().count();
+        return true;
+    }
+
+    void setSourceStamp(std::vector<uint8_t>& baked, uint64_t size, uint64_t writeTime)
+    {
+        if (baked.size() < sizeof(MeshCacheHeader)) return;
+
+        MeshCacheHeader* header = (MeshCacheHeader*)baked.data();
+        header->sourceSize = size;
+        header->sourceWriteTime = writeTime;
+    }
+
+    bool bake(std::string_view source, std::vector<uint8_t>& bakedOut, MeshBuildStatistics* statisticsOut)
+    {
+        ObjData data;
+        const bool valid = ObjParser::parse(source, data, std::thread::hardware_concurrency());
+
+        std::vector<Vertex> vertices;
+        std::vector<UINT> indices;
+        if (valid)
+        {
+            buildMesh(data, vertices, indices, statisticsOut);
+        }
+
+        bakedOut = serialise(vertices, indices, hashContent(source.data(), source.size()));
+        return valid;
+    }
+
+    bool saveFile(const char* fileName, const std::vector<uint8_t>& baked)
+    {
+        std::ofstream file(fileName, std::ios::binary | std::ios::trunc);
+        if (!file) return false;
+
+        file.write((const char*)baked.data(), baked.size());
+        return (bool)file;
+    }
+
+    int bakeDirectory(const char* directory)
+    {
+        int count = 0;
+        std::error_code error;
+
+        for (const std::filesystem::directory_entry& entry : std::filesystem::directory_iterator(directory, error))
+        {
+            if (!entry.is_regular_file() || entry.path().extension() != ".obj") continue;
+
+            const std::string objPath = entry.path().string();
+            std::ifstream file(objPath, std::ios::binary);
+            const std::string source((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+
+            std::vector<uint8_t> baked;
+            MeshBuildStatistics statistics;
+            if (!bake(source, baked, &statistics))
+            {
+                printf("#### Failed to parse %s ####\n", objPath.c_str());
+                continue;
+            }
+
+            uint64_t sourceSize, sourceWriteTime;
+            if (getSourceStamp(objPath.c_str(), &sourceSize, &sourceWriteTime))
+            {
+                setSourceStamp(baked, sourceSize, sourceWriteTime);
+            }
+
+            const std::string cachePath = getCachePath(objPath.c_str());
+            if (!saveFile(cachePath.c_str(), baked))
+            {
+                printf("#### Failed to write %s ####\n", cachePath.c_str());
+                continue;
+            }
+
+            printf("%s: %zu vertices welded to %zu, ACMR 3.000 unindexed, %.3f welded, %.3f optimised, baked to %s, %zu bytes\n", objPath.c_str(),
+                statistics.unweldedVertexCount, statistics.vertexCount, statistics.weldedACMR, statistics.optimisedACMR, cachePath.c_str(), baked.size());
+            count++;
+        }
+
+        return count;
+    }
+}
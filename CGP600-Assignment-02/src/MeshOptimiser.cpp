@@ -0,0 +1,242 @@
+#include "MeshOptimiser.hpp"
+#include <cmath>
+#include <cstring>
+#include <unordered_map>
+
+// Tuned by Forsyth for hardware caches of 16 to 32 entries
+static const int simulatedCacheSize = 32;
+static const float cacheDecayPower = 1.5f;
+static const float lastTriangleScore = 0.75f;
+static const float valenceBoostScale = 2.f;
+static const float valenceBoostPower = 0.5f;
+
+struct VertexHash
+{
+    std::size_t operator()(const Vertex& vertex) const
+    {
+        // FNV-1a over the raw bytes
+        const unsigned char* bytes = (const unsigned char*)&vertex;
+        std::size_t hash = 2166136261u;
+        for (std::size_t i = 0; i < sizeof(Vertex); i++)
+        {
+            hash = (hash ^ bytes[i]) * 16777619u;
+        }
+        return hash;
+    }
+};
+
+struct VertexEqual
+{
+    bool operator()(const Vertex& a, const Vertex& b) const
+    {
+        return memcmp(&a, &b, sizeof(Vertex)) == 0;
+    }
+};
+
+// Vertices that are about to be used again score highest, and so do vertices with few triangles left, to finish them off
+static float scoreVertex(int cachePosition, int remainingTriangles)
+{
+    if (remainingTriangles == 0) return -1.f;
+
+    float score = 0.f;
+    if (cachePosition >= 0)
+    {
+        if (cachePosition < 3)
+        {
+            // The triangle that was just added, which a strip would use next anyway
+            score = lastTriangleScore;
+        }
+        else
+        {
+            score = powf(1.f - (float)(cachePosition - 3) / (float)(simulatedCacheSize - 3), cacheDecayPower);
+        }
+    }
+
+    return score + valenceBoostScale * powf((float)remainingTriangles, -valenceBoostPower);
+}
+
+namespace MeshOptimiser
+{
+    std::vector<UINT> weldVertices(std::vector<Vertex>& vertices)
+    {
+        std::vector<UINT> indices(vertices.size());
+        std::vector<Vertex> unique;
+        std::unordered_map<Vertex, UINT, VertexHash, VertexEqual> seen;
+        seen.reserve(vertices.size());
+
+        for (std::size_t i = 0; i < vertices.size(); i++)
+        {
+            auto inserted = seen.insert({ vertices[i], (UINT)unique.size() });
+            if (inserted.second)
+            {
+                unique.push_back(vertices[i]);
+            }
+            indices[i] = inserted.first->second;
+        }
+
+        vertices.swap(unique);
+        return indices;
+    }
+
+    void optimiseVertexCache(std::vector<UINT>& indices, std::size_t vertexCount)
+    {
+        const std::size_t triangleCount = indices.size() / 3;
+        if (triangleCount == 0) return;
+
+        // Triangles using each vertex, packed into one array
+        std::vector<UINT> adjacencyOffsets(vertexCount + 1, 0);
+        std::vector<int> remaining(vertexCount, 0);
+        for (std::size_t i = 0; i < triangleCount * 3; i++)
+        {
+            remaining[indices[i]]++;
+        }
+        for (std::size_t vertex = 0; vertex < vertexCount; vertex++)
+        {
+            adjacencyOffsets[vertex + 1] = adjacencyOffsets[vertex] + remaining[vertex];
+        }
+        std::vector<UINT> adjacency(triangleCount * 3);
+        std::vector<UINT> filled(adjacencyOffsets.begin(), adjacencyOffsets.end() - 1);
+        for (std::size_t i = 0; i < triangleCount * 3; i++)
+        {
+            adjacency[filled[indices[i]]++] = (UINT)(i / 3);
+        }
+
+        std::vector<int> cachePositions(vertexCount, -1);
+        std::vector<float> vertexScores(vertexCount);
+        for (std::size_t vertex = 0; vertex < vertexCount; vertex++)
+        {
+            vertexScores[vertex] = scoreVertex(-1, remaining[vertex]);
+        }
+
+        std::vector<bool> added(triangleCount, false);
+
+        std::vector<UINT> output;
+        output.reserve(triangleCount * 3);
+
+        // Room for the three new vertices before the cache is cut back down
+        std::vector<UINT> cache, newCache;
+        cache.reserve(simulatedCacheSize + 3);
+        newCache.reserve(simulatedCacheSize + 3);
+
+        std::size_t scanPosition = 0;
+        int bestTriangle = -1;
+
+        while (output.size() < triangleCount * 3)
+        {
+            // Nothing in the cache helps, so start again from the first triangle left
+            // Searching everything for the best one would be quadratic on meshes that hardly share vertices
+            if (bestTriangle < 0)
+            {
+                while (added[scanPosition]) scanPosition++;
+                bestTriangle = (int)scanPosition;
+            }
+
+            added[bestTriangle] = true;
+            const UINT* corners = &indices[bestTriangle * 3];
+            output.insert(output.end(), corners, corners + 3);
+
+            // The triangle's vertices go to the front of the cache, and the rest shuffle back
+            newCache.assign(corners, corners + 3);
+            for (UINT vertex : cache)
+            {
+                if (vertex != corners[0] && vertex != corners[1] && vertex != corners[2])
+                {
+                    newCache.push_back(vertex);
+                }
+            }
+
+            for (int i = 0; i < 3; i++)
+            {
+                const UINT vertex = corners[i];
+                remaining[vertex]--;
+
+                // Take the triangle off the vertex's list, keeping the live ones at the front
+                UINT* begin = &adjacency[adjacencyOffsets[vertex]];
+                UINT* end = begin + remaining[vertex] + 1;
+                for (UINT* triangle = begin; triangle != end; triangle++)
+                {
+                    if (*triangle == (UINT)bestTriangle)
+                    {
+                        *triangle = *(end - 1);
+                        break;
+                    }
+                }
+            }
+
+            for (std::size_t i = 0; i < newCache.size(); i++)
+            {
+                const UINT vertex = newCache[i];
+                cachePositions[vertex] = (i < (std::size_t)simulatedCacheSize) ? (int)i : -1;
+                vertexScores[vertex] = scoreVertex(cachePositions[vertex], remaining[vertex]);
+            }
+
+            // Only triangles touching the cache changed score, so the best of them is the next one to add
+            float bestScore = -1.f;
+            bestTriangle = -1;
+            for (UINT vertex : newCache)
+            {
+                for (int i = 0; i < remaining[vertex]; i++)
+                {
+                    const UINT triangle = adjacency[adjacencyOffsets[vertex] + i];
+                    const float score = vertexScores[indices[triangle * 3]] + vertexScores[indices[triangle * 3 + 1]] + vertexScores[indices[triangle * 3 + 2]];
+
+                    if (score > bestScore)
+                    {
+                        bestScore = score;
+                        bestTriangle = (int)triangle;
+                    }
+                }
+            }
+
+            if (newCache.size() > (std::size_t)simulatedCacheSize)
+            {
+                newCache.resize(simulatedCacheSize);
+            }
+            cache.swap(newCache);
+        }
+
+        indices.swap(output);
+    }
+
+    void optimiseVertexFetch(std::vector<Vertex>& vertices, std::vector<UINT>& indices)
+    {
+        const UINT unused = 0xFFFFFFFFu;
+        std::vector<UINT> remap(vertices.size(), unused);
+        std::vector<Vertex> reordered;
+        reordered.reserve(vertices.size());
+
+        for (UINT& index : indices)
+        {
+            if (remap[index] == unused)
+            {
+                remap[index] = (UINT)reordered.size();
+                reordered.push_back(vertices[index]);
+            }
+            index = remap[index];
+        }
+
+        vertices.swap(reordered);
+    }
+
+    float calculateACMR(const std::vector<UINT>& indices, std::size_t vertexCount, UINT cacheSize)
+    {
+        if (indices.size() < 3) return 0.f;
+
+        // When each vertex went into the cache, which works as a FIFO without having to move anything
+        std::vector<std::size_t> insertedAt(vertexCount, 0);
+        std::size_t clock = 0;
+        std::size_t misses = 0;
+
+        for (UINT index : indices)
+        {
+            if (insertedAt[index] == 0 || clock - insertedAt[index] >= cacheSize)
+            {
+                clock++;
+                insertedAt[index] = clock;
+                misses++;
+            }
+        }
+
+        return (float)misses / (float)(indices.size() / 3);
+    }
+}
@@ -0,0 +1,256 @@
+#include "ObjParser.hpp"
+#include <charconv>
+#include <fstream>
+#include <thread>
+
+// Below this much text per thread, starting threads costs more than it saves
+static const std::size_t minimumChunkSize = 1 << 20;
+
+// Negative indices count back from the latest vertex, which depends on how many came in the chunks before
+// Until every chunk is done they're kept relative to the start of their own chunk, shifted down by unresolvedBias
+// Everything below -1 is one of these, and -1 still means missing
+static const int unresolvedBias = -0x40000000;
+
+struct ObjChunk
+{
+    ObjData data;
+    bool valid = true;
+};
+
+static bool isSpace(char character)
+{
+    return character == ' ' || character == '\t' || character == '\r';
+}
+
+static const char* skipSpaces(const char* position, const char* end)
+{
+    while (position < end && isSpace(*position)) position++;
+    return position;
+}
+
+static const char* parseFloats(const char* position, const char* end, std::vector<float>& output, int count)
+{
+    for (int i = 0; i < count; i++)
+    {
+        position = skipSpaces(position, end);
+
+        // from_chars doesn't accept a leading plus
+        if (position < end && *position == '+') position++;
+
+        float value = 0.f;
+        const std::from_chars_result result = std::from_chars(position, end, value);
+        if (result.ec == std::errc())
+        {
+            position = result.ptr;
+        }
+        output.push_back(value);
+    }
+
+    return position;
+}
+
+// 1-based from the start of the file, or negative from the latest vertex
+static int resolveIndex(int index, std::size_t localCount)
+{
+    if (index > 0) return index - 1;
+    if (index < 0) return unresolvedBias + ((int)localCount + index);
+    return -1;
+}
+
+static const char* parseCorner(const char* position, const char* end, const ObjData& data, ObjCorner& corner)
+{
+    int values[3] = { 0, 0, 0 };
+
+    for (int i = 0; i < 3; i++)
+    {
+        const std::from_chars_result result = std::from_chars(position, end, values[i]);
+        if (result.ec == std::errc())
+        {
+            position = result.ptr;
+        }
+
+        if (position >= end || *position != '/') break;
+        position++;
+    }
+
+    corner.position = resolveIndex(values[0], data.positions.size() / 3);
+    corner.textureCoord = resolveIndex(values[1], data.textureCoords.size() / 2);
+    corner.normal = resolveIndex(values[2], data.normals.size() / 3);
+    return position;
+}
+
+static void parseChunk(std::string_view text, ObjChunk& chunk)
+{
+    ObjData& data = chunk.data;
+    const char* position = text.data();
+    const char* end = text.data() + text.size();
+
+    while (position < end)
+    {
+        const char* lineEnd = position;
+        while (lineEnd < end && *lineEnd != '\n') lineEnd++;
+
+        position = skipSpaces(position, lineEnd);
+        const std::size_t remaining = lineEnd - position;
+
+        if (remaining > 2 && position[0] == 'v' && isSpace(position[1]))
+        {
+            parseFloats(position + 2, lineEnd, data.positions, 3);
+        }
+        else if (remaining > 3 && position[0] == 'v' && position[1] == 't' && isSpace(position[2]))
+        {
+            parseFloats(position + 3, lineEnd, data.textureCoords, 2);
+        }
+        else if (remaining > 3 && position[0] == 'v' && position[1] == 'n' && isSpace(position[2]))
+        {
+            parseFloats(position + 3, lineEnd, data.normals, 3);
+        }
+        else if (remaining > 2 && position[0] == 'f' && isSpace(position[1]))
+        {
+            // Split polygons into a fan around the first corner
+            ObjCorner first, previous, corner;
+            int cornerCount = 0;
+            const char* cursor = skipSpaces(position + 2, lineEnd);
+
+            while (cursor < lineEnd)
+            {
+                const char* next = parseCorner(cursor, lineEnd, data, corner);
+                if (next == cursor)
+                {
+                    chunk.valid = false;
+                    break;
+                }
+                cursor = skipSpaces(next, lineEnd);
+
+                if (cornerCount == 0)
+                {
+                    first = corner;
+                }
+                else if (cornerCount >= 2)
+                {
+                    data.corners.push_back(first);
+                    data.corners.push_back(previous);
+                    data.corners.push_back(corner);
+                }
+                previous = corner;
+                cornerCount++;
+            }
+        }
+
+        position = lineEnd + 1;
+    }
+}
+
+static bool isInRange(int index, std::size_t count)
+{
+    return index >= -1 && index < (int)count;
+}
+
+static int placeIndex(int index, int offset)
+{
+    return (index < -1) ? offset + (index - unresolvedBias) : index;
+}
+
+namespace ObjParser
+{
+    bool parse(std::string_view text, ObjData& dataOut, unsigned int threadCount)
+    {
+        std::size_t chunkCount = text.size() / minimumChunkSize;
+        if (chunkCount > threadCount) chunkCount = threadCount;
+        if (chunkCount < 1) chunkCount = 1;
+
+        // Cut the text into roughly equal pieces, moving each cut forward to the next line
+        std::vector<std::string_view> pieces;
+        std::size_t start = 0;
+        for (std::size_t i = 1; i <= chunkCount && start < text.size(); i++)
+        {
+            std::size_t cut = (i == chunkCount) ? text.size() : text.size() * i / chunkCount;
+            if (cut < start) cut = start;
+            while (cut < text.size() && text[cut - 1] != '\n') cut++;
+
+            pieces.push_back(text.substr(start, cut - start));
+            start = cut;
+        }
+
+        std::vector<ObjChunk> chunks(pieces.size());
+        if (pieces.size() == 1)
+        {
+            parseChunk(pieces[0], chunks[0]);
+        }
+        else
+        {
+            std::vector<std::thread> threads;
+            for (std::size_t i = 0; i < pieces.size(); i++)
+            {
+                threads.emplace_back(parseChunk, pieces[i], std::ref(chunks[i]));
+            }
+            for (std::thread& thread : threads)
+            {
+                thread.join();
+            }
+        }
+
+        // Stitch the chunks together, placing each one's relative indices now that the counts before it are known
+        dataOut = ObjData();
+        std::size_t positionCount = 0, textureCoordCount = 0, normalCount = 0, cornerCount = 0;
+        for (const ObjChunk& chunk : chunks)
+        {
+            positionCount += chunk.data.positions.size();
+            textureCoordCount += chunk.data.textureCoords.size();
+            normalCount += chunk.data.normals.size();
+            cornerCount += chunk.data.corners.size();
+        }
+        dataOut.positions.reserve(positionCount);
+        dataOut.textureCoords.reserve(textureCoordCount);
+        dataOut.normals.reserve(normalCount);
+        dataOut.corners.reserve(cornerCount);
+
+        bool valid = true;
+        for (ObjChunk& chunk : chunks)
+        {
+            const int positionOffset = (int)(dataOut.positions.size() / 3);
+            const int textureCoordOffset = (int)(dataOut.textureCoords.size() / 2);
+            const int normalOffset = (int)(dataOut.normals.size() / 3);
+
+            for (ObjCorner& corner : chunk.data.corners)
+            {
+                corner.position = placeIndex(corner.position, positionOffset);
+                corner.textureCoord = placeIndex(corner.textureCoord, textureCoordOffset);
+                corner.normal = placeIndex(corner.normal, normalOffset);
+            }
+
+            dataOut.positions.insert(dataOut.positions.end(), chunk.data.positions.begin(), chunk.data.positions.end());
+            dataOut.textureCoords.insert(dataOut.textureCoords.end(), chunk.data.textureCoords.begin(), chunk.data.textureCoords.end());
+            dataOut.normals.insert(dataOut.normals.end(), chunk.data.normals.begin(), chunk.data.normals.end());
+            dataOut.corners.insert(dataOut.corners.end(), chunk.data.corners.begin(), chunk.data.corners.end());
+            valid = valid && chunk.valid;
+        }
+
+        // Every corner needs a position, and anything else it refers to has to exist
+        for (const ObjCorner& corner : dataOut.corners)
+        {
+            if (corner.position < 0 || !isInRange(corner.position, dataOut.positions.size() / 3) ||
+                !isInRange(corner.textureCoord, dataOut.textureCoords.size() / 2) || !isInRange(corner.normal, dataOut.normals.size() / 3))
+            {
+                valid = false;
+                break;
+            }
+        }
+
+        return valid;
+    }
+
+    bool parseFile(const char* fileName, ObjData& dataOut, unsigned int threadCount)
+    {
+        dataOut = ObjData();
+
+        std::ifstream file(fileName, std::ios::binary | std::ios::ate);
+        if (!file) return false;
+
+        std::string text((std::size_t)file.tellg(), '\0');
+        file.seekg(0);
+        if (!file.read(&text[0], text.size())) return false;
+
+        return parse(text, dataOut, threadCount);
+    }
+}
@@ -0,0 +1,262 @@
+#include "Occupancy.hpp"
+
+// The x64 configurations build with /arch:AVX2, the same as PerlinNoise, so they take the AVX2 kernels
+#if defined(__AVX2__)
+#include <immintrin.h>
+#define OCCUPANCY_AVX2
+#elif defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define OCCUPANCY_SSE2
+#endif
+
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
+
+namespace Occupancy
+{
+    FaceMasks buildFaceMasks(int width, int height, int depth)
+    {
+        FaceMasks masks;
+        masks.width = width;
+        masks.height = height;
+        masks.depth = depth;
+        masks.wordCount = ((std::size_t)width * height * depth + 63) / 64;
+
+        for (int axis = 0; axis < 3; axis++)
+        {
+            masks.first[axis].assign(masks.wordCount, 0);
+            masks.last[axis].assign(masks.wordCount, 0);
+        }
+
+        for (int z = 0; z < depth; z++)
+        {
+            for (int y = 0; y < height; y++)
+            {
+                for (int x = 0; x < width; x++)
+                {
+                    const int index = x + width * (y + height * z);
+                    const int coordinates[3] = { x, y, z };
+                    const int extents[3] = { width, height, depth };
+
+                    for (int axis = 0; axis < 3; axis++)
+                    {
+                        if (coordinates[axis] == 0) setBit(masks.first[axis], index, true);
+                        if (coordinates[axis] == extents[axis] - 1) setBit(masks.last[axis], index, true);
+                    }
+                }
+            }
+        }
+
+        return masks;
+    }
+
+    void shiftBits(uint64_t* output, const uint64_t* input, std::size_t count, std::ptrdiff_t shift)
+    {
+        const bool down = shift >= 0;
+        const std::size_t distance = (std::size_t)(down ? shift : -shift);
+        const std::size_t wordShift = distance / 64;
+        const int bitShift = (int)(distance % 64);
+
+        // Reads outside the set are zero
+        auto word = [&](std::ptrdiff_t index) -> uint64_t
+        {
+            return (index >= 0 && (std::size_t)index < count) ? input[index] : 0;
+        };
+
+        // Words whose sources are both inside the set can go through the vector path
+        std::size_t vectorStart = down ? 0 : wordShift + 1;
+        std::size_t vectorEnd = down ? (count > wordShift + 1 ? count - wordShift - 1 : 0) : count;
+        if (vectorStart > vectorEnd) vectorStart = vectorEnd;
+
+        std::size_t w = 0;
+        for (; w < vectorStart; w++)
+        {
+            const std::ptrdiff_t source = (std::ptrdiff_t)w - (std::ptrdiff_t)wordShift;
+            output[w] = bitShift ? (word(source) << bitShift) | (word(source - 1) >> (64 - bitShift)) : word(source);
+        }
+
+        if (bitShift == 0)
+        {
+            for (; w < vectorEnd; w++)
+            {
+                output[w] = down ? input[w + wordShift] : input[w - wordShift];
+            }
+        }
+        else if (down)
+        {
+#if defined(OCCUPANCY_AVX2)
+            const __m128i right = _mm_cvtsi32_si128(bitShift);
+            const __m128i left = _mm_cvtsi32_si128(64 - bitShift);
+            for (; w + 4 <= vectorEnd; w += 4)
+            {
+                __m256i low = _mm256_loadu_si256((const __m256i*)(input + w + wordShift));
+                __m256i high = _mm256_loadu_si256((const __m256i*)(input + w + wordShift + 1));
+                _mm256_storeu_si256((__m256i*)(output + w), _mm256_or_si256(_mm256_srl_epi64(low, right), _mm256_sll_epi64(high, left)));
+            }
+#elif defined(OCCUPANCY_SSE2)
+            const __m128i right = _mm_cvtsi32_si128(bitShift);
+            const __m128i left = _mm_cvtsi32_si128(64 - bitShift);
+            for (; w + 2 <= vectorEnd; w += 2)
+            {
+                __m128i low = _mm_loadu_si128((const __m128i*)(input + w + wordShift));
+                __m128i high = _mm_loadu_si128((const __m128i*)(input + w + wordShift + 1));
+                _mm_storeu_si128((__m128i*)(output + w), _mm_or_si128(_mm_srl_epi64(low, right), _mm_sll_epi64(high, left)));
+            }
+#endif
+            for (; w < vectorEnd; w++)
+            {
+                output[w] = (input[w + wordShift] >> bitShift) | (input[w + wordShift + 1] << (64 - bitShift));
+            }
+        }
+        else
+        {
+#if defined(OCCUPANCY_AVX2)
+            const __m128i left = _mm_cvtsi32_si128(bitShift);
+            const __m128i right = _mm_cvtsi32_si128(64 - bitShift);
+            for (; w + 4 <= vectorEnd; w += 4)
+            {
+                __m256i high = _mm256_loadu_si256((const __m256i*)(input + w - wordShift));
+                __m256i low = _mm256_loadu_si256((const __m256i*)(input + w - wordShift - 1));
+                _mm256_storeu_si256((__m256i*)(output + w), _mm256_or_si256(_mm256_sll_epi64(high, left), _mm256_srl_epi64(low, right)));
+            }
+#elif defined(OCCUPANCY_SSE2)
+            const __m128i left = _mm_cvtsi32_si128(bitShift);
+            const __m128i right = _mm_cvtsi32_si128(64 - bitShift);
+            for (; w + 2 <= vectorEnd; w += 2)
+            {
+                __m128i high = _mm_loadu_si128((const __m128i*)(input + w - wordShift));
+                __m128i low = _mm_loadu_si128((const __m128i*)(input + w - wordShift - 1));
+                _mm_storeu_si128((__m128i*)(output + w), _mm_or_si128(_mm_sll_epi64(high, left), _mm_srl_epi64(low, right)));
+            }
+#endif
+            for (; w < vectorEnd; w++)
+            {
+                output[w] = (input[w - wordShift] << bitShift) | (input[w - wordShift - 1] >> (64 - bitShift));
+            }
+        }
+
+        for (; w < count; w++)
+        {
+            const std::ptrdiff_t source = (std::ptrdiff_t)w + (std::ptrdiff_t)wordShift;
+            output[w] = bitShift ? (word(source) >> bitShift) | (word(source + 1) << (64 - bitShift)) : word(source);
+        }
+    }
+
+    void andBits(uint64_t* output, const uint64_t* a, const uint64_t* b, std::size_t count)
+    {
+        std::size_t i = 0;
+#if defined(OCCUPANCY_AVX2)
+        for (; i + 4 <= count; i += 4)
+        {
+            _mm256_storeu_si256((__m256i*)(output + i), _mm256_and_si256(_mm256_loadu_si256((const __m256i*)(a + i)), _mm256_loadu_si256((const __m256i*)(b + i))));
+        }
+#elif defined(OCCUPANCY_SSE2)
+        for (; i + 2 <= count; i += 2)
+        {
+            _mm_storeu_si128((__m128i*)(output + i), _mm_and_si128(_mm_loadu_si128((const __m128i*)(a + i)), _mm_loadu_si128((const __m128i*)(b + i))));
+        }
+#endif
+        for (; i < count; i++)
+        {
+            output[i] = a[i] & b[i];
+        }
+    }
+
+    void andNotBits(uint64_t* output, const uint64_t* a, const uint64_t* b, std::size_t count)
+    {
+        std::size_t i = 0;
+#if defined(OCCUPANCY_AVX2)
+        for (; i + 4 <= count; i += 4)
+        {
+            // andnot negates its first operand
+            _mm256_storeu_si256((__m256i*)(output + i), _mm256_andnot_si256(_mm256_loadu_si256((const __m256i*)(b + i)), _mm256_loadu_si256((const __m256i*)(a + i))));
+        }
+#elif defined(OCCUPANCY_SSE2)
+        for (; i + 2 <= count; i += 2)
+        {
+            _mm_storeu_si128((__m128i*)(output + i), _mm_andnot_si128(_mm_loadu_si128((const __m128i*)(b + i)), _mm_loadu_si128((const __m128i*)(a + i))));
+        }
+#endif
+        for (; i < count; i++)
+        {
+            output[i] = a[i] & ~b[i];
+        }
+    }
+
+    void orBits(uint64_t* output, const uint64_t* a, const uint64_t* b, std::size_t count)
+    {
+        std::size_t i = 0;
+#if defined(OCCUPANCY_AVX2)
+        for (; i + 4 <= count; i += 4)
+        {
+            _mm256_storeu_si256((__m256i*)(output + i), _mm256_or_si256(_mm256_loadu_si256((const __m256i*)(a + i)), _mm256_loadu_si256((const __m256i*)(b + i))));
+        }
+#elif defined(OCCUPANCY_SSE2)
+        for (; i + 2 <= count; i += 2)
+        {
+            _mm_storeu_si128((__m128i*)(output + i), _mm_or_si128(_mm_loadu_si128((const __m128i*)(a + i)), _mm_loadu_si128((const __m128i*)(b + i))));
+        }
+#endif
+        for (; i < count; i++)
+        {
+            output[i] = a[i] | b[i];
+        }
+    }
+
+    void neighbourBits(uint64_t* output, const FaceMasks& masks, const uint64_t* occupancy, const uint64_t* adjoining, int axis, int direction)
+    {
+        const std::ptrdiff_t stride = (axis == 0) ? 1 : (axis == 1) ? masks.width : (std::ptrdiff_t)masks.width * masks.height;
+        const int extent = (axis == 0) ? masks.width : (axis == 1) ? masks.height : masks.depth;
+        const std::size_t count = masks.wordCount;
+
+        // Blocks on the leading face have no neighbour inside this chunk
+        const std::vector<uint64_t>& leadingFace = (direction > 0) ? masks.last[axis] : masks.first[axis];
+        const std::vector<uint64_t>& trailingFace = (direction > 0) ? masks.first[axis] : masks.last[axis];
+
+        shiftBits(output, occupancy, count, direction * stride);
+        andNotBits(output, output, leadingFace.data(), count);
+
+        if (!adjoining) return;
+
+        // The adjoining chunk's opposite face wraps round onto this chunk's leading face
+        std::vector<uint64_t> face(count);
+        std::vector<uint64_t> shifted(count);
+        andBits(face.data(), adjoining, trailingFace.data(), count);
+        shiftBits(shifted.data(), face.data(), count, -direction * stride * (extent - 1));
+        orBits(output, output, shifted.data(), count);
+    }
+
+    bool testBit(const std::vector<uint64_t>& bits, int index)
+    {
+        return (bits[index >> 6] >> (index & 63)) & 1ull;
+    }
+
+    void setBit(std::vector<uint64_t>& bits, int index, bool value)
+    {
+        if (value)
+        {
+            bits[index >> 6] |= 1ull << (index & 63);
+        }
+        else
+        {
+            bits[index >> 6] &= ~(1ull << (index & 63));
+        }
+    }
+
+    int countTrailingZeros(uint64_t value)
+    {
+#if defined(_MSC_VER) && defined(_M_X64)
+        unsigned long index;
+        _BitScanForward64(&index, value);
+        return (int)index;
+#elif defined(_MSC_VER)
+        unsigned long index;
+        if (_BitScanForward(&index, (unsigned long)value)) return (int)index;
+        _BitScanForward(&index, (unsigned long)(value >> 32));
+        return (int)index + 32;
+#else
+        return __builtin_ctzll(value);
+#endif
+    }
+}
@@ -3,17 +3,188 @@
 #include <random>
 #include <algorithm>
 
-float PerlinNoise::fade(float time)
+// The x64 configurations build with /arch:AVX2, which is what makes MSVC define __AVX2__
+#if defined(__AVX2__)
+#include <immintrin.h>
+#define PERLIN_NOISE_AVX2
+#define PERLIN_NOISE_SSE2
+#elif defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define PERLIN_NOISE_SSE2
+#endif
+
+// The batched noise is written once against these, one for each vector width
+// Every step is the same operation in the same order as the scalar code, so the results match it exactly
+#if defined(PERLIN_NOISE_SSE2)
+struct Lanes4
+{
+    typedef __m128 Float;
+    typedef __m128i Int;
+    static const int count = 4;
+
+    static Float load(const float* values) { return _mm_loadu_ps(values); }
+    static void store(float* values, Float a) { _mm_storeu_ps(values, a); }
+    static Float set(float value) { return _mm_set1_ps(value); }
+    static Float add(Float a, Float b) { return _mm_add_ps(a, b); }
+    static Float subtract(Float a, Float b) { return _mm_sub_ps(a, b); }
+    static Float multiply(Float a, Float b) { return _mm_mul_ps(a, b); }
+    static Float divide(Float a, Float b) { return _mm_div_ps(a, b); }
+    // SSE2 has no floor, so truncate and step down where that rounded up
+    static Float floor(Float a)
+    {
+        const Float truncated = _mm_cvtepi32_ps(_mm_cvttps_epi32(a));
+        return _mm_sub_ps(truncated, _mm_and_ps(_mm_cmpgt_ps(truncated, a), _mm_set1_ps(1.f)));
+    }
+    static Int truncate(Float a) { return _mm_cvttps_epi32(a); }
+    static Float flipSign(Float a, Int signBits) { return _mm_xor_ps(a, _mm_castsi128_ps(signBits)); }
+    static Float select(Int mask, Float a, Float b) { return _mm_or_ps(_mm_and_ps(_mm_castsi128_ps(mask), a), _mm_andnot_ps(_mm_castsi128_ps(mask), b)); }
+
+    static Int setInt(int value) { return _mm_set1_epi32(value); }
+    static Int addInt(Int a, Int b) { return _mm_add_epi32(a, b); }
+    static Int andInt(Int a, Int b) { return _mm_and_si128(a, b); }
+    static Int orInt(Int a, Int b) { return _mm_or_si128(a, b); }
+    static Int lessThan(Int a, Int b) { return _mm_cmplt_epi32(a, b); }
+    static Int equal(Int a, Int b) { return _mm_cmpeq_epi32(a, b); }
+    template <int shift> static Int shiftLeft(Int a) { return _mm_slli_epi32(a, shift); }
+    // No gather before AVX2, so each lane is looked up on its own
+    static Int lookup(const uint32_t* table, Int indices)
+    {
+        alignas(16) int lanes[4];
+        _mm_store_si128((Int*)lanes, indices);
+        return _mm_setr_epi32((int)table[lanes[0]], (int)table[lanes[1]], (int)table[lanes[2]], (int)table[lanes[3]]);
+    }
+};
+#endif
+
+#if defined(PERLIN_NOISE_AVX2)
+struct Lanes8
+{
+    typedef __m256 Float;
+    typedef __m256i Int;
+    static const int count = 8;
+
+    static Float load(const float* values) { return _mm256_loadu_ps(values); }
+    static void store(float* values, Float a) { _mm256_storeu_ps(values, a); }
+    static Float set(float value) { return _mm256_set1_ps(value); }
+    static Float add(Float a, Float b) { return _mm256_add_ps(a, b); }
+    static Float subtract(Float a, Float b) { return _mm256_sub_ps(a, b); }
+    static Float multiply(Float a, Float b) { return _mm256_mul_ps(a, b); }
+    static Float divide(Float a, Float b) { return _mm256_div_ps(a, b); }
+    static Float floor(Float a) { return _mm256_floor_ps(a); }
+    static Int truncate(Float a) { return _mm256_cvttps_epi32(a); }
+    static Float flipSign(Float a, Int signBits) { return _mm256_xor_ps(a, _mm256_castsi256_ps(signBits)); }
+    static Float select(Int mask, Float a, Float b) { return _mm256_blendv_ps(b, a, _mm256_castsi256_ps(mask)); }
+
+    static Int setInt(int value) { return _mm256_set1_epi32(value); }
+    static Int addInt(Int a, Int b) { return _mm256_add_epi32(a, b); }
+    static Int andInt(Int a, Int b) { return _mm256_and_si256(a, b); }
+    static Int orInt(Int a, Int b) { return _mm256_or_si256(a, b); }
+    static Int lessThan(Int a, Int b) { return _mm256_cmpgt_epi32(b, a); }
+    static Int equal(Int a, Int b) { return _mm256_cmpeq_epi32(a, b); }
+    template <int shift> static Int shiftLeft(Int a) { return _mm256_slli_epi32(a, shift); }
+    static Int lookup(const uint32_t* table, Int indices) { return _mm256_i32gather_epi32((const int*)table, indices, 4); }
+};
+#endif
+
+#if defined(PERLIN_NOISE_SSE2)
+template <typename Lanes>
+static typename Lanes::Float fadeLanes(typename Lanes::Float time)
+{
+    typename Lanes::Float result = Lanes::multiply(Lanes::multiply(time, time), time);
+    typename Lanes::Float inner = Lanes::subtract(Lanes::multiply(time, Lanes::set(6.f)), Lanes::set(15.f));
+    inner = Lanes::add(Lanes::multiply(time, inner), Lanes::set(10.f));
+    return Lanes::multiply(result, inner);
+}
+
+template <typename Lanes>
+static typename Lanes::Float lerpLanes(typename Lanes::Float time, typename Lanes::Float a, typename Lanes::Float b)
+{
+    return Lanes::add(a, Lanes::multiply(time, Lanes::subtract(b, a)));
+}
+
+// Branchless: the hash picks u and v with masks, and its two low bits flip their signs
+template <typename Lanes>
+static typename Lanes::Float gradientLanes(typename Lanes::Int hash, typename Lanes::Float x, typename Lanes::Float y, typename Lanes::Float z)
+{
+    const typename Lanes::Int low = Lanes::andInt(hash, Lanes::setInt(15));
+    const typename Lanes::Float u = Lanes::select(Lanes::lessThan(low, Lanes::setInt(8)), x, y);
+    const typename Lanes::Int useX = Lanes::orInt(Lanes::equal(low, Lanes::setInt(12)), Lanes::equal(low, Lanes::setInt(14)));
+    const typename Lanes::Float v = Lanes::select(Lanes::lessThan(low, Lanes::setInt(4)), y, Lanes::select(useX, x, z));
+
+    const typename Lanes::Float signedU = Lanes::flipSign(u, Lanes::template shiftLeft<31>(Lanes::andInt(low, Lanes::setInt(1))));
+    const typename Lanes::Float signedV = Lanes::flipSign(v, Lanes::template shiftLeft<30>(Lanes::andInt(low, Lanes::setInt(2))));
+    return Lanes::add(signedU, signedV);
+}
+
+template <typename Lanes>
+static void noiseLanes(const uint32_t* permutation, const float* xIn, const float* yIn, const float* zIn, float* output)
+{
+    typedef typename Lanes::Float Float;
+    typedef typename Lanes::Int Int;
+
+    Float x = Lanes::load(xIn);
+    Float y = Lanes::load(yIn);
+    Float z = Lanes::load(zIn);
+
+    const Float floorX = Lanes::floor(x);
+    const Float floorY = Lanes::floor(y);
+    const Float floorZ = Lanes::floor(z);
+    const Int mask = Lanes::setInt(255);
+    const Int X = Lanes::andInt(Lanes::truncate(floorX), mask);
+    const Int Y = Lanes::andInt(Lanes::truncate(floorY), mask);
+    const Int Z = Lanes::andInt(Lanes::truncate(floorZ), mask);
+
+    x = Lanes::subtract(x, floorX);
+    y = Lanes::subtract(y, floorY);
+    z = Lanes::subtract(z, floorZ);
+
+    const Float u = fadeLanes<Lanes>(x);
+    const Float v = fadeLanes<Lanes>(y);
+    const Float w = fadeLanes<Lanes>(z);
+
+    const Int one = Lanes::setInt(1);
+    const Int A = Lanes::addInt(Lanes::lookup(permutation, X), Y);
+    const Int AA = Lanes::addInt(Lanes::lookup(permutation, A), Z);
+    const Int AB = Lanes::addInt(Lanes::lookup(permutation, Lanes::addInt(A, one)), Z);
+    const Int B = Lanes::addInt(Lanes::lookup(permutation, Lanes::addInt(X, one)), Y);
+    const Int BA = Lanes::addInt(Lanes::lookup(permutation, B), Z);
+    const Int BB = Lanes::addInt(Lanes::lookup(permutation, Lanes::addInt(B, one)), Z);
+
+    const Float x1 = Lanes::subtract(x, Lanes::set(1.f));
+    const Float y1 = Lanes::subtract(y, Lanes::set(1.f));
+    const Float z1 = Lanes::subtract(z, Lanes::set(1.f));
+
+    const Float result = lerpLanes<Lanes>(
+        w,
+        lerpLanes<Lanes>(
+            v,
+            lerpLanes<Lanes>(u, gradientLanes<Lanes>(Lanes::lookup(permutation, AA), x, y, z), gradientLanes<Lanes>(Lanes::lookup(permutation, BA), x1, y, z)),
+            lerpLanes<Lanes>(u, gradientLanes<Lanes>(Lanes::lookup(permutation, AB), x, y1, z), gradientLanes<Lanes>(Lanes::lookup(permutation, BB), x1, y1, z))
+        ),
+        lerpLanes<Lanes>(
+            v,
+            lerpLanes<Lanes>(u, gradientLanes<Lanes>(Lanes::lookup(permutation, Lanes::addInt(AA, one)), x, y, z1),
+                gradientLanes<Lanes>(Lanes::lookup(permutation, Lanes::addInt(BA, one)), x1, y, z1)),
+            lerpLanes<Lanes>(u, gradientLanes<Lanes>(Lanes::lookup(permutation, Lanes::addInt(AB, one)), x, y1, z1),
+                gradientLanes<Lanes>(Lanes::lookup(permutation, Lanes::addInt(BB, one)), x1, y1, z1))
+        )
+    );
+
+    Lanes::store(output, Lanes::divide(Lanes::add(result, Lanes::set(1.f)), Lanes::set(2.f)));
+}
+#endif
+
+float PerlinNoise::fade(float time) const
 {
     return time * time * time * (time * (time * 6.f - 15.f) + 10.f);
 }
 
-float PerlinNoise::lerp(float time, float a, float b)
+float PerlinNoise::lerp(float time, float a, float b) const
 {
     return a + time * (b - a);
 }
 
-float PerlinNoise::gradient(int hash, float x, float y, float z)
+float PerlinNoise::gradient(int hash, float x, float y, float z) const
 {
     int Hash = hash & 15;
     float u = Hash < 8 ? x : y;
@@ -30,7 +201,7 @@ PerlinNoise::PerlinNoise(unsigned int seed)
     permutation.insert(permutation.end(), permutation.begin(), permutation.end());
 }
 
-float PerlinNoise::noise(float x, float y, float z)
+float PerlinNoise::noise(float x, float y, float z) const
 {
     int X = (int)floor(x) & 255;
     int Y = (int)floor(y) & 255;
@@ -68,7 +239,199 @@ float PerlinNoise::noise(float x, float y, float z)
     return (result + 1.f) / 2.f;
 }
 
-std::vector<UINT> PerlinNoise::getPermutation()
+void PerlinNoise::noise8(const float x[8], const float y[8], const float z[8], float output[8]) const
+{
+#if defined(PERLIN_NOISE_AVX2)
+    noiseLanes<Lanes8>(permutation.data(), x, y, z, output);
+#elif defined(PERLIN_NOISE_SSE2)
+    noiseLanes<Lanes4>(permutation.data(), x, y, z, output);
+    noiseLanes<Lanes4>(permutation.data(), x + 4, y + 4, z + 4, output + 4);
+#else
+    for (int i = 0; i < 8; i++)
+    {
+        output[i] = noise(x[i], y[i], z[i]);
+    }
+#endif
+}
+
+void PerlinNoise::noise16(const float x[16], const float y[16], const float z[16], float output[16]) const
+{
+    noise8(x, y, z, output);
+    noise8(x + 8, y + 8, z + 8, output + 8);
+}
+
+void PerlinNoise::sampleRegion(int x, int y, int z, int width, int height, int depth, std::vector<float>& valuesOut) const
+{
+    valuesOut.assign((std::size_t)width * height * depth, 0.f);
+
+    // Runs along x sixteen at a time, with the last batch of a row padded out by repeating its last block
+    float xs[16], ys[16], zs[16], values[16];
+    for (int blockZ = 0; blockZ < depth; blockZ++)
+    {
+        for (int blockY = 0; blockY < height; blockY++)
+        {
+            const std::size_t rowStart = (std::size_t)width * (blockY + (std::size_t)height * blockZ);
+
+            for (int blockX = 0; blockX < width; blockX += 16)
+            {
+                for (int i = 0; i < 16; i++)
+                {
+                    const int column = (blockX + i < width) ? blockX + i : width - 1;
+                    xs[i] = (float)(x + column) / scaleFactor;
+                    ys[i] = (float)(y + blockY) / scaleFactor;
+                    zs[i] = (float)(z + blockZ) / scaleFactor;
+                }
+
+                noise16(xs, ys, zs, values);
+
+                for (int i = 0; i < 16 && blockX + i < width; i++)
+                {
+                    valuesOut[rowStart + blockX + i] = values[i];
+                }
+            }
+        }
+    }
+}
+
+static int floorDivide(int value, int divisor)
+{
+    return (value >= 0) ? value / divisor : -((-value + divisor - 1) / divisor);
+}
+
+// One row of blocks from the four lines either side of it in y and z, a group of lanes at a time
+#if defined(PERLIN_NOISE_SSE2)
+template <typename Lanes>
+static int interpolateRowLanes(const float* line00, const float* line10, const float* line01, const float* line11, float timeY, float timeZ, int width, float* output)
+{
+    const typename Lanes::Float y = Lanes::set(timeY);
+    const typename Lanes::Float z = Lanes::set(timeZ);
+
+    int blockX = 0;
+    for (; blockX + Lanes::count <= width; blockX += Lanes::count)
+    {
+        const typename Lanes::Float near = lerpLanes<Lanes>(y, Lanes::load(line00 + blockX), Lanes::load(line10 + blockX));
+        const typename Lanes::Float far = lerpLanes<Lanes>(y, Lanes::load(line01 + blockX), Lanes::load(line11 + blockX));
+        Lanes::store(output + blockX, lerpLanes<Lanes>(z, near, far));
+    }
+
+    return blockX;
+}
+#endif
+
+std::size_t PerlinNoise::sampleRegionLattice(int x, int y, int z, int width, int height, int depth, int latticeSpacing, std::vector<float>& valuesOut) const
+{
+    if (latticeSpacing <= 1)
+    {
+        sampleRegion(x, y, z, width, height, depth, valuesOut);
+        return (std::size_t)width * height * depth;
+    }
+
+    const int spacing = latticeSpacing;
+    valuesOut.assign((std::size_t)width * height * depth, 0.f);
+    if (valuesOut.empty()) return 0;
+
+    // Every block needs the lattice points at the start and end of the cell it's in
+    const int startX = floorDivide(x, spacing), startY = floorDivide(y, spacing), startZ = floorDivide(z, spacing);
+    const int countX = floorDivide(x + width - 1, spacing) - startX + 2;
+    const int countY = floorDivide(y + height - 1, spacing) - startY + 2;
+    const int countZ = floorDivide(z + depth - 1, spacing) - startZ + 2;
+    const int latticeCount = countX * countY * countZ;
+
+    std::vector<float> lattice((std::size_t)latticeCount);
+    float xs[16], ys[16], zs[16], values[16];
+    for (int start = 0; start < latticeCount; start += 16)
+    {
+        for (int i = 0; i < 16; i++)
+        {
+            const int point = (start + i < latticeCount) ? start + i : latticeCount - 1;
+            xs[i] = (float)((startX + point % countX) * spacing) / scaleFactor;
+            ys[i] = (float)((startY + (point / countX) % countY) * spacing) / scaleFactor;
+            zs[i] = (float)((startZ + point / (countX * countY)) * spacing) / scaleFactor;
+        }
+
+        noise16(xs, ys, zs, values);
+
+        for (int i = 0; i < 16 && start + i < latticeCount; i++)
+        {
+            lattice[start + i] = values[i];
+        }
+    }
+
+    // Where each block sits in its cell, on one axis
+    auto getCell = [spacing](int position, int start, float& timeOut)
+    {
+        const int cell = floorDivide(position, spacing);
+        timeOut = (float)(position - cell * spacing) / (float)spacing;
+        return cell - start;
+    };
+
+    // Interpolate along x at every lattice row first, so the rest is the same few lines for a whole row of blocks
+    std::vector<int> cellsX(width);
+    std::vector<float> timesX(width);
+    for (int blockX = 0; blockX < width; blockX++)
+    {
+        cellsX[blockX] = getCell(x + blockX, startX, timesX[blockX]);
+    }
+
+    std::vector<float> lines((std::size_t)countY * countZ * width);
+    for (int line = 0; line < countY * countZ; line++)
+    {
+        const float* row = &lattice[(std::size_t)line * countX];
+        float* output = &lines[(std::size_t)line * width];
+        for (int blockX = 0; blockX < width; blockX++)
+        {
+            output[blockX] = lerp(timesX[blockX], row[cellsX[blockX]], row[cellsX[blockX] + 1]);
+        }
+    }
+
+    for (int blockZ = 0; blockZ < depth; blockZ++)
+    {
+        float timeZ;
+        const int cellZ = getCell(z + blockZ, startZ, timeZ);
+
+        for (int blockY = 0; blockY < height; blockY++)
+        {
+            float timeY;
+            const int cellY = getCell(y + blockY, startY, timeY);
+
+            const float* line00 = &lines[(std::size_t)width * (cellY + countY * cellZ)];
+            const float* line10 = line00 + width;
+            const float* line01 = line00 + (std::size_t)width * countY;
+            const float* line11 = line01 + width;
+            float* output = &valuesOut[(std::size_t)width * (blockY + (std::size_t)height * blockZ)];
+
+            int blockX = 0;
+#if defined(PERLIN_NOISE_AVX2)
+            blockX = interpolateRowLanes<Lanes8>(line00, line10, line01, line11, timeY, timeZ, width, output);
+#elif defined(PERLIN_NOISE_SSE2)
+            blockX = interpolateRowLanes<Lanes4>(line00, line10, line01, line11, timeY, timeZ, width, output);
+#endif
+            for (; blockX < width; blockX++)
+            {
+                output[blockX] = lerp(timeZ, lerp(timeY, line00[blockX], line10[blockX]), lerp(timeY, line01[blockX], line11[blockX]));
+            }
+        }
+    }
+
+    return (std::size_t)latticeCount;
+}
+
+void PerlinNoise::generateRegion(int x, int y, int z, int width, int height, int depth, std::vector<bool>& blockValuesOut) const
+{
+    std::vector<float> values;
+    sampleRegion(x, y, z, width, height, depth, values);
+
+    blockValuesOut.assign(values.size(), false);
+    for (std::size_t i = 0; i < values.size(); i++)
+    {
+        if (values[i] > 0.5f)
+        {
+            blockValuesOut[i] = true;
+        }
+    }
+}
+
+std::vector<uint32_t> PerlinNoise::getPermutation()
 {
     return permutation;
 }
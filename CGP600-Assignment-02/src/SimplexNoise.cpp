@@ -0,0 +1,241 @@
+#include "SimplexNoise.hpp"
+#include "Utility.hpp"
+#include <numeric>
+#include <random>
+#include <algorithm>
+
+// Midpoints of a cube's edges, with the first two components doubling as the 2D gradients
+static const float gradients3[12][3] = {
+    { 1.f, 1.f, 0.f }, { -1.f, 1.f, 0.f }, { 1.f, -1.f, 0.f }, { -1.f, -1.f, 0.f },
+    { 1.f, 0.f, 1.f }, { -1.f, 0.f, 1.f }, { 1.f, 0.f, -1.f }, { -1.f, 0.f, -1.f },
+    { 0.f, 1.f, 1.f }, { 0.f, -1.f, 1.f }, { 0.f, 1.f, -1.f }, { 0.f, -1.f, -1.f }
+};
+
+// Midpoints of a tesseract's edges
+static const float gradients4[32][4] = {
+    { 0.f, 1.f, 1.f, 1.f }, { 0.f, 1.f, 1.f, -1.f }, { 0.f, 1.f, -1.f, 1.f }, { 0.f, 1.f, -1.f, -1.f },
+    { 0.f, -1.f, 1.f, 1.f }, { 0.f, -1.f, 1.f, -1.f }, { 0.f, -1.f, -1.f, 1.f }, { 0.f, -1.f, -1.f, -1.f },
+    { 1.f, 0.f, 1.f, 1.f }, { 1.f, 0.f, 1.f, -1.f }, { 1.f, 0.f, -1.f, 1.f }, { 1.f, 0.f, -1.f, -1.f },
+    { -1.f, 0.f, 1.f, 1.f }, { -1.f, 0.f, 1.f, -1.f }, { -1.f, 0.f, -1.f, 1.f }, { -1.f, 0.f, -1.f, -1.f },
+    { 1.f, 1.f, 0.f, 1.f }, { 1.f, 1.f, 0.f, -1.f }, { 1.f, -1.f, 0.f, 1.f }, { 1.f, -1.f, 0.f, -1.f },
+    { -1.f, 1.f, 0.f, 1.f }, { -1.f, 1.f, 0.f, -1.f }, { -1.f, -1.f, 0.f, 1.f }, { -1.f, -1.f, 0.f, -1.f },
+    { 1.f, 1.f, 1.f, 0.f }, { 1.f, 1.f, -1.f, 0.f }, { 1.f, -1.f, 1.f, 0.f }, { 1.f, -1.f, -1.f, 0.f },
+    { -1.f, 1.f, 1.f, 0.f }, { -1.f, 1.f, -1.f, 0.f }, { -1.f, -1.f, 1.f, 0.f }, { -1.f, -1.f, -1.f, 0.f }
+};
+
+static int fastFloor(float value)
+{
+    const int truncated = (int)value;
+    return (value < (float)truncated) ? truncated - 1 : truncated;
+}
+
+// Each corner's falloff, which reaches zero before the next simplex so only the corners of this one count
+static float corner2(const float gradient[3], float x, float y)
+{
+    float t = 0.5f - x * x - y * y;
+    if (t < 0.f) return 0.f;
+
+    t *= t;
+    return t * t * (gradient[0] * x + gradient[1] * y);
+}
+
+static float corner3(const float gradient[3], float x, float y, float z)
+{
+    float t = 0.6f - x * x - y * y - z * z;
+    if (t < 0.f) return 0.f;
+
+    t *= t;
+    return t * t * (gradient[0] * x + gradient[1] * y + gradient[2] * z);
+}
+
+static float corner4(const float gradient[4], float x, float y, float z, float w)
+{
+    float t = 0.6f - x * x - y * y - z * z - w * w;
+    if (t < 0.f) return 0.f;
+
+    t *= t;
+    return t * t * (gradient[0] * x + gradient[1] * y + gradient[2] * z + gradient[3] * w);
+}
+
+// The scaled sums come out at about -1 to 1, so map that onto PerlinNoise's range
+static float toUnitRange(float value)
+{
+    return Utility::clamp((value + 1.f) / 2.f, 0.f, 1.f);
+}
+
+SimplexNoise::SimplexNoise(unsigned int seed)
+{
+    permutation.resize(256);
+    std::iota(permutation.begin(), permutation.end(), 0);
+    std::default_random_engine engine(seed);
+    std::shuffle(permutation.begin(), permutation.end(), engine);
+    permutation.insert(permutation.end(), permutation.begin(), permutation.end());
+
+    permutationMod12.resize(permutation.size());
+    for (std::size_t i = 0; i < permutation.size(); i++)
+    {
+        permutationMod12[i] = permutation[i] % 12;
+    }
+}
+
+float SimplexNoise::noise(float x, float y) const
+{
+    // Skew onto a grid of squares split into two triangles each, find the triangle, then skew its corners back
+    const float skew = 0.36602540378f; // (sqrt(3) - 1) / 2
+    const float unskew = 0.21132486540f; // (3 - sqrt(3)) / 6
+
+    const float s = (x + y) * skew;
+    const int i = fastFloor(x + s);
+    const int j = fastFloor(y + s);
+    const float t = (float)(i + j) * unskew;
+    const float x0 = x - ((float)i - t);
+    const float y0 = y - ((float)j - t);
+
+    // Lower or upper triangle
+    const int i1 = (x0 > y0) ? 1 : 0;
+    const int j1 = 1 - i1;
+
+    const float x1 = x0 - (float)i1 + unskew;
+    const float y1 = y0 - (float)j1 + unskew;
+    const float x2 = x0 - 1.f + 2.f * unskew;
+    const float y2 = y0 - 1.f + 2.f * unskew;
+
+    const int ii = i & 255;
+    const int jj = j & 255;
+
+    const float result =
+        corner2(gradients3[permutationMod12[ii + permutation[jj]]], x0, y0) +
+        corner2(gradients3[permutationMod12[ii + i1 + permutation[jj + j1]]], x1, y1) +
+        corner2(gradients3[permutationMod12[ii + 1 + permutation[jj + 1]]], x2, y2);
+
+    return toUnitRange(70.f * result);
+}
+
+float SimplexNoise::noise(float x, float y, float z) const
+{
+    const float skew = 1.f / 3.f;
+    const float unskew = 1.f / 6.f;
+
+    const float s = (x + y + z) * skew;
+    const int i = fastFloor(x + s);
+    const int j = fastFloor(y + s);
+    const int k = fastFloor(z + s);
+    const float t = (float)(i + j + k) * unskew;
+    const float x0 = x - ((float)i - t);
+    const float y0 = y - ((float)j - t);
+    const float z0 = z - ((float)k - t);
+
+    // The cube splits into six tetrahedra, picked by the order of the offsets from largest to smallest
+    int i1, j1, k1, i2, j2, k2;
+    if (x0 >= y0)
+    {
+        if (y0 >= z0)
+        {
+            i1 = 1; j1 = 0; k1 = 0; i2 = 1; j2 = 1; k2 = 0;
+        }
+        else if (x0 >= z0)
+        {
+            i1 = 1; j1 = 0; k1 = 0; i2 = 1; j2 = 0; k2 = 1;
+        }
+        else
+        {
+            i1 = 0; j1 = 0; k1 = 1; i2 = 1; j2 = 0; k2 = 1;
+        }
+    }
+    else
+    {
+        if (y0 < z0)
+        {
+            i1 = 0; j1 = 0; k1 = 1; i2 = 0; j2 = 1; k2 = 1;
+        }
+        else if (x0 < z0)
+        {
+            i1 = 0; j1 = 1; k1 = 0; i2 = 0; j2 = 1; k2 = 1;
+        }
+        else
+        {
+            i1 = 0; j1 = 1; k1 = 0; i2 = 1; j2 = 1; k2 = 0;
+        }
+    }
+
+    const float x1 = x0 - (float)i1 + unskew;
+    const float y1 = y0 - (float)j1 + unskew;
+    const float z1 = z0 - (float)k1 + unskew;
+    const float x2 = x0 - (float)i2 + 2.f * unskew;
+    const float y2 = y0 - (float)j2 + 2.f * unskew;
+    const float z2 = z0 - (float)k2 + 2.f * unskew;
+    const float x3 = x0 - 1.f + 3.f * unskew;
+    const float y3 = y0 - 1.f + 3.f * unskew;
+    const float z3 = z0 - 1.f + 3.f * unskew;
+
+    const int ii = i & 255;
+    const int jj = j & 255;
+    const int kk = k & 255;
+
+    const float result =
+        corner3(gradients3[permutationMod12[ii + permutation[jj + permutation[kk]]]], x0, y0, z0) +
+        corner3(gradients3[permutationMod12[ii + i1 + permutation[jj + j1 + permutation[kk + k1]]]], x1, y1, z1) +
+        corner3(gradients3[permutationMod12[ii + i2 + permutation[jj + j2 + permutation[kk + k2]]]], x2, y2, z2) +
+        corner3(gradients3[permutationMod12[ii + 1 + permutation[jj + 1 + permutation[kk + 1]]]], x3, y3, z3);
+
+    return toUnitRange(32.f * result);
+}
+
+float SimplexNoise::noise(float x, float y, float z, float w) const
+{
+    const float skew = 0.30901699437f; // (sqrt(5) - 1) / 4
+    const float unskew = 0.13819660113f; // (5 - sqrt(5)) / 20
+
+    const float s = (x + y + z + w) * skew;
+    const int i = fastFloor(x + s);
+    const int j = fastFloor(y + s);
+    const int k = fastFloor(z + s);
+    const int l = fastFloor(w + s);
+    const float t = (float)(i + j + k + l) * unskew;
+    const float offsets[4] = { x - ((float)i - t), y - ((float)j - t), z - ((float)k - t), w - ((float)l - t) };
+
+    // Rank each offset against the others, and the corners step along the axes from highest rank to lowest
+    int ranks[4] = { 0, 0, 0, 0 };
+    for (int a = 0; a < 4; a++)
+    {
+        for (int b = a + 1; b < 4; b++)
+        {
+            if (offsets[a] > offsets[b])
+            {
+                ranks[a]++;
+            }
+            else
+            {
+                ranks[b]++;
+            }
+        }
+    }
+
+    const int ii = i & 255;
+    const int jj = j & 255;
+    const int kk = k & 255;
+    const int ll = l & 255;
+
+    float result = 0.f;
+    for (int corner = 0; corner < 5; corner++)
+    {
+        // Corner n has stepped along every axis ranked 4 - n or higher
+        int steps[4];
+        float position[4];
+        for (int axis = 0; axis < 4; axis++)
+        {
+            steps[axis] = (ranks[axis] >= 4 - corner) ? 1 : 0;
+            position[axis] = offsets[axis] - (float)steps[axis] + (float)corner * unskew;
+        }
+
+        const uint32_t gradient = permutation[ii + steps[0] + permutation[jj + steps[1] + permutation[kk + steps[2] + permutation[ll + steps[3]]]]] % 32;
+        result += corner4(gradients4[gradient], position[0], position[1], position[2], position[3]);
+    }
+
+    return toUnitRange(27.f * result);
+}
+
+std::vector<uint32_t> SimplexNoise::getPermutation()
+{
+    return permutation;
+}
@@ -0,0 +1,40 @@
+#include "SlotAllocator.hpp"
+
+UINT SlotAllocator::allocate()
+{
+    // Fill gaps first so the array stays as short as possible
+    if (!freeSlots.empty())
+    {
+        UINT slot = freeSlots.back();
+        freeSlots.pop_back();
+        return slot;
+    }
+
+    return slotCount++;
+}
+
+void SlotAllocator::release(UINT slot)
+{
+    freeSlots.push_back(slot);
+}
+
+void SlotAllocator::clear()
+{
+    freeSlots.clear();
+    slotCount = 0;
+}
+
+UINT SlotAllocator::getSlotCount() const
+{
+    return slotCount;
+}
+
+UINT SlotAllocator::getUsedCount() const
+{
+    return slotCount - (UINT)freeSlots.size();
+}
+
+UINT SlotAllocator::getFreeCount() const
+{
+    return (UINT)freeSlots.size();
+}
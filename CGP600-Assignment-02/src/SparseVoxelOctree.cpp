@@ -0,0 +1,387 @@
+#include "SparseVoxelOctree.hpp"
+#include "Utility.hpp"
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <limits>
+
+std::size_t SparseVoxelOctree::NodeHash::operator()(const Node& node) const
+{
+    // FNV-1a over the child references
+    std::size_t hash = 2166136261u;
+    for (int i = 0; i < 8; i++)
+    {
+        hash = (hash ^ node.children[i]) * 16777619u;
+    }
+    return hash;
+}
+
+bool SparseVoxelOctree::NodeEqual::operator()(const Node& a, const Node& b) const
+{
+    return memcmp(a.children, b.children, sizeof(a.children)) == 0;
+}
+
+bool SparseVoxelOctree::isUniform(NodeReference reference)
+{
+    return (reference & uniformFlag) != 0;
+}
+
+SparseVoxelOctree::NodeReference SparseVoxelOctree::makeUniform(UINT value)
+{
+    return uniformFlag | value;
+}
+
+UINT SparseVoxelOctree::getUniformValue(NodeReference reference)
+{
+    return reference & ~uniformFlag;
+}
+
+int SparseVoxelOctree::getChildIndex(int x, int y, int z, int half)
+{
+    return (x >= half ? 1 : 0) | (y >= half ? 2 : 0) | (z >= half ? 4 : 0);
+}
+
+UINT SparseVoxelOctree::findOrAddPaletteEntry(Block value)
+{
+    for (UINT i = 1; i < (UINT)palette.size(); i++)
+    {
+        if (palette[i] == value)
+        {
+            return i;
+        }
+    }
+
+    palette.push_back(value);
+    return (UINT)palette.size() - 1;
+}
+
+void SparseVoxelOctree::retain(NodeReference reference)
+{
+    if (isUniform(reference)) return;
+
+    referenceCounts[reference]++;
+}
+
+void SparseVoxelOctree::release(NodeReference reference)
+{
+    if (isUniform(reference)) return;
+
+    referenceCounts[reference]--;
+    if (referenceCounts[reference] > 0) return;
+
+    Node node = nodes[reference];
+    if (deduplicate)
+    {
+        uniqueNodes.erase(node);
+    }
+    freeNodes.push_back(reference);
+
+    for (int i = 0; i < 8; i++)
+    {
+        release(node.children[i]);
+    }
+}
+
+SparseVoxelOctree::NodeReference SparseVoxelOctree::makeNode(const NodeReference children[8])
+{
+    // Eight identical uniform children merge back into their parent
+    bool collapse = isUniform(children[0]);
+    for (int i = 1; i < 8 && collapse; i++)
+    {
+        collapse = children[i] == children[0];
+    }
+    if (collapse)
+    {
+        return children[0];
+    }
+
+    Node node;
+    memcpy(node.children, children, sizeof(node.children));
+
+    if (deduplicate)
+    {
+        auto existing = uniqueNodes.find(node);
+        if (existing != uniqueNodes.end())
+        {
+            // The shared node already holds its own references to these children
+            for (int i = 0; i < 8; i++)
+            {
+                release(children[i]);
+            }
+            retain(existing->second);
+            return existing->second;
+        }
+    }
+
+    NodeReference reference;
+    if (!freeNodes.empty())
+    {
+        reference = freeNodes.back();
+        freeNodes.pop_back();
+        nodes[reference] = node;
+        referenceCounts[reference] = 1;
+    }
+    else
+    {
+        reference = (NodeReference)nodes.size();
+        nodes.push_back(node);
+        referenceCounts.push_back(1);
+    }
+
+    if (deduplicate)
+    {
+        uniqueNodes[node] = reference;
+    }
+
+    return reference;
+}
+
+SparseVoxelOctree::NodeReference SparseVoxelOctree::setValue(NodeReference reference, int level, int x, int y, int z, UINT value)
+{
+    if (level == 0 || (isUniform(reference) && getUniformValue(reference) == value))
+    {
+        return makeUniform(value);
+    }
+
+    // Nodes may be shared, so edits copy the path from the root rather than writing in place
+    NodeReference children[8];
+    if (isUniform(reference))
+    {
+        // Split a uniform region into eight copies of itself
+        std::fill(children, children + 8, reference);
+    }
+    else
+    {
+        memcpy(children, nodes[reference].children, sizeof(children));
+        for (int i = 0; i < 8; i++)
+        {
+            retain(children[i]);
+        }
+    }
+
+    const int half = 1 << (level - 1);
+    const int child = getChildIndex(x, y, z, half);
+    NodeReference newChild = setValue(children[child], level - 1, x & (half - 1), y & (half - 1), z & (half - 1), value);
+    release(children[child]);
+    children[child] = newChild;
+
+    return makeNode(children);
+}
+
+SparseVoxelOctree::NodeReference SparseVoxelOctree::buildRegion(const ChunkMap& map, int x, int y, int z, int level)
+{
+    const int size = 1 << level;
+
+    if (level == 0)
+    {
+        const Block* block = map.getBlock(x, y, z);
+        return makeUniform(block ? findOrAddPaletteEntry(*block) : 0);
+    }
+
+    // Regions inside a single missing chunk are air without visiting any blocks
+    if (size <= ChunkMap::chunkSize &&
+        ChunkMap::getLocalCoordinate(x) + size <= ChunkMap::chunkSize &&
+        ChunkMap::getLocalCoordinate(y) + size <= ChunkMap::chunkSize &&
+        ChunkMap::getLocalCoordinate(z) + size <= ChunkMap::chunkSize &&
+        !map.getChunk(ChunkMap::getChunkCoordinate(x, y, z)))
+    {
+        return makeUniform(0);
+    }
+
+    const int half = size / 2;
+    NodeReference children[8];
+    for (int i = 0; i < 8; i++)
+    {
+        children[i] = buildRegion(map, x + ((i & 1) ? half : 0), y + ((i & 2) ? half : 0), z + ((i & 4) ? half : 0), level - 1);
+    }
+
+    return makeNode(children);
+}
+
+// Slab test of a ray against an axis-aligned cube
+static bool intersectCube(const float origin[3], const float direction[3], const float minimum[3], float size, float* enterOut, float* exitOut)
+{
+    float enter = -std::numeric_limits<float>::infinity();
+    float exit = std::numeric_limits<float>::infinity();
+
+    for (int axis = 0; axis < 3; axis++)
+    {
+        if (direction[axis] == 0.f)
+        {
+            // Parallel to this slab, so it's either always inside or never
+            if (origin[axis] < minimum[axis] || origin[axis] >= minimum[axis] + size) return false;
+            continue;
+        }
+
+        float inverse = 1.f / direction[axis];
+        float slabEnter = (minimum[axis] - origin[axis]) * inverse;
+        float slabExit = (minimum[axis] + size - origin[axis]) * inverse;
+        if (slabEnter > slabExit) std::swap(slabEnter, slabExit);
+
+        enter = Utility::max(enter, slabEnter);
+        exit = Utility::min(exit, slabExit);
+    }
+
+    *enterOut = enter;
+    *exitOut = exit;
+    return enter <= exit;
+}
+
+bool SparseVoxelOctree::raycastNode(NodeReference reference, int level, int minX, int minY, int minZ,
+    const float origin[3], const float direction[3], float maxDistance, int blockOut[3], float* distanceOut) const
+{
+    // Empty space is skipped in one step no matter how big the subtree is
+    if (reference == makeUniform(0)) return false;
+
+    const int size = 1 << level;
+    const float minimum[3] = { (float)minX, (float)minY, (float)minZ };
+    float enter, exit;
+    if (!intersectCube(origin, direction, minimum, (float)size, &enter, &exit)) return false;
+    if (exit < 0.f || enter > maxDistance) return false;
+
+    if (isUniform(reference))
+    {
+        // A solid region is hit where the ray enters it
+        float distance = Utility::max(enter, 0.f);
+        const int minimums[3] = { minX, minY, minZ };
+        for (int axis = 0; axis < 3; axis++)
+        {
+            int block = (int)std::floor(origin[axis] + direction[axis] * distance);
+            blockOut[axis] = Utility::clamp(block, minimums[axis], minimums[axis] + size - 1);
+        }
+        *distanceOut = distance;
+        return true;
+    }
+
+    // Visit the children in the order the ray enters them, so the first hit is the closest
+    const Node& node = nodes[reference];
+    const int half = size / 2;
+    std::pair<float, int> order[8];
+    int count = 0;
+
+    for (int i = 0; i < 8; i++)
+    {
+        if (node.children[i] == makeUniform(0)) continue;
+
+        const float childMinimum[3] = {
+            (float)(minX + ((i & 1) ? half : 0)),
+            (float)(minY + ((i & 2) ? half : 0)),
+            (float)(minZ + ((i & 4) ? half : 0))
+        };
+        float childEnter, childExit;
+        if (intersectCube(origin, direction, childMinimum, (float)half, &childEnter, &childExit))
+        {
+            order[count++] = std::make_pair(childEnter, i);
+        }
+    }
+
+    std::sort(order, order + count);
+
+    for (int j = 0; j < count; j++)
+    {
+        const int i = order[j].second;
+        if (raycastNode(node.children[i], level - 1,
+            minX + ((i & 1) ? half : 0), minY + ((i & 2) ? half : 0), minZ + ((i & 4) ? half : 0),
+            origin, direction, maxDistance, blockOut, distanceOut))
+        {
+            return true;
+        }
+    }
+
+    return false;
+}
+
+SparseVoxelOctree::SparseVoxelOctree(int originX, int originY, int originZ, int levels, bool deduplicate) :
+    originX(originX),
+    originY(originY),
+    originZ(originZ),
+    levels(levels),
+    deduplicate(deduplicate),
+    palette(1, Block{ 0 }),
+    root(makeUniform(0))
+{
+}
+
+void SparseVoxelOctree::build(const ChunkMap& map)
+{
+    NodeReference newRoot = buildRegion(map, originX, originY, originZ, levels);
+    release(root);
+    root = newRoot;
+}
+
+bool SparseVoxelOctree::contains(int x, int y, int z) const
+{
+    const int size = getSize();
+    return x >= originX && x < originX + size &&
+        y >= originY && y < originY + size &&
+        z >= originZ && z < originZ + size;
+}
+
+void SparseVoxelOctree::addBlock(int x, int y, int z, Block value)
+{
+    if (!contains(x, y, z)) return;
+
+    UINT paletteIndex = findOrAddPaletteEntry(value);
+    NodeReference newRoot = setValue(root, levels, x - originX, y - originY, z - originZ, paletteIndex);
+    release(root);
+    root = newRoot;
+}
+
+void SparseVoxelOctree::removeBlock(int x, int y, int z)
+{
+    if (!contains(x, y, z)) return;
+
+    NodeReference newRoot = setValue(root, levels, x - originX, y - originY, z - originZ, 0);
+    release(root);
+    root = newRoot;
+}
+
+const Block* SparseVoxelOctree::getBlock(int x, int y, int z) const
+{
+    if (!contains(x, y, z)) return nullptr;
+
+    x -= originX;
+    y -= originY;
+    z -= originZ;
+
+    NodeReference reference = root;
+    int level = levels;
+    while (!isUniform(reference))
+    {
+        const int half = 1 << (level - 1);
+        reference = nodes[reference].children[getChildIndex(x, y, z, half)];
+        x &= half - 1;
+        y &= half - 1;
+        z &= half - 1;
+        level--;
+    }
+
+    UINT value = getUniformValue(reference);
+    return value == 0 ? nullptr : &palette[value];
+}
+
+bool SparseVoxelOctree::raycast(const float origin[3], const float direction[3], float maxDistance, int blockOut[3], float* distanceOut) const
+{
+    return raycastNode(root, levels, originX, originY, originZ, origin, direction, maxDistance, blockOut, distanceOut);
+}
+
+int SparseVoxelOctree::getSize() const
+{
+    return 1 << levels;
+}
+
+std::size_t SparseVoxelOctree::getNodeCount() const
+{
+    return nodes.size() - freeNodes.size();
+}
+
+std::size_t SparseVoxelOctree::getMemoryUsage() const
+{
+    // Each hash table entry holds a copy of the node, its reference and roughly two pointers of bookkeeping
+    const std::size_t uniqueNodeSize = sizeof(Node) + sizeof(NodeReference) + sizeof(void*) * 2;
+
+    return nodes.size() * (sizeof(Node) + sizeof(UINT)) +
+        freeNodes.size() * sizeof(NodeReference) +
+        uniqueNodes.size() * uniqueNodeSize +
+        palette.size() * sizeof(Block);
+}
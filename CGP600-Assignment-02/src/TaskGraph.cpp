@@ -0,0 +1,174 @@
+#include "TaskGraph.hpp"
+#include <thread>
+#include <stdio.h>
+
+static double secondsSince(std::chrono::high_resolution_clock::time_point start)
+{
+    return std::chrono::duration<double>(std::chrono::high_resolution_clock::now() - start).count();
+}
+
+TaskGraph::TaskId TaskGraph::add(const char* name, std::function<void()> work, const TaskId* dependencies, std::size_t dependencyCount, bool serial)
+{
+    const TaskId id = tasks.size();
+
+    Task task;
+    task.name = name;
+    task.work = std::move(work);
+    task.serial = serial;
+    for (std::size_t i = 0; i < dependencyCount; i++)
+    {
+        tasks[dependencies[i]].dependents.push_back(id);
+        task.dependencyCount++;
+    }
+
+    tasks.push_back(std::move(task));
+    return id;
+}
+
+TaskGraph::TaskId TaskGraph::addTask(const char* name, std::function<void()> work, std::initializer_list<TaskId> dependencies)
+{
+    return add(name, std::move(work), dependencies.begin(), dependencies.size(), false);
+}
+
+TaskGraph::TaskId TaskGraph::addSerialTask(const char* name, std::function<void()> work, std::initializer_list<TaskId> dependencies)
+{
+    return add(name, std::move(work), dependencies.begin(), dependencies.size(), true);
+}
+
+TaskGraph::TaskId TaskGraph::addTask(const char* name, std::function<void()> work, const std::vector<TaskId>& dependencies)
+{
+    return add(name, std::move(work), dependencies.data(), dependencies.size(), false);
+}
+
+bool TaskGraph::takeTask(unsigned int threadIndex, TaskId& idOut)
+{
+    // The calling thread does the serial work first, since only it can
+    if (threadIndex == 0 && !readySerial.empty())
+    {
+        idOut = readySerial.front();
+        readySerial.pop_front();
+        return true;
+    }
+
+    std::deque<TaskId>& own = queues[threadIndex];
+    if (!own.empty())
+    {
+        idOut = own.back();
+        own.pop_back();
+        return true;
+    }
+
+    for (unsigned int i = 1; i < threadCount; i++)
+    {
+        std::deque<TaskId>& other = queues[(threadIndex + i) % threadCount];
+        if (!other.empty())
+        {
+            idOut = other.front();
+            other.pop_front();
+            return true;
+        }
+    }
+
+    return false;
+}
+
+void TaskGraph::work(unsigned int threadIndex)
+{
+    std::unique_lock<std::mutex> lock(mutex);
+
+    while (true)
+    {
+        TaskId id = 0;
+        condition.wait(lock, [this, threadIndex, &id]()
+        {
+            return finishedCount == tasks.size() || takeTask(threadIndex, id);
+        });
+        if (finishedCount == tasks.size()) return;
+
+        Task& task = tasks[id];
+        lock.unlock();
+
+        task.startSeconds = secondsSince(startTime);
+        task.work();
+        task.endSeconds = secondsSince(startTime);
+        task.threadIndex = threadIndex;
+
+        lock.lock();
+        finishedCount++;
+        for (TaskId dependent : task.dependents)
+        {
+            if (--tasks[dependent].remainingDependencies == 0)
+            {
+                if (tasks[dependent].serial)
+                {
+                    readySerial.push_back(dependent);
+                }
+                else
+                {
+                    queues[threadIndex].push_back(dependent);
+                }
+            }
+        }
+        condition.notify_all();
+    }
+}
+
+void TaskGraph::run(unsigned int threadCount)
+{
+    this->threadCount = (threadCount > 0) ? threadCount : 1;
+    startTime = std::chrono::high_resolution_clock::now();
+    finishedCount = 0;
+    queues.assign(this->threadCount, std::deque<TaskId>());
+
+    // Tasks that can start straight away are dealt out evenly
+    unsigned int nextQueue = 0;
+    for (TaskId id = 0; id < tasks.size(); id++)
+    {
+        tasks[id].remainingDependencies = tasks[id].dependencyCount;
+        if (tasks[id].dependencyCount != 0) continue;
+
+        if (tasks[id].serial)
+        {
+            readySerial.push_back(id);
+        }
+        else
+        {
+            queues[nextQueue].push_back(id);
+            nextQueue = (nextQueue + 1) % this->threadCount;
+        }
+    }
+
+    std::vector<std::thread> threads;
+    for (unsigned int i = 1; i < this->threadCount; i++)
+    {
+        threads.emplace_back(&TaskGraph::work, this, i);
+    }
+
+    work(0);
+
+    for (std::thread& thread : threads)
+    {
+        thread.join();
+    }
+
+    totalSeconds = secondsSince(startTime);
+}
+
+double TaskGraph::getTotalSeconds() const
+{
+    return totalSeconds;
+}
+
+void TaskGraph::printReport(const char* title) const
+{
+    double workSeconds = 0.0;
+
+    printf("%s:\n", title);
+    for (const Task& task : tasks)
+    {
+        printf("\t%-24s %8.1f ms to %8.1f ms, %8.1f ms on thread %u%s\n", task.name.c_str(), task.startSeconds * 1000.0, task.endSeconds * 1000.0,
+            (task.endSeconds - task.startSeconds) * 1000.0, task.threadIndex, task.serial ? " (serial)" : "");
+        workSeconds += task.endSeconds - task.startSeconds;
+    }
+    printf("\tTotal: %.1f ms, for %.1f ms of work on %u threads\n", totalSeconds * 1000.0, workSeconds * 1000.0, threadCount);
+}
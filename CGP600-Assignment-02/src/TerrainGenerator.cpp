@@ -0,0 +1,431 @@
+#include "TerrainGenerator.hpp"
+#include "Utility.hpp"
+#include <algorithm>
+#include <chrono>
+#include <memory>
+#include <vector>
+#include <stdio.h>
+
+static double secondsSince(std::chrono::high_resolution_clock::time_point start)
+{
+    return std::chrono::duration<double>(std::chrono::high_resolution_clock::now() - start).count();
+}
+
+static void hashBytes(uint64_t& hash, const void* data, std::size_t size)
+{
+    const uint8_t* bytes = (const uint8_t*)data;
+    for (std::size_t i = 0; i < size; i++)
+    {
+        hash = (hash ^ bytes[i]) * 1099511628211ull;
+    }
+}
+
+TerrainGenerator::TerrainGenerator(unsigned int seed) : noise(seed)
+{
+}
+
+TerrainGenerator::TerrainGenerator(unsigned int seed, const Settings& settings) : noise(seed), settings(settings)
+{
+}
+
+void TerrainGenerator::generateHeights(int originX, int originZ, std::vector<float>& heightsOut) const
+{
+    const int size = ChunkMap::chunkSize;
+    heightsOut.assign((std::size_t)size * size, 0.f);
+
+    // Each octave has twice the frequency and half the amplitude of the last, normalised so the total stays within heightVariation
+    float totalAmplitude = 0.f;
+    for (int octave = 0, amplitude = 1; octave < settings.heightOctaves; octave++)
+    {
+        totalAmplitude += 1.f / (float)(amplitude);
+        amplitude *= 2;
+    }
+
+    float xs[16], ys[16], zs[16], values[16];
+    for (int z = 0; z < size; z++)
+    {
+        for (int x = 0; x < size; x += 16)
+        {
+            float sums[16] = {};
+            float frequency = 1.f, amplitude = 1.f;
+            for (int octave = 0; octave < settings.heightOctaves; octave++)
+            {
+                for (int i = 0; i < 16; i++)
+                {
+                    xs[i] = (float)(originX + x + i) / PerlinNoise::scaleFactor * frequency;
+                    // A slice half way between lattice planes, offset by octave so they don't line up
+                    ys[i] = 0.5f + (float)octave * 17.f;
+                    zs[i] = (float)(originZ + z) / PerlinNoise::scaleFactor * frequency;
+                }
+
+                noise.noise16(xs, ys, zs, values);
+                for (int i = 0; i < 16; i++)
+                {
+                    sums[i] += (values[i] * 2.f - 1.f) * amplitude;
+                }
+
+                frequency *= 2.f;
+                amplitude *= 0.5f;
+            }
+
+            for (int i = 0; i < 16 && x + i < size; i++)
+            {
+                heightsOut[x + i + size * z] = settings.surfaceHeight + settings.heightVariation * sums[i] / totalAmplitude;
+            }
+        }
+    }
+}
+
+TerrainGenerator::DensityCounts TerrainGenerator::generateDensity(ChunkCoordinate coordinate, const std::vector<float>& heights, std::vector<bool>& blockValuesOut) const
+{
+    const int size = ChunkMap::chunkSize;
+    DensityCounts counts;
+
+    if (settings.mode != heightmapMode)
+    {
+        if (settings.latticeSpacing <= 1)
+        {
+            noise.generateRegion(coordinate.x * size, coordinate.y * size, coordinate.z * size, size, size, size, blockValuesOut);
+            counts.evaluated = (std::size_t)size * size * size;
+            return counts;
+        }
+
+        std::vector<float> values;
+        counts.latticeSamples = noise.sampleRegionLattice(coordinate.x * size, coordinate.y * size, coordinate.z * size, size, size, size, settings.latticeSpacing, values);
+        counts.interpolated = values.size();
+
+        blockValuesOut.assign(values.size(), false);
+        for (std::size_t i = 0; i < values.size(); i++)
+        {
+            if (values[i] > 0.5f)
+            {
+                blockValuesOut[i] = true;
+            }
+        }
+        return counts;
+    }
+
+    blockValuesOut.assign((std::size_t)size * size * size, false);
+
+    // Blocks in the band are queued up and evaluated sixteen at a time
+    float xs[16], ys[16], zs[16], values[16];
+    float surfaceDensities[16];
+    int indices[16];
+    int pendingCount = 0;
+
+    auto evaluatePending = [&]()
+    {
+        if (pendingCount == 0) return;
+
+        for (int i = pendingCount; i < 16; i++)
+        {
+            xs[i] = xs[pendingCount - 1];
+            ys[i] = ys[pendingCount - 1];
+            zs[i] = zs[pendingCount - 1];
+        }
+
+        noise.noise16(xs, ys, zs, values);
+        for (int i = 0; i < pendingCount; i++)
+        {
+            if (surfaceDensities[i] + (values[i] - 0.5f) * 2.f * settings.overhangStrength > 0.f)
+            {
+                blockValuesOut[indices[i]] = true;
+            }
+        }
+
+        counts.evaluated += pendingCount;
+        pendingCount = 0;
+    };
+
+    const float band = (float)Utility::max(settings.surfaceBand, 1);
+    for (int z = 0; z < size; z++)
+    {
+        for (int y = 0; y < size; y++)
+        {
+            const int worldY = coordinate.y * size + y;
+
+            for (int x = 0; x < size; x++)
+            {
+                const float height = heights[x + size * z];
+                const int index = x + size * (y + size * z);
+
+                // Deep down is always solid and high up always air
+                if (worldY < height - band)
+                {
+                    blockValuesOut[index] = true;
+                    continue;
+                }
+                if (worldY > height + band) continue;
+
+                xs[pendingCount] = (float)(coordinate.x * size + x) / PerlinNoise::scaleFactor;
+                ys[pendingCount] = (float)worldY / PerlinNoise::scaleFactor;
+                zs[pendingCount] = (float)(coordinate.z * size + z) / PerlinNoise::scaleFactor;
+                // One at the bottom of the band down to minus one at the top
+                surfaceDensities[pendingCount] = (height - (float)worldY) / band;
+                indices[pendingCount] = index;
+
+                if (++pendingCount == 16)
+                {
+                    evaluatePending();
+                }
+            }
+        }
+    }
+    evaluatePending();
+
+    return counts;
+}
+
+int TerrainGenerator::getNeighbour(int index, int face) const
+{
+    ChunkCoordinate coordinate = coordinates[index];
+    const int axis = face / 2;
+    (axis == 0 ? coordinate.x : axis == 1 ? coordinate.y : coordinate.z) += (face & 1) ? 1 : -1;
+
+    if (coordinate.x < 0 || coordinate.y < 0 || coordinate.z < 0 || coordinate.x >= chunksWide || coordinate.y >= chunksHigh || coordinate.z >= chunksDeep) return -1;
+    return coordinate.x + chunksWide * (coordinate.y + chunksHigh * coordinate.z);
+}
+
+void TerrainGenerator::generate(int chunksWide, int chunksHigh, int chunksDeep, unsigned int threadCount, ChunkMap& output)
+{
+    const std::chrono::high_resolution_clock::time_point start = std::chrono::high_resolution_clock::now();
+
+    TaskGraph graph;
+    addTasks(graph, chunksWide, chunksHigh, chunksDeep, output);
+    graph.run(threadCount);
+
+    statistics.threadCount = (threadCount > 0) ? threadCount : 1;
+    statistics.totalSeconds = secondsSince(start);
+}
+
+TaskGraph::TaskId TerrainGenerator::addTasks(TaskGraph& graph, int chunksWide, int chunksHigh, int chunksDeep, ChunkMap& output)
+{
+    const int size = ChunkMap::chunkSize;
+    const int chunkCount = chunksWide * chunksHigh * chunksDeep;
+    const Occupancy::FaceMasks& masks = ChunkMap::getFaceMasks();
+
+    this->chunksWide = chunksWide;
+    this->chunksHigh = chunksHigh;
+    this->chunksDeep = chunksDeep;
+    const int columnCount = (settings.mode == heightmapMode) ? chunksWide * chunksDeep : 0;
+    chunks.clear();
+    chunks.resize(chunkCount);
+    columnHeights.clear();
+    columnHeights.resize(columnCount);
+    columnStartTimes.resize(columnCount);
+    columnSeconds.assign(columnCount, 0.0);
+    coordinates.resize(chunkCount);
+    densityCounts.assign(chunkCount, DensityCounts());
+    startTimes.resize(chunkCount);
+    for (std::vector<double>& seconds : stageSeconds)
+    {
+        seconds.assign(chunkCount, 0.0);
+    }
+
+    for (int index = 0; index < chunkCount; index++)
+    {
+        coordinates[index] = { index % chunksWide, (index / chunksWide) % chunksHigh, index / (chunksWide * chunksHigh) };
+    }
+
+    // Every chunk in a column has the same surface, so it's worked out once before any of their density
+    std::vector<TaskGraph::TaskId> heightTasks(columnCount);
+    for (int column = 0; column < columnCount; column++)
+    {
+        heightTasks[column] = graph.addTask("Heights", [this, column, size]()
+        {
+            columnStartTimes[column] = std::chrono::high_resolution_clock::now();
+            generateHeights((column % this->chunksWide) * size, (column / this->chunksWide) * size, columnHeights[column]);
+            columnSeconds[column] = secondsSince(columnStartTimes[column]);
+        });
+    }
+
+    std::vector<TaskGraph::TaskId> densityTasks(chunkCount);
+    for (int index = 0; index < chunkCount; index++)
+    {
+        std::vector<TaskGraph::TaskId> dependencies;
+        if (columnCount > 0)
+        {
+            dependencies.push_back(heightTasks[coordinates[index].x + chunksWide * coordinates[index].z]);
+        }
+
+        densityTasks[index] = graph.addTask("Density", [this, index, size]()
+        {
+            startTimes[index] = std::chrono::high_resolution_clock::now();
+
+            static const std::vector<float> noHeights;
+            const ChunkCoordinate& coordinate = coordinates[index];
+            const std::vector<float>& heights = columnHeights.empty() ? noHeights : columnHeights[coordinate.x + this->chunksWide * coordinate.z];
+
+            std::vector<bool> blockValues;
+            densityCounts[index] = generateDensity(coordinate, heights, blockValues);
+
+            chunks[index] = std::make_unique<Chunk>(size, size, size);
+            for (std::size_t i = 0; i < blockValues.size(); i++)
+            {
+                if (blockValues[i])
+                {
+                    chunks[index]->addBlock((int)i, Block{ 0 });
+                }
+            }
+
+            stageSeconds[0][index] = secondsSince(startTimes[index]);
+        }, dependencies);
+    }
+
+    std::vector<TaskGraph::TaskId> surfaceTasks(chunkCount);
+    for (int index = 0; index < chunkCount; index++)
+    {
+        // Exposure reads the occupancy of all six neighbours, which nothing changes once their density is done
+        std::vector<TaskGraph::TaskId> dependencies = { densityTasks[index] };
+        for (int face = 0; face < Chunk::faceCount; face++)
+        {
+            const int neighbour = getNeighbour(index, face);
+            if (neighbour >= 0)
+            {
+                dependencies.push_back(densityTasks[neighbour]);
+            }
+        }
+
+        TaskGraph::TaskId exposure = graph.addTask("Exposure", [this, index, &masks]()
+        {
+            const std::chrono::high_resolution_clock::time_point stageStart = std::chrono::high_resolution_clock::now();
+            Chunk* chunk = chunks[index].get();
+            if (chunk->isEmpty()) return;
+
+            std::vector<uint64_t> neighbours(masks.wordCount);
+            for (int face = 0; face < Chunk::faceCount; face++)
+            {
+                const int neighbour = getNeighbour(index, face);
+                const uint64_t* adjoining = (neighbour >= 0) ? chunks[neighbour]->getOccupancy().data() : nullptr;
+                Occupancy::neighbourBits(neighbours.data(), masks, chunk->getOccupancy().data(), adjoining, face / 2, (face & 1) ? 1 : -1);
+                chunk->refreshExposure(face, neighbours.data());
+            }
+
+            stageSeconds[1][index] = secondsSince(stageStart);
+        }, dependencies);
+
+        // Blocks with nothing above them are grass
+        // Swapping one solid block for another leaves the occupancy alone, so neighbours can still be reading it
+        surfaceTasks[index] = graph.addTask("Surface", [this, index]()
+        {
+            const std::chrono::high_resolution_clock::time_point stageStart = std::chrono::high_resolution_clock::now();
+            Chunk* chunk = chunks[index].get();
+
+            Occupancy::forEachBit(chunk->getExposure(Chunk::topFace), [chunk](int blockIndex)
+            {
+                chunk->addBlock(blockIndex, Block{ 1 });
+            });
+
+            stageSeconds[2][index] = secondsSince(stageStart);
+        }, { exposure });
+    }
+
+    return graph.addTask("Terrain", [this, chunkCount, columnCount, size, &output]()
+    {
+        statistics = Statistics();
+        statistics.chunkCount = chunkCount;
+        if (chunkCount == 0) return;
+
+        // Always added in the same order, so the map ends up the same too
+        std::chrono::high_resolution_clock::time_point start = startTimes[0];
+        for (int index = 0; index < chunkCount; index++)
+        {
+            start = Utility::min(start, startTimes[index]);
+            statistics.blockCount += chunks[index]->getBlockCount();
+            statistics.voxelsEvaluated += densityCounts[index].evaluated;
+            statistics.voxelsInterpolated += densityCounts[index].interpolated;
+            statistics.voxelsFilled += (std::size_t)size * size * size - densityCounts[index].evaluated - densityCounts[index].interpolated;
+            statistics.latticeSamples += densityCounts[index].latticeSamples;
+            statistics.densitySeconds += stageSeconds[0][index];
+            statistics.exposureSeconds += stageSeconds[1][index];
+            statistics.surfaceSeconds += stageSeconds[2][index];
+
+            // Empty chunks are dropped here, so nothing else has to skip them
+            output.setGeneratedChunk(coordinates[index], std::move(chunks[index]));
+        }
+
+        // The heightmap counts as part of density
+        for (int column = 0; column < columnCount; column++)
+        {
+            start = Utility::min(start, columnStartTimes[column]);
+            statistics.heightmapSamples += (std::size_t)size * size * Utility::max(settings.heightOctaves, 0);
+            statistics.densitySeconds += columnSeconds[column];
+        }
+
+        // From the first chunk starting, since other work on the same graph may have gone before it
+        statistics.totalSeconds = secondsSince(start);
+    }, surfaceTasks);
+}
+
+const TerrainGenerator::Statistics& TerrainGenerator::getStatistics() const
+{
+    return statistics;
+}
+
+void TerrainGenerator::printReport() const
+{
+    printf("Terrain:\n");
+    if (statistics.threadCount > 0)
+    {
+        printf("\t%d chunks, %zu blocks, on %u threads\n", statistics.chunkCount, statistics.blockCount, statistics.threadCount);
+    }
+    else
+    {
+        printf("\t%d chunks, %zu blocks, alongside other work\n", statistics.chunkCount, statistics.blockCount);
+    }
+    printf("\t%zu voxels evaluated, %zu filled from the heightmap (%.1f%% skipped)\n", statistics.voxelsEvaluated, statistics.voxelsFilled,
+        100.0 * statistics.voxelsFilled / Utility::max(statistics.voxelsEvaluated + statistics.voxelsInterpolated + statistics.voxelsFilled, (std::size_t)1));
+    if (statistics.voxelsInterpolated > 0)
+    {
+        printf("\t%zu voxels interpolated from %zu lattice samples\n", statistics.voxelsInterpolated, statistics.latticeSamples);
+    }
+    if (statistics.heightmapSamples > 0)
+    {
+        printf("\t%zu heightmap samples\n", statistics.heightmapSamples);
+    }
+
+    // Everything that took a point of noise, against one for every voxel
+    const std::size_t voxelCount = statistics.voxelsEvaluated + statistics.voxelsInterpolated + statistics.voxelsFilled;
+    const std::size_t noiseSamples = statistics.voxelsEvaluated + statistics.latticeSamples + statistics.heightmapSamples;
+    printf("\t%zu points of noise for %zu voxels (%.1fx fewer)\n", noiseSamples, voxelCount, (double)voxelCount / Utility::max(noiseSamples, (std::size_t)1));
+    printf("\tDensity:  %8.1f ms\n", statistics.densitySeconds * 1000.0);
+    printf("\tExposure: %8.1f ms\n", statistics.exposureSeconds * 1000.0);
+    printf("\tSurface:  %8.1f ms\n", statistics.surfaceSeconds * 1000.0);
+    printf("\tTotal:    %8.1f ms\n", statistics.totalSeconds * 1000.0);
+}
+
+uint64_t TerrainGenerator::hashChunks(const ChunkMap& chunks)
+{
+    std::vector<ChunkCoordinate> coordinates;
+    for (const auto& entry : chunks.getChunks())
+    {
+        coordinates.push_back(entry.first);
+    }
+    std::sort(coordinates.begin(), coordinates.end(), [](const ChunkCoordinate& a, const ChunkCoordinate& b)
+    {
+        return (a.z != b.z) ? a.z < b.z : ((a.y != b.y) ? a.y < b.y : a.x < b.x);
+    });
+
+    uint64_t hash = 14695981039346656037ull;
+    for (const ChunkCoordinate& coordinate : coordinates)
+    {
+        const Chunk* chunk = chunks.getChunk(coordinate);
+        hashBytes(hash, &coordinate, sizeof(coordinate));
+
+        const int blockCount = chunk->getWidth() * chunk->getHeight() * chunk->getDepth();
+        for (int index = 0; index < blockCount; index++)
+        {
+            const Block* block = chunk->getBlock(index);
+            const UINT value = block ? block->textureId + 1 : 0;
+            hashBytes(hash, &value, sizeof(value));
+        }
+
+        for (int face = 0; face < Chunk::faceCount; face++)
+        {
+            const std::vector<uint64_t>& exposure = chunk->getExposure(face);
+            hashBytes(hash, exposure.data(), exposure.size() * sizeof(uint64_t));
+        }
+    }
+
+    return hash;
+}
@@ -0,0 +1,780 @@
+#include "TextureCompression.hpp"
+#include <cfloat>
+#include <cmath>
+#include <cstring>
+#include <limits>
+#include <utility>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define TEXTURE_COMPRESSION_SSE2
+#endif
+
+const uint8_t* CompressedTexture::getMip(unsigned int layer, unsigned int mip) const
+{
+    return data.data() + offsets[layer * mipCount + mip];
+}
+
+unsigned int CompressedTexture::getMipWidth(unsigned int mip) const
+{
+    return (width >> mip) ? (width >> mip) : 1;
+}
+
+unsigned int CompressedTexture::getMipHeight(unsigned int mip) const
+{
+    return (height >> mip) ? (height >> mip) : 1;
+}
+
+unsigned int CompressedTexture::getRowPitch(unsigned int mip) const
+{
+    return (unsigned int)(((getMipWidth(mip) + 3) / 4) * TextureCompression::getBlockSize(format));
+}
+
+// Where along the line from endpoint 0 to endpoint 1 each index sits
+static const float colourWeights[4] = { 0.f, 1.f, 1.f / 3.f, 2.f / 3.f };
+static const float alphaWeights[8] = { 0.f, 1.f, 1.f / 7.f, 2.f / 7.f, 3.f / 7.f, 4.f / 7.f, 5.f / 7.f, 6.f / 7.f };
+
+static float clampChannel(float value)
+{
+    return (value < 0.f) ? 0.f : ((value > 255.f) ? 255.f : value);
+}
+
+// Picks the closest palette entry for every pixel, returning the total squared error
+// Ties go to the lower index either way, so the SSE2 and scalar paths agree exactly
+static float findNearest(const float* const pixels[], const float* const palette[], int channelCount, int paletteSize, int indices[16])
+{
+    float totalError = 0.f;
+    int i = 0;
+
+#if defined(TEXTURE_COMPRESSION_SSE2)
+    for (; i < 16; i += 4)
+    {
+        __m128 bestError = _mm_set1_ps(FLT_MAX);
+        __m128i bestIndex = _mm_setzero_si128();
+
+        for (int entry = 0; entry < paletteSize; entry++)
+        {
+            __m128 error = _mm_setzero_ps();
+            for (int channel = 0; channel < channelCount; channel++)
+            {
+                const __m128 difference = _mm_sub_ps(_mm_loadu_ps(pixels[channel] + i), _mm_set1_ps(palette[channel][entry]));
+                error = _mm_add_ps(error, _mm_mul_ps(difference, difference));
+            }
+
+            const __m128i closer = _mm_castps_si128(_mm_cmplt_ps(error, bestError));
+            bestError = _mm_min_ps(error, bestError);
+            bestIndex = _mm_or_si128(_mm_and_si128(closer, _mm_set1_epi32(entry)), _mm_andnot_si128(closer, bestIndex));
+        }
+
+        float errors[4];
+        _mm_storeu_ps(errors, bestError);
+        _mm_storeu_si128((__m128i*)(indices + i), bestIndex);
+        totalError += errors[0] + errors[1] + errors[2] + errors[3];
+    }
+#endif
+
+    for (; i < 16; i++)
+    {
+        float bestError = FLT_MAX;
+        indices[i] = 0;
+
+        for (int entry = 0; entry < paletteSize; entry++)
+        {
+            float error = 0.f;
+            for (int channel = 0; channel < channelCount; channel++)
+            {
+                const float difference = pixels[channel][i] - palette[channel][entry];
+                error += difference * difference;
+            }
+
+            if (error < bestError)
+            {
+                bestError = error;
+                indices[i] = entry;
+            }
+        }
+        totalError += bestError;
+    }
+
+    return totalError;
+}
+
+// Least squares endpoints for the indices already chosen. Returns false if every pixel shares one index.
+static bool solveEndpoints(const float* const pixels[], int channelCount, const int indices[16], const float weights[], float start[], float end[])
+{
+    float startStart = 0.f, startEnd = 0.f, endEnd = 0.f;
+    float startPixel[3] = {}, endPixel[3] = {};
+
+    for (int i = 0; i < 16; i++)
+    {
+        const float t = weights[indices[i]];
+        const float s = 1.f - t;
+        startStart += s * s;
+        startEnd += s * t;
+        endEnd += t * t;
+
+        for (int channel = 0; channel < channelCount; channel++)
+        {
+            startPixel[channel] += s * pixels[channel][i];
+            endPixel[channel] += t * pixels[channel][i];
+        }
+    }
+
+    const float determinant = startStart * endEnd - startEnd * startEnd;
+    if (fabsf(determinant) < 1e-6f) return false;
+
+    for (int channel = 0; channel < channelCount; channel++)
+    {
+        start[channel] = clampChannel((endEnd * startPixel[channel] - startEnd * endPixel[channel]) / determinant);
+        end[channel] = clampChannel((startStart * endPixel[channel] - startEnd * startPixel[channel]) / determinant);
+    }
+
+    return true;
+}
+
+static uint16_t toRGB565(const float colour[3])
+{
+    const unsigned int red = (unsigned int)(clampChannel(colour[0]) * 31.f / 255.f + 0.5f);
+    const unsigned int green = (unsigned int)(clampChannel(colour[1]) * 63.f / 255.f + 0.5f);
+    const unsigned int blue = (unsigned int)(clampChannel(colour[2]) * 31.f / 255.f + 0.5f);
+    return (uint16_t)((red << 11) | (green << 5) | blue);
+}
+
+static void fromRGB565(uint16_t colour, unsigned int output[3])
+{
+    const unsigned int red = (colour >> 11) & 31;
+    const unsigned int green = (colour >> 5) & 63;
+    const unsigned int blue = colour & 31;
+    output[0] = (red << 3) | (red >> 2);
+    output[1] = (green << 2) | (green >> 4);
+    output[2] = (blue << 3) | (blue >> 2);
+}
+
+// BC3 always has four colours, where BC1 drops to three and black when the first endpoint isn't the larger
+static void getColourPalette(uint16_t colour0, uint16_t colour1, bool fourColours, unsigned int palette[4][4])
+{
+    fromRGB565(colour0, palette[0]);
+    fromRGB565(colour1, palette[1]);
+    palette[0][3] = palette[1][3] = palette[2][3] = palette[3][3] = 255;
+
+    for (int channel = 0; channel < 3; channel++)
+    {
+        const unsigned int first = palette[0][channel];
+        const unsigned int second = palette[1][channel];
+        if (fourColours || colour0 > colour1)
+        {
+            palette[2][channel] = (2 * first + second + 1) / 3;
+            palette[3][channel] = (first + 2 * second + 1) / 3;
+        }
+        else
+        {
+            palette[2][channel] = (first + second + 1) / 2;
+            palette[3][channel] = 0;
+        }
+    }
+
+    if (!fourColours && colour0 <= colour1)
+    {
+        palette[3][3] = 0;
+    }
+}
+
+static void getAlphaPalette(unsigned int alpha0, unsigned int alpha1, unsigned int palette[8])
+{
+    palette[0] = alpha0;
+    palette[1] = alpha1;
+
+    if (alpha0 > alpha1)
+    {
+        for (unsigned int i = 2; i < 8; i++)
+        {
+            palette[i] = ((8 - i) * alpha0 + (i - 1) * alpha1 + 3) / 7;
+        }
+    }
+    else
+    {
+        for (unsigned int i = 2; i < 6; i++)
+        {
+            palette[i] = ((6 - i) * alpha0 + (i - 1) * alpha1 + 2) / 5;
+        }
+        palette[6] = 0;
+        palette[7] = 255;
+    }
+}
+
+// Always writes the larger endpoint first, so the block is read with four colours whether it's BC1 or BC3
+static float encodeColours(const float* const pixels[3], const float first[3], const float second[3], uint8_t output[8], int indices[16])
+{
+    uint16_t colour0 = toRGB565(first);
+    uint16_t colour1 = toRGB565(second);
+    if (colour0 < colour1) std::swap(colour0, colour1);
+
+    unsigned int palette[4][4];
+    getColourPalette(colour0, colour1, true, palette);
+
+    float paletteChannels[3][4];
+    for (int entry = 0; entry < 4; entry++)
+    {
+        for (int channel = 0; channel < 3; channel++)
+        {
+            paletteChannels[channel][entry] = (float)palette[entry][channel];
+        }
+    }
+    const float* paletteRows[3] = { paletteChannels[0], paletteChannels[1], paletteChannels[2] };
+
+    // Equal endpoints would be read by BC1 as three colours and black, so only the first is used
+    const float error = findNearest(pixels, paletteRows, 3, (colour0 == colour1) ? 1 : 4, indices);
+
+    uint32_t packedIndices = 0;
+    for (int i = 0; i < 16; i++)
+    {
+        packedIndices |= (uint32_t)indices[i] << (i * 2);
+    }
+
+    output[0] = (uint8_t)colour0;
+    output[1] = (uint8_t)(colour0 >> 8);
+    output[2] = (uint8_t)colour1;
+    output[3] = (uint8_t)(colour1 >> 8);
+    for (int i = 0; i < 4; i++)
+    {
+        output[4 + i] = (uint8_t)(packedIndices >> (i * 8));
+    }
+
+    return error;
+}
+
+// Endpoints at the ends of the line through the colours
+// Quality 0 takes the bounding box's diagonal, pulled in slightly so the ends aren't wasted on outliers, and anything higher the principal axis
+static void fitColourLine(const float* const pixels[3], int quality, float start[3], float end[3])
+{
+    float minimum[3], maximum[3], mean[3];
+    for (int channel = 0; channel < 3; channel++)
+    {
+        minimum[channel] = maximum[channel] = pixels[channel][0];
+        mean[channel] = 0.f;
+        for (int i = 0; i < 16; i++)
+        {
+            minimum[channel] = fminf(minimum[channel], pixels[channel][i]);
+            maximum[channel] = fmaxf(maximum[channel], pixels[channel][i]);
+            mean[channel] += pixels[channel][i] / 16.f;
+        }
+
+        const float inset = (maximum[channel] - minimum[channel]) / 16.f;
+        start[channel] = minimum[channel] + inset;
+        end[channel] = maximum[channel] - inset;
+    }
+
+    if (quality <= 0) return;
+
+    float covariance[6] = {}; // rr, rg, rb, gg, gb, bb
+    for (int i = 0; i < 16; i++)
+    {
+        const float red = pixels[0][i] - mean[0];
+        const float green = pixels[1][i] - mean[1];
+        const float blue = pixels[2][i] - mean[2];
+        covariance[0] += red * red;
+        covariance[1] += red * green;
+        covariance[2] += red * blue;
+        covariance[3] += green * green;
+        covariance[4] += green * blue;
+        covariance[5] += blue * blue;
+    }
+
+    // A few rounds of power iteration, starting from the bounding box's diagonal
+    float axis[3] = { maximum[0] - minimum[0], maximum[1] - minimum[1], maximum[2] - minimum[2] };
+    for (int iteration = 0; iteration < 8; iteration++)
+    {
+        const float next[3] = {
+            covariance[0] * axis[0] + covariance[1] * axis[1] + covariance[2] * axis[2],
+            covariance[1] * axis[0] + covariance[3] * axis[1] + covariance[4] * axis[2],
+            covariance[2] * axis[0] + covariance[4] * axis[1] + covariance[5] * axis[2]
+        };
+        const float length = sqrtf(next[0] * next[0] + next[1] * next[1] + next[2] * next[2]);
+        if (length < 1e-6f) return; // One flat colour, which the bounding box already covers
+
+        for (int channel = 0; channel < 3; channel++)
+        {
+            axis[channel] = next[channel] / length;
+        }
+    }
+
+    float lowest = FLT_MAX, highest = -FLT_MAX;
+    for (int i = 0; i < 16; i++)
+    {
+        const float t = (pixels[0][i] - mean[0]) * axis[0] + (pixels[1][i] - mean[1]) * axis[1] + (pixels[2][i] - mean[2]) * axis[2];
+        lowest = fminf(lowest, t);
+        highest = fmaxf(highest, t);
+    }
+
+    for (int channel = 0; channel < 3; channel++)
+    {
+        start[channel] = mean[channel] + axis[channel] * lowest;
+        end[channel] = mean[channel] + axis[channel] * highest;
+    }
+}
+
+static float encodeAlpha(const float values[16], float first, float second, uint8_t output[8], int indices[16])
+{
+    unsigned int alpha0 = (unsigned int)(clampChannel(first) + 0.5f);
+    unsigned int alpha1 = (unsigned int)(clampChannel(second) + 0.5f);
+    if (alpha0 < alpha1) std::swap(alpha0, alpha1);
+
+    unsigned int palette[8];
+    getAlphaPalette(alpha0, alpha1, palette);
+
+    float paletteValues[8];
+    for (int entry = 0; entry < 8; entry++)
+    {
+        paletteValues[entry] = (float)palette[entry];
+    }
+    const float* paletteRows[1] = { paletteValues };
+    const float* pixelRows[1] = { values };
+
+    // Equal endpoints are read as six levels plus 0 and 255, so those are left out
+    const float error = findNearest(pixelRows, paletteRows, 1, (alpha0 == alpha1) ? 1 : 8, indices);
+
+    uint64_t packedIndices = 0;
+    for (int i = 0; i < 16; i++)
+    {
+        packedIndices |= (uint64_t)indices[i] << (i * 3);
+    }
+
+    output[0] = (uint8_t)alpha0;
+    output[1] = (uint8_t)alpha1;
+    for (int i = 0; i < 6; i++)
+    {
+        output[2 + i] = (uint8_t)(packedIndices >> (i * 8));
+    }
+
+    return error;
+}
+
+static void encodeBlock(const uint8_t block[64], unsigned int format, int quality, uint8_t* output)
+{
+    switch (format)
+    {
+        case TextureCompression::bc1Format:
+        {
+            TextureCompression::encodeBC1(block, output, quality);
+            break;
+        }
+        case TextureCompression::bc3Format:
+        {
+            TextureCompression::encodeBC3(block, output, quality);
+            break;
+        }
+        case TextureCompression::bc5Format:
+        {
+            TextureCompression::encodeBC5(block, output, quality);
+            break;
+        }
+    }
+}
+
+static void decodeBlock(const uint8_t* input, unsigned int format, uint8_t block[64])
+{
+    switch (format)
+    {
+        case TextureCompression::bc1Format:
+        {
+            TextureCompression::decodeBC1(input, block);
+            break;
+        }
+        case TextureCompression::bc3Format:
+        {
+            TextureCompression::decodeBC3(input, block);
+            break;
+        }
+        case TextureCompression::bc5Format:
+        {
+            TextureCompression::decodeBC5(input, block);
+            break;
+        }
+    }
+}
+
+static void compressPixels(const uint8_t* pixels, unsigned int width, unsigned int height, unsigned int format, int quality, uint8_t* output)
+{
+    const std::size_t blockSize = TextureCompression::getBlockSize(format);
+    uint8_t block[64];
+
+    for (unsigned int blockY = 0; blockY < (height + 3) / 4; blockY++)
+    {
+        for (unsigned int blockX = 0; blockX < (width + 3) / 4; blockX++)
+        {
+            for (unsigned int y = 0; y < 4; y++)
+            {
+                const unsigned int sourceY = (blockY * 4 + y < height) ? blockY * 4 + y : height - 1;
+                for (unsigned int x = 0; x < 4; x++)
+                {
+                    const unsigned int sourceX = (blockX * 4 + x < width) ? blockX * 4 + x : width - 1;
+                    memcpy(&block[(y * 4 + x) * 4], &pixels[((std::size_t)sourceY * width + sourceX) * 4], 4);
+                }
+            }
+
+            encodeBlock(block, format, quality, output);
+            output += blockSize;
+        }
+    }
+}
+
+static void writeUInt32(std::vector<uint8_t>& output, uint32_t value)
+{
+    for (int i = 0; i < 4; i++)
+    {
+        output.push_back((uint8_t)(value >> (i * 8)));
+    }
+}
+
+static uint32_t readUInt32(const uint8_t* input)
+{
+    return (uint32_t)input[0] | ((uint32_t)input[1] << 8) | ((uint32_t)input[2] << 16) | ((uint32_t)input[3] << 24);
+}
+
+// Offsets into a DDS file, in 32-bit words after the "DDS " magic
+static const uint32_t ddsMagic = 0x20534444u; // "DDS "
+static const uint32_t ddsDX10 = 0x30315844u; // "DX10"
+static const std::size_t ddsHeaderWords = 31;
+static const std::size_t ddsDX10Words = 5;
+static const std::size_t ddsDataOffset = 4 + (ddsHeaderWords + ddsDX10Words) * 4;
+
+namespace TextureCompression
+{
+    void encodeBC1(const uint8_t block[64], uint8_t output[8], int quality)
+    {
+        float channels[3][16];
+        for (int i = 0; i < 16; i++)
+        {
+            for (int channel = 0; channel < 3; channel++)
+            {
+                channels[channel][i] = block[i * 4 + channel];
+            }
+        }
+        const float* pixels[3] = { channels[0], channels[1], channels[2] };
+
+        float start[3], end[3];
+        fitColourLine(pixels, quality, start, end);
+
+        int indices[16];
+        float error = encodeColours(pixels, start, end, output, indices);
+
+        // Fitting the endpoints to the indices can pick different indices, so go round a couple of times
+        for (int iteration = 0; quality >= maxQuality && iteration < 2; iteration++)
+        {
+            float first[3], second[3];
+            if (!solveEndpoints(pixels, 3, indices, colourWeights, first, second)) break;
+
+            uint8_t candidate[8];
+            int candidateIndices[16];
+            const float candidateError = encodeColours(pixels, first, second, candidate, candidateIndices);
+            if (candidateError >= error) break;
+
+            error = candidateError;
+            memcpy(output, candidate, 8);
+            memcpy(indices, candidateIndices, sizeof(indices));
+        }
+    }
+
+    void encodeBC4(const uint8_t block[64], int channel, uint8_t output[8], int quality)
+    {
+        float values[16];
+        float minimum = 255.f, maximum = 0.f;
+        for (int i = 0; i < 16; i++)
+        {
+            values[i] = block[i * 4 + channel];
+            minimum = fminf(minimum, values[i]);
+            maximum = fmaxf(maximum, values[i]);
+        }
+
+        // The extremes are already the best line through a single channel, so only refining helps here
+        int indices[16];
+        float error = encodeAlpha(values, maximum, minimum, output, indices);
+
+        for (int iteration = 0; quality >= maxQuality && iteration < 2; iteration++)
+        {
+            const float* pixels[1] = { values };
+            float first, second;
+            if (!solveEndpoints(pixels, 1, indices, alphaWeights, &first, &second)) break;
+
+            uint8_t candidate[8];
+            int candidateIndices[16];
+            const float candidateError = encodeAlpha(values, first, second, candidate, candidateIndices);
+            if (candidateError >= error) break;
+
+            error = candidateError;
+            memcpy(output, candidate, 8);
+            memcpy(indices, candidateIndices, sizeof(indices));
+        }
+    }
+
+    void encodeBC3(const uint8_t block[64], uint8_t output[16], int quality)
+    {
+        encodeBC4(block, 3, output, quality);
+        encodeBC1(block, output + 8, quality);
+    }
+
+    void encodeBC5(const uint8_t block[64], uint8_t output[16], int quality)
+    {
+        encodeBC4(block, 0, output, quality);
+        encodeBC4(block, 1, output + 8, quality);
+    }
+
+    void decodeBC1(const uint8_t input[8], uint8_t block[64])
+    {
+        const uint16_t colour0 = (uint16_t)(input[0] | (input[1] << 8));
+        const uint16_t colour1 = (uint16_t)(input[2] | (input[3] << 8));
+        const uint32_t indices = readUInt32(input + 4);
+
+        unsigned int palette[4][4];
+        getColourPalette(colour0, colour1, false, palette);
+
+        for (int i = 0; i < 16; i++)
+        {
+            const unsigned int* colour = palette[(indices >> (i * 2)) & 3];
+            for (int channel = 0; channel < 4; channel++)
+            {
+                block[i * 4 + channel] = (uint8_t)colour[channel];
+            }
+        }
+    }
+
+    void decodeBC4(const uint8_t input[8], int channel, uint8_t block[64])
+    {
+        unsigned int palette[8];
+        getAlphaPalette(input[0], input[1], palette);
+
+        uint64_t indices = 0;
+        for (int i = 0; i < 6; i++)
+        {
+            indices |= (uint64_t)input[2 + i] << (i * 8);
+        }
+
+        for (int i = 0; i < 16; i++)
+        {
+            block[i * 4 + channel] = (uint8_t)palette[(indices >> (i * 3)) & 7];
+        }
+    }
+
+    void decodeBC3(const uint8_t input[16], uint8_t block[64])
+    {
+        const uint16_t colour0 = (uint16_t)(input[8] | (input[9] << 8));
+        const uint16_t colour1 = (uint16_t)(input[10] | (input[11] << 8));
+        const uint32_t indices = readUInt32(input + 12);
+
+        unsigned int palette[4][4];
+        getColourPalette(colour0, colour1, true, palette);
+
+        for (int i = 0; i < 16; i++)
+        {
+            const unsigned int* colour = palette[(indices >> (i * 2)) & 3];
+            for (int channel = 0; channel < 3; channel++)
+            {
+                block[i * 4 + channel] = (uint8_t)colour[channel];
+            }
+        }
+
+        decodeBC4(input, 3, block);
+    }
+
+    void decodeBC5(const uint8_t input[16], uint8_t block[64])
+    {
+        for (int i = 0; i < 16; i++)
+        {
+            block[i * 4 + 2] = 0;
+            block[i * 4 + 3] = 255;
+        }
+
+        decodeBC4(input, 0, block);
+        decodeBC4(input + 8, 1, block);
+    }
+
+    std::size_t getBlockSize(unsigned int format)
+    {
+        return (format == bc1Format) ? 8 : 16;
+    }
+
+    std::size_t getCompressedSize(unsigned int width, unsigned int height, unsigned int format)
+    {
+        return (std::size_t)((width + 3) / 4) * ((height + 3) / 4) * getBlockSize(format);
+    }
+
+    std::vector<uint8_t> compressImage(const TextureImage& image, unsigned int format, int quality)
+    {
+        std::vector<uint8_t> result(getCompressedSize(image.width, image.height, format));
+        if (!result.empty())
+        {
+            compressPixels(image.pixels.data(), image.width, image.height, format, quality, result.data());
+        }
+
+        return result;
+    }
+
+    void decompressImage(const uint8_t* data, unsigned int width, unsigned int height, unsigned int format, TextureImage& output)
+    {
+        output.width = width;
+        output.height = height;
+        output.pixels.resize((std::size_t)width * height * 4);
+
+        const std::size_t blockSize = getBlockSize(format);
+        uint8_t block[64];
+
+        for (unsigned int blockY = 0; blockY < (height + 3) / 4; blockY++)
+        {
+            for (unsigned int blockX = 0; blockX < (width + 3) / 4; blockX++)
+            {
+                decodeBlock(data, format, block);
+                data += blockSize;
+
+                // Padding pixels past the edge are dropped
+                for (unsigned int y = 0; y < 4 && blockY * 4 + y < height; y++)
+                {
+                    for (unsigned int x = 0; x < 4 && blockX * 4 + x < width; x++)
+                    {
+                        memcpy(&output.pixels[((std::size_t)(blockY * 4 + y) * width + blockX * 4 + x) * 4], &block[(y * 4 + x) * 4], 4);
+                    }
+                }
+            }
+        }
+    }
+
+    void compress(const TextureArray& source, unsigned int format, int quality, CompressedTexture& output)
+    {
+        output.width = source.width;
+        output.height = source.height;
+        output.mipCount = source.mipCount;
+        output.layerCount = source.layerCount;
+        output.format = format;
+        output.offsets.clear();
+
+        std::size_t size = 0;
+        for (unsigned int layer = 0; layer < source.layerCount; layer++)
+        {
+            for (unsigned int mip = 0; mip < source.mipCount; mip++)
+            {
+                output.offsets.push_back(size);
+                size += getCompressedSize(source.getMipWidth(mip), source.getMipHeight(mip), format);
+            }
+        }
+        output.data.resize(size);
+
+        for (unsigned int layer = 0; layer < source.layerCount; layer++)
+        {
+            for (unsigned int mip = 0; mip < source.mipCount; mip++)
+            {
+                compressPixels(source.getMip(layer, mip), source.getMipWidth(mip), source.getMipHeight(mip), format, quality,
+                    output.data.data() + output.offsets[layer * output.mipCount + mip]);
+            }
+        }
+    }
+
+    bool isOpaque(const TextureImage& image)
+    {
+        for (std::size_t i = 3; i < image.pixels.size(); i += 4)
+        {
+            if (image.pixels[i] != 255) return false;
+        }
+
+        return true;
+    }
+
+    double calculatePSNR(const TextureImage& original, const TextureImage& compressed, unsigned int channelCount)
+    {
+        if (original.width != compressed.width || original.height != compressed.height || original.pixels.size() != compressed.pixels.size()) return 0.0;
+
+        double squaredError = 0.0;
+        for (std::size_t i = 0; i < original.pixels.size(); i += 4)
+        {
+            for (unsigned int channel = 0; channel < channelCount; channel++)
+            {
+                const double difference = (double)original.pixels[i + channel] - compressed.pixels[i + channel];
+                squaredError += difference * difference;
+            }
+        }
+
+        const double sampleCount = (double)original.width * original.height * channelCount;
+        if (squaredError == 0.0 || sampleCount == 0.0) return std::numeric_limits<double>::infinity();
+
+        return 10.0 * log10(255.0 * 255.0 / (squaredError / sampleCount));
+    }
+
+    std::vector<uint8_t> writeDDS(const CompressedTexture& texture)
+    {
+        std::vector<uint8_t> result;
+        result.reserve(ddsDataOffset + texture.data.size());
+
+        writeUInt32(result, ddsMagic);
+
+        // DDS_HEADER, with the caps, height, width, pixel format, mip count and linear size flags
+        writeUInt32(result, (uint32_t)ddsHeaderWords * 4);
+        writeUInt32(result, 0x1 | 0x2 | 0x4 | 0x1000 | 0x20000 | 0x80000);
+        writeUInt32(result, texture.height);
+        writeUInt32(result, texture.width);
+        writeUInt32(result, (uint32_t)getCompressedSize(texture.width, texture.height, texture.format));
+        writeUInt32(result, 0); // Depth
+        writeUInt32(result, texture.mipCount);
+        for (int i = 0; i < 11; i++)
+        {
+            writeUInt32(result, 0);
+        }
+
+        // DDS_PIXELFORMAT, which only points on to the DX10 header
+        writeUInt32(result, 32);
+        writeUInt32(result, 0x4); // Four CC
+        writeUInt32(result, ddsDX10);
+        for (int i = 0; i < 5; i++)
+        {
+            writeUInt32(result, 0);
+        }
+
+        writeUInt32(result, 0x1000 | 0x8 | 0x400000); // Texture, complex, mipmapped
+        for (int i = 0; i < 4; i++)
+        {
+            writeUInt32(result, 0);
+        }
+
+        // DDS_HEADER_DXT10
+        writeUInt32(result, texture.format);
+        writeUInt32(result, 3); // Texture 2D
+        writeUInt32(result, 0);
+        writeUInt32(result, texture.layerCount);
+        writeUInt32(result, 0);
+
+        result.insert(result.end(), texture.data.begin(), texture.data.end());
+        return result;
+    }
+
+    bool readDDS(const void* data, std::size_t size, CompressedTexture& output)
+    {
+        const uint8_t* bytes = (const uint8_t*)data;
+        if (!bytes || size < ddsDataOffset) return false;
+
+        const uint8_t* header = bytes + 4;
+        const uint8_t* dx10Header = header + ddsHeaderWords * 4;
+        if (readUInt32(bytes) != ddsMagic || readUInt32(header) != ddsHeaderWords * 4 || readUInt32(header + 20 * 4) != ddsDX10) return false;
+
+        const unsigned int format = readUInt32(dx10Header);
+        if ((format != bc1Format && format != bc3Format && format != bc5Format) || readUInt32(dx10Header + 4) != 3) return false;
+
+        output.height = readUInt32(header + 2 * 4);
+        output.width = readUInt32(header + 3 * 4);
+        output.mipCount = readUInt32(header + 6 * 4);
+        output.layerCount = readUInt32(dx10Header + 3 * 4);
+        output.format = format;
+        if (output.width == 0 || output.height == 0 || output.mipCount == 0 || output.mipCount > 32 || output.layerCount == 0) return false;
+
+        output.offsets.clear();
+        std::size_t dataSize = 0;
+        for (unsigned int layer = 0; layer < output.layerCount; layer++)
+        {
+            for (unsigned int mip = 0; mip < output.mipCount; mip++)
+            {
+                output.offsets.push_back(dataSize);
+                dataSize += getCompressedSize(output.getMipWidth(mip), output.getMipHeight(mip), format);
+            }
+        }
+        if (size - ddsDataOffset < dataSize) return false;
+
+        output.data.assign(bytes + ddsDataOffset, bytes + ddsDataOffset + dataSize);
+        return true;
+    }
+}
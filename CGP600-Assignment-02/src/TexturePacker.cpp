@@ -0,0 +1,217 @@
+#include "TexturePacker.hpp"
+#include <algorithm>
+#include <cmath>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define TEXTURE_PACKER_SSE2
+#endif
+
+const uint8_t* TextureArray::getMip(unsigned int layer, unsigned int mip) const
+{
+    return data.data() + offsets[layer * mipCount + mip];
+}
+
+unsigned int TextureArray::getMipWidth(unsigned int mip) const
+{
+    return (width >> mip) ? (width >> mip) : 1;
+}
+
+unsigned int TextureArray::getMipHeight(unsigned int mip) const
+{
+    return (height >> mip) ? (height >> mip) : 1;
+}
+
+// Averaging shortens normals that don't all point the same way, which would dim the lighting at a distance
+static void renormalise(TextureImage& image)
+{
+    for (std::size_t i = 0; i < image.pixels.size(); i += 4)
+    {
+        float normal[3];
+        for (int channel = 0; channel < 3; channel++)
+        {
+            normal[channel] = image.pixels[i + channel] / 255.f * 2.f - 1.f;
+        }
+
+        const float length = sqrtf(normal[0] * normal[0] + normal[1] * normal[1] + normal[2] * normal[2]);
+        if (length < 1e-6f) continue;
+
+        for (int channel = 0; channel < 3; channel++)
+        {
+            image.pixels[i + channel] = (uint8_t)((normal[channel] / length * 0.5f + 0.5f) * 255.f + 0.5f);
+        }
+    }
+}
+
+static void resizeForMip(const TextureImage& source, TextureImage& output)
+{
+    output.width = (source.width > 1) ? source.width / 2 : 1;
+    output.height = (source.height > 1) ? source.height / 2 : 1;
+    output.pixels.resize((std::size_t)output.width * output.height * 4);
+}
+
+namespace TexturePacker
+{
+    unsigned int getMipCount(unsigned int width, unsigned int height)
+    {
+        unsigned int result = 1;
+        while (width > 1 || height > 1)
+        {
+            width = (width > 1) ? width / 2 : 1;
+            height = (height > 1) ? height / 2 : 1;
+            result++;
+        }
+
+        return result;
+    }
+
+    void downsample(const TextureImage& source, TextureImage& output, bool normalMap)
+    {
+        resizeForMip(source, output);
+
+        for (unsigned int y = 0; y < output.height; y++)
+        {
+            // Odd sizes lose their last row or column, and single rows or columns are averaged with themselves
+            const uint8_t* row0 = &source.pixels[(std::size_t)(y * 2) * source.width * 4];
+            const uint8_t* row1 = &source.pixels[(std::size_t)((y * 2 + 1 < source.height) ? y * 2 + 1 : y * 2) * source.width * 4];
+            uint8_t* target = &output.pixels[(std::size_t)y * output.width * 4];
+            unsigned int x = 0;
+
+#if defined(TEXTURE_PACKER_SSE2)
+            // Four output pixels from eight across two rows, added up in 16 bits so nothing overflows
+            if (source.width > 1)
+            {
+                const __m128i zero = _mm_setzero_si128();
+                const __m128i two = _mm_set1_epi16(2);
+                for (; x + 4 <= output.width; x += 4)
+                {
+                    const __m128i top0 = _mm_loadu_si128((const __m128i*)(row0 + x * 8));
+                    const __m128i top1 = _mm_loadu_si128((const __m128i*)(row0 + x * 8 + 16));
+                    const __m128i bottom0 = _mm_loadu_si128((const __m128i*)(row1 + x * 8));
+                    const __m128i bottom1 = _mm_loadu_si128((const __m128i*)(row1 + x * 8 + 16));
+
+                    // Pixels 0-1, 2-3, 4-5 and 6-7, each summed down the column
+                    const __m128i sum01 = _mm_add_epi16(_mm_unpacklo_epi8(top0, zero), _mm_unpacklo_epi8(bottom0, zero));
+                    const __m128i sum23 = _mm_add_epi16(_mm_unpackhi_epi8(top0, zero), _mm_unpackhi_epi8(bottom0, zero));
+                    const __m128i sum45 = _mm_add_epi16(_mm_unpacklo_epi8(top1, zero), _mm_unpacklo_epi8(bottom1, zero));
+                    const __m128i sum67 = _mm_add_epi16(_mm_unpackhi_epi8(top1, zero), _mm_unpackhi_epi8(bottom1, zero));
+
+                    // Then each even pixel added to the odd one beside it
+                    __m128i first = _mm_add_epi16(_mm_unpacklo_epi64(sum01, sum23), _mm_unpackhi_epi64(sum01, sum23));
+                    __m128i second = _mm_add_epi16(_mm_unpacklo_epi64(sum45, sum67), _mm_unpackhi_epi64(sum45, sum67));
+                    first = _mm_srli_epi16(_mm_add_epi16(first, two), 2);
+                    second = _mm_srli_epi16(_mm_add_epi16(second, two), 2);
+
+                    _mm_storeu_si128((__m128i*)(target + x * 4), _mm_packus_epi16(first, second));
+                }
+            }
+#endif
+
+            for (; x < output.width; x++)
+            {
+                const unsigned int x0 = x * 2;
+                const unsigned int x1 = (x0 + 1 < source.width) ? x0 + 1 : x0;
+                for (int channel = 0; channel < 4; channel++)
+                {
+                    target[x * 4 + channel] = (uint8_t)((row0[x0 * 4 + channel] + row0[x1 * 4 + channel] + row1[x0 * 4 + channel] + row1[x1 * 4 + channel] + 2) >> 2);
+                }
+            }
+        }
+
+        if (normalMap)
+        {
+            renormalise(output);
+        }
+    }
+
+    void downsampleReference(const TextureImage& source, TextureImage& output, bool normalMap)
+    {
+        resizeForMip(source, output);
+
+        for (unsigned int y = 0; y < output.height; y++)
+        {
+            const unsigned int y0 = y * 2;
+            const unsigned int y1 = (y0 + 1 < source.height) ? y0 + 1 : y0;
+
+            for (unsigned int x = 0; x < output.width; x++)
+            {
+                const unsigned int x0 = x * 2;
+                const unsigned int x1 = (x0 + 1 < source.width) ? x0 + 1 : x0;
+
+                for (int channel = 0; channel < 4; channel++)
+                {
+                    const unsigned int sum =
+                        source.pixels[((std::size_t)y0 * source.width + x0) * 4 + channel] + source.pixels[((std::size_t)y0 * source.width + x1) * 4 + channel] +
+                        source.pixels[((std::size_t)y1 * source.width + x0) * 4 + channel] + source.pixels[((std::size_t)y1 * source.width + x1) * 4 + channel];
+                    output.pixels[((std::size_t)y * output.width + x) * 4 + channel] = (uint8_t)((sum + 2) / 4);
+                }
+            }
+        }
+
+        if (normalMap)
+        {
+            renormalise(output);
+        }
+    }
+
+    TextureImage makeSolid(unsigned int width, unsigned int height, uint8_t red, uint8_t green, uint8_t blue, uint8_t alpha)
+    {
+        TextureImage result;
+        result.width = width;
+        result.height = height;
+        result.pixels.resize((std::size_t)width * height * 4);
+
+        for (std::size_t i = 0; i < result.pixels.size(); i += 4)
+        {
+            result.pixels[i] = red;
+            result.pixels[i + 1] = green;
+            result.pixels[i + 2] = blue;
+            result.pixels[i + 3] = alpha;
+        }
+
+        return result;
+    }
+
+    bool pack(const std::vector<TextureImage>& layers, bool normalMap, TextureArray& output)
+    {
+        if (layers.empty()) return false;
+
+        output.width = layers[0].width;
+        output.height = layers[0].height;
+        output.mipCount = getMipCount(output.width, output.height);
+        output.layerCount = (unsigned int)layers.size();
+        output.offsets.clear();
+
+        std::size_t size = 0;
+        for (const TextureImage& layer : layers)
+        {
+            if (layer.width != output.width || layer.height != output.height || layer.pixels.size() != (std::size_t)layer.width * layer.height * 4) return false;
+
+            for (unsigned int mip = 0; mip < output.mipCount; mip++)
+            {
+                output.offsets.push_back(size);
+                size += (std::size_t)output.getMipWidth(mip) * output.getMipHeight(mip) * 4;
+            }
+        }
+        output.data.resize(size);
+
+        // Each mip is made from the one before it
+        TextureImage previous, next;
+        for (unsigned int layer = 0; layer < output.layerCount; layer++)
+        {
+            previous = layers[layer];
+            std::copy(previous.pixels.begin(), previous.pixels.end(), output.data.begin() + output.offsets[layer * output.mipCount]);
+
+            for (unsigned int mip = 1; mip < output.mipCount; mip++)
+            {
+                downsample(previous, next, normalMap);
+                std::copy(next.pixels.begin(), next.pixels.end(), output.data.begin() + output.offsets[layer * output.mipCount + mip]);
+                previous.width = next.width;
+                previous.height = next.height;
+                previous.pixels.swap(next.pixels);
+            }
+        }
+
+        return true;
+    }
+}
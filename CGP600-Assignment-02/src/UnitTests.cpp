@@ -1,6 +1,38 @@
 #include "UnitTests.hpp"
 #include "Utility.hpp"
 #include "collision/AABB.hpp"
+#include "ChunkMap.hpp"
+#include "SparseVoxelOctree.hpp"
+#include "Compression.hpp"
+#include "Occupancy.hpp"
+#include "VoxelGrid.hpp"
+#include "WorldSnapshot.hpp"
+#include "SlotAllocator.hpp"
+#include "DirtyRangeTracker.hpp"
+#include "ChunkMesher.hpp"
+#include "VertexPacking.hpp"
+#include "MeshOptimiser.hpp"
+#include "ObjParser.hpp"
+#include "MeshCache.hpp"
+#include "AssetCache.hpp"
+#include "TaskGraph.hpp"
+#include "TexturePacker.hpp"
+#include "TextureCompression.hpp"
+#include "PerlinNoise.hpp"
+#include "TerrainGenerator.hpp"
+#include "SimplexNoise.hpp"
+#include "FractalNoise.hpp"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <cstring>
+#include <memory>
+#include <random>
+#include <set>
+#include <stdexcept>
+#include <thread>
+#include <tuple>
 
 namespace UnitTests
 {
@@ -326,6 +358,2346 @@ namespace UnitTests
         return result;
     }
 
+    bool chunk()
+    {
+        bool result = true;
+
+        Chunk chunk(4, 4, 4);
+
+        if (!chunk.isEmpty() || chunk.getBlock(1, 2, 3) != nullptr)
+        {
+            result = false;
+        }
+
+        chunk.addBlock(1, 2, 3, { 5 });
+        if (chunk.getBlock(1, 2, 3) == nullptr || chunk.getBlock(1, 2, 3)->textureId != 5)
+        {
+            result = false;
+        }
+        if (chunk.getBlock(3, 2, 1) != nullptr)
+        {
+            result = false;
+        }
+
+        // Overwriting a block shouldn't change the count
+        chunk.addBlock(1, 2, 3, { 6 });
+        if (chunk.getBlockCount() != 1 || chunk.getBlock(1, 2, 3)->textureId != 6)
+        {
+            result = false;
+        }
+
+        chunk.removeBlock(1, 2, 3);
+        if (chunk.getBlock(1, 2, 3) != nullptr || !chunk.isEmpty())
+        {
+            result = false;
+        }
+
+        printf("Chunk test: %s\n", successString(result));
+        return result;
+    }
+
+    bool chunkPalette()
+    {
+        bool result = true;
+
+        Chunk chunk(32, 32, 32);
+
+        // 300 distinct values forces the indices from 4 to 8 to 16 bits
+        for (int i = 0; i < 300; i++)
+        {
+            chunk.addBlock(i, { (UINT)i });
+        }
+        if (chunk.getBitsPerBlock() != 16)
+        {
+            result = false;
+        }
+        for (int i = 0; i < 300; i++)
+        {
+            if (chunk.getBlock(i) == nullptr || chunk.getBlock(i)->textureId != (UINT)i)
+            {
+                result = false;
+            }
+        }
+
+        // Entries that fall out of use should be recycled rather than growing the palette
+        std::size_t paletteSize = chunk.getPaletteSize();
+        chunk.removeBlock(10);
+        chunk.addBlock(10, { 1000 });
+        if (chunk.getPaletteSize() != paletteSize || chunk.getBlock(10)->textureId != 1000)
+        {
+            result = false;
+        }
+
+        printf("Chunk palette test: %s\n", successString(result));
+        return result;
+    }
+
+    bool chunkMap()
+    {
+        bool result = true;
+
+        ChunkMap map;
+
+        if (ChunkMap::getChunkCoordinate(-1, 0, ChunkMap::chunkSize) != ChunkCoordinate{ -1, 0, 1 })
+        {
+            result = false;
+        }
+        if (ChunkMap::getLocalCoordinate(-1) != ChunkMap::chunkSize - 1)
+        {
+            result = false;
+        }
+
+        // Blocks either side of a chunk boundary, including negative coordinates
+        map.addBlock(-1, 5, 0, { 1 });
+        map.addBlock(0, 5, 0, { 2 });
+        map.addBlock(10000, -300, 20, { 3 });
+        if (map.getChunkCount() != 3)
+        {
+            result = false;
+        }
+        if (!map.getBlock(-1, 5, 0) || map.getBlock(-1, 5, 0)->textureId != 1 ||
+            !map.getBlock(0, 5, 0) || map.getBlock(0, 5, 0)->textureId != 2 ||
+            !map.getBlock(10000, -300, 20) || map.getBlock(10000, -300, 20)->textureId != 3)
+        {
+            result = false;
+        }
+        if (map.getBlock(1, 5, 0) || map.getBlock(-5000, 0, 0))
+        {
+            result = false;
+        }
+
+        // Removing the last block in a chunk should drop the chunk
+        map.removeBlock(10000, -300, 20);
+        if (map.getChunkCount() != 2 || map.getBlock(10000, -300, 20))
+        {
+            result = false;
+        }
+
+        printf("Chunk map test: %s\n", successString(result));
+        return result;
+    }
+
+    bool sparseVoxelOctree()
+    {
+        bool result = true;
+
+        SparseVoxelOctree octree(0, 0, 0, 6, true);
+        std::size_t emptyNodeCount = octree.getNodeCount();
+
+        // Editing a single block splits the tree down to that block
+        octree.addBlock(5, 6, 7, { 2 });
+        if (!octree.getBlock(5, 6, 7) || octree.getBlock(5, 6, 7)->textureId != 2 || octree.getBlock(5, 6, 6))
+        {
+            result = false;
+        }
+        if (octree.getNodeCount() != 6)
+        {
+            result = false;
+        }
+
+        // Removing it again should merge everything back into a single uniform root
+        octree.removeBlock(5, 6, 7);
+        if (octree.getBlock(5, 6, 7) || octree.getNodeCount() != emptyNodeCount)
+        {
+            result = false;
+        }
+
+        // Filling a 2x2x2 cell should collapse it into its parent
+        for (int i = 0; i < 8; i++)
+        {
+            octree.addBlock(8 + (i & 1), 8 + ((i >> 1) & 1), 8 + ((i >> 2) & 1), { 1 });
+        }
+        std::size_t filledNodeCount = octree.getNodeCount();
+        if (filledNodeCount != 5)
+        {
+            result = false;
+        }
+
+        // Terrain-like world: solid below a bumpy surface, air above
+        ChunkMap map;
+        for (int x = 0; x < 64; x++)
+        {
+            for (int z = 0; z < 64; z++)
+            {
+                int surface = 20 + ((x / 8 + z / 8) % 4);
+                for (int y = 0; y <= surface; y++)
+                {
+                    map.addBlock(x, y, z, { y == surface ? 1u : 0u });
+                }
+            }
+        }
+
+        SparseVoxelOctree terrain(0, 0, 0, 6, true);
+        terrain.build(map);
+        for (int x = 0; x < 64; x++)
+        {
+            for (int y = 0; y < 64; y++)
+            {
+                for (int z = 0; z < 64; z++)
+                {
+                    const Block* expected = map.getBlock(x, y, z);
+                    const Block* actual = terrain.getBlock(x, y, z);
+                    if ((expected == nullptr) != (actual == nullptr) || (expected && expected->textureId != actual->textureId))
+                    {
+                        result = false;
+                    }
+                }
+            }
+        }
+
+        // Compare with one pointer per cell plus a heap block per solid cell
+        std::size_t pointerGridSize = 64 * 64 * 64 * sizeof(std::unique_ptr<Block>) + 64 * 64 * 22 * sizeof(Block);
+        if (terrain.getMemoryUsage() * 10 > pointerGridSize)
+        {
+            result = false;
+        }
+
+        // Sharing identical subtrees should never need more nodes than a plain octree
+        SparseVoxelOctree plainTerrain(0, 0, 0, 6, false);
+        plainTerrain.build(map);
+        if (terrain.getNodeCount() > plainTerrain.getNodeCount())
+        {
+            result = false;
+        }
+
+        printf("Sparse voxel octree test: %s\n", successString(result));
+        return result;
+    }
+
+    bool sparseVoxelOctreeRaycast()
+    {
+        bool result = true;
+
+        SparseVoxelOctree octree(-32, -32, -32, 6, false);
+        octree.addBlock(10, 0, 0, { 1 });
+        octree.addBlock(20, 0, 0, { 1 });
+
+        const float origin[3] = { 0.5f, 0.5f, 0.5f };
+        const float direction[3] = { 1.f, 0.f, 0.f };
+        int block[3];
+        float distance;
+
+        // The nearest block should be found first
+        if (!octree.raycast(origin, direction, 100.f, block, &distance) || block[0] != 10 || block[1] != 0 || block[2] != 0)
+        {
+            result = false;
+        }
+        if (distance < 9.4f || distance > 9.6f)
+        {
+            result = false;
+        }
+
+        // Out of reach
+        if (octree.raycast(origin, direction, 5.f, block, &distance))
+        {
+            result = false;
+        }
+
+        // Pointing away from everything
+        const float backwards[3] = { -1.f, 0.f, 0.f };
+        if (octree.raycast(origin, backwards, 100.f, block, &distance))
+        {
+            result = false;
+        }
+
+        printf("Sparse voxel octree raycast test: %s\n", successString(result));
+        return result;
+    }
+
+    bool lzCompression()
+    {
+        bool result = true;
+
+        // Repetitive data with a few changes, plus some that won't compress at all
+        std::vector<uint8_t> input(10000);
+        for (std::size_t i = 0; i < input.size(); i++)
+        {
+            input[i] = (i < 6000) ? (uint8_t)((i % 7 == 0) ? i / 100 : 3) : (uint8_t)((i * 2654435761u) >> 24);
+        }
+
+        std::vector<uint8_t> compressed = Compression::lzCompress(input.data(), input.size());
+        std::vector<uint8_t> output;
+        if (!Compression::lzDecompress(compressed.data(), compressed.size(), input.size(), output) || output != input)
+        {
+            result = false;
+        }
+        if (compressed.size() >= input.size())
+        {
+            result = false;
+        }
+
+        // Corrupt input should be rejected rather than overrun
+        compressed.resize(compressed.size() / 2);
+        if (Compression::lzDecompress(compressed.data(), compressed.size(), input.size(), output))
+        {
+            result = false;
+        }
+
+        // Empty input
+        compressed = Compression::lzCompress(nullptr, 0);
+        if (!Compression::lzDecompress(compressed.data(), compressed.size(), 0, output) || !output.empty())
+        {
+            result = false;
+        }
+
+        printf("LZ compression test: %s\n", successString(result));
+        return result;
+    }
+
+    bool chunkCompression()
+    {
+        bool result = true;
+
+        // A ground layer with a scattering of other blocks
+        Chunk chunk(ChunkMap::chunkSize, ChunkMap::chunkSize, ChunkMap::chunkSize);
+        for (int x = 0; x < ChunkMap::chunkSize; x++)
+        {
+            for (int z = 0; z < ChunkMap::chunkSize; z++)
+            {
+                for (int y = 0; y < 10 + (x ^ z) % 5; y++)
+                {
+                    chunk.addBlock(x, y, z, { (UINT)((x * z) % 3) });
+                }
+            }
+        }
+
+        Chunk original = chunk;
+
+        chunk.compress();
+        if (!chunk.isCompressed() || chunk.getCompressedSize() * 4 > chunk.getUncompressedSize())
+        {
+            result = false;
+        }
+
+        // Reading a block should bring everything back
+        for (int i = 0; i < ChunkMap::chunkSize * ChunkMap::chunkSize * ChunkMap::chunkSize; i++)
+        {
+            const Block* expected = original.getBlock(i);
+            const Block* actual = chunk.getBlock(i);
+            if ((expected == nullptr) != (actual == nullptr) || (expected && expected->textureId != actual->textureId))
+            {
+                result = false;
+            }
+        }
+        if (chunk.isCompressed())
+        {
+            result = false;
+        }
+
+        // With room for one chunk's blocks and a compressed one, the one touched least recently should be compressed
+        ChunkMap map;
+        map.addBlock(0, 0, 0, { 1 });
+        map.addBlock(ChunkMap::chunkSize, 0, 0, { 1 });
+        map.getBlock(0, 0, 0);
+        map.setMemoryBudget(map.getChunk({ 0, 0, 0 })->getUncompressedSize() * 3 / 2);
+        map.enforceMemoryBudget();
+
+        CompressionStatistics statistics = map.getCompressionStatistics();
+        if (statistics.compressedChunkCount != 1 || map.getChunks().at({ 0, 0, 0 })->isCompressed())
+        {
+            result = false;
+        }
+
+        // Reading from the compressed chunk inflates it transparently
+        if (!map.getBlock(ChunkMap::chunkSize, 0, 0) || map.getCompressionStatistics().decompressionCount != 1)
+        {
+            result = false;
+        }
+
+        printf("Chunk compression test: %s\n", successString(result));
+        return result;
+    }
+
+    bool chunkExposure()
+    {
+        bool result = true;
+
+        // Compare every block's faces against its neighbours, with missing blocks counting as air
+        auto check = [&result](const ChunkMap& map, int minimum, int maximum)
+        {
+            for (int z = minimum; z < maximum; z++)
+            {
+                for (int y = minimum; y < maximum; y++)
+                {
+                    for (int x = minimum; x < maximum; x++)
+                    {
+                        UINT expected = 0;
+                        if (map.isSolid(x, y, z))
+                        {
+                            expected |= (UINT)!map.isSolid(x - 1, y, z) << 0;
+                            expected |= (UINT)!map.isSolid(x + 1, y, z) << 1;
+                            expected |= (UINT)!map.isSolid(x, y - 1, z) << 2;
+                            expected |= (UINT)!map.isSolid(x, y + 1, z) << 3;
+                            expected |= (UINT)!map.isSolid(x, y, z - 1) << 4;
+                            expected |= (UINT)!map.isSolid(x, y, z + 1) << 5;
+                        }
+
+                        if (map.getExposedFaces(x, y, z) != expected)
+                        {
+                            result = false;
+                        }
+                    }
+                }
+            }
+        };
+
+        // Random edits in a region straddling the corner where eight chunks meet
+        ChunkMap map;
+        std::default_random_engine engine(7);
+        std::uniform_int_distribution<int> coordinate(-4, 3);
+        for (int i = 0; i < 2000; i++)
+        {
+            const int x = coordinate(engine), y = coordinate(engine), z = coordinate(engine);
+            if (engine() % 3 == 0)
+            {
+                map.removeBlock(x, y, z);
+            }
+            else
+            {
+                map.addBlock(x, y, z, { (UINT)(engine() % 2) });
+            }
+        }
+        check(map, -5, 5);
+
+        // Whole chunks dropped in beside existing blocks, and taken away again
+        std::unique_ptr<Chunk> chunk = std::make_unique<Chunk>(ChunkMap::chunkSize, ChunkMap::chunkSize, ChunkMap::chunkSize);
+        for (int i = 0; i < ChunkMap::chunkSize * ChunkMap::chunkSize * ChunkMap::chunkSize; i += 3)
+        {
+            chunk->addBlock(i, { 0 });
+        }
+        map.setChunk({ 1, 0, 0 }, std::move(chunk));
+        map.addBlock(ChunkMap::chunkSize - 1, 0, 0, { 0 });
+        check(map, -5, ChunkMap::chunkSize + 5);
+
+        map.setChunk({ 0, 0, 0 }, nullptr);
+        check(map, -5, ChunkMap::chunkSize + 5);
+
+        // Digging into a buried block exposes the blocks around the hole
+        ChunkMap solid;
+        for (int z = 0; z < 3; z++)
+        {
+            for (int y = 0; y < 3; y++)
+            {
+                for (int x = 0; x < 3; x++)
+                {
+                    solid.addBlock(x - 1, y - 1, z - 1, { 0 });
+                }
+            }
+        }
+        if (solid.getExposedFaces(0, 0, 0) != 0 || solid.getExposedFaces(1, 0, 0) != (1u << 1))
+        {
+            result = false;
+        }
+        solid.removeBlock(1, 0, 0);
+        if (solid.getExposedFaces(0, 0, 0) != (1u << 1) || !solid.getBlock(0, 0, 0))
+        {
+            result = false;
+        }
+
+        printf("Chunk exposure test: %s\n", successString(result));
+        return result;
+    }
+
+    bool occupancyShift()
+    {
+        bool result = true;
+
+        std::default_random_engine engine(1234);
+        std::vector<uint64_t> input(37);
+        for (uint64_t& word : input)
+        {
+            word = ((uint64_t)engine() << 32) ^ engine();
+        }
+
+        // Compare against shifting one bit at a time, for shifts within and across words in both directions
+        const std::ptrdiff_t shifts[] = { 0, 1, -1, 31, -32, 64, -64, 100, -129, 2000 };
+        std::vector<uint64_t> output(input.size());
+        for (std::ptrdiff_t shift : shifts)
+        {
+            Occupancy::shiftBits(output.data(), input.data(), input.size(), shift);
+
+            for (std::ptrdiff_t bit = 0; bit < (std::ptrdiff_t)input.size() * 64; bit++)
+            {
+                std::ptrdiff_t source = bit + shift;
+                bool expected = source >= 0 && source < (std::ptrdiff_t)input.size() * 64 && Occupancy::testBit(input, (int)source);
+                if (Occupancy::testBit(output, (int)bit) != expected)
+                {
+                    result = false;
+                }
+            }
+        }
+
+        printf("Occupancy shift test: %s\n", successString(result));
+        return result;
+    }
+
+    bool occupancyInterior()
+    {
+        bool result = true;
+
+        // Two mostly-solid chunks side by side, with random holes
+        ChunkMap map;
+        std::default_random_engine engine(42);
+        std::uniform_int_distribution<int> distribution(0, 9);
+        for (int x = 0; x < ChunkMap::chunkSize * 2; x++)
+        {
+            for (int y = 0; y < ChunkMap::chunkSize; y++)
+            {
+                for (int z = 0; z < ChunkMap::chunkSize; z++)
+                {
+                    if (distribution(engine) != 0)
+                    {
+                        map.addBlock(x, y, z, { 0 });
+                    }
+                }
+            }
+        }
+
+        std::vector<uint64_t> interior, uncovered;
+        for (int chunkX = 0; chunkX < 2; chunkX++)
+        {
+            map.findInteriorBlocks({ chunkX, 0, 0 }, interior, uncovered);
+
+            for (int z = 0; z < ChunkMap::chunkSize; z++)
+            {
+                for (int y = 0; y < ChunkMap::chunkSize; y++)
+                {
+                    for (int localX = 0; localX < ChunkMap::chunkSize; localX++)
+                    {
+                        int x = chunkX * ChunkMap::chunkSize + localX;
+                        int index = localX + ChunkMap::chunkSize * (y + ChunkMap::chunkSize * z);
+
+                        bool solid = map.getBlock(x, y, z) != nullptr;
+                        bool expectedInterior = solid &&
+                            map.getBlock(x - 1, y, z) && map.getBlock(x + 1, y, z) &&
+                            map.getBlock(x, y - 1, z) && map.getBlock(x, y + 1, z) &&
+                            map.getBlock(x, y, z - 1) && map.getBlock(x, y, z + 1);
+                        bool expectedUncovered = solid && !map.getBlock(x, y + 1, z);
+
+                        if (Occupancy::testBit(interior, index) != expectedInterior ||
+                            Occupancy::testBit(uncovered, index) != expectedUncovered ||
+                            map.isSolid(x, y, z) != solid)
+                        {
+                            result = false;
+                        }
+                    }
+                }
+            }
+        }
+
+        printf("Occupancy interior test: %s\n", successString(result));
+        return result;
+    }
+
+    template <typename Grid>
+    static bool checkVoxelGridLayout()
+    {
+        bool result = true;
+
+        // Every coordinate gets its own index inside the storage
+        std::vector<bool> seen(Grid::getSize(), false);
+        for (int z = 0; z < Grid::getDepth(); z++)
+        {
+            for (int y = 0; y < Grid::getHeight(); y++)
+            {
+                for (int x = 0; x < Grid::getWidth(); x++)
+                {
+                    const std::size_t index = Grid::getIndex(x, y, z);
+                    if (index >= Grid::getSize() || seen[index])
+                    {
+                        result = false;
+                        continue;
+                    }
+                    seen[index] = true;
+
+                    // Stepping must land on the same index as recomputing
+                    if (x + 1 < Grid::getWidth() && Grid::template increment<0>(index) != Grid::getIndex(x + 1, y, z))
+                    {
+                        result = false;
+                    }
+                    if (y + 1 < Grid::getHeight() && Grid::template increment<1>(index) != Grid::getIndex(x, y + 1, z))
+                    {
+                        result = false;
+                    }
+                    if (z + 1 < Grid::getDepth() && Grid::template increment<2>(index) != Grid::getIndex(x, y, z + 1))
+                    {
+                        result = false;
+                    }
+                    if (x > 0 && Grid::template decrement<0>(index) != Grid::getIndex(x - 1, y, z))
+                    {
+                        result = false;
+                    }
+                    if (y > 0 && Grid::template decrement<1>(index) != Grid::getIndex(x, y - 1, z))
+                    {
+                        result = false;
+                    }
+                    if (z > 0 && Grid::template decrement<2>(index) != Grid::getIndex(x, y, z - 1))
+                    {
+                        result = false;
+                    }
+                }
+            }
+        }
+
+        // Box scans visit exactly the blocks inside the box
+        Grid grid;
+        for (int z = 0; z < Grid::getDepth(); z++)
+        {
+            for (int y = 0; y < Grid::getHeight(); y++)
+            {
+                for (int x = 0; x < Grid::getWidth(); x++)
+                {
+                    grid.at(x, y, z) = x + 100 * y + 10000 * z;
+                }
+            }
+        }
+
+        int visited = 0;
+        grid.forEachInBox(1, 2, 1, 3, 4, 3, [&](int x, int y, int z, int value)
+        {
+            if (value != x + 100 * y + 10000 * z)
+            {
+                result = false;
+            }
+            visited++;
+        });
+        if (visited != 3 * 3 * 3)
+        {
+            result = false;
+        }
+
+        return result;
+    }
+
+    bool voxelGrid()
+    {
+        bool result = true;
+
+        static_assert(VoxelGrid<int, 8, 8, 8, MortonLayout>::getIndex(1, 1, 1) == 7, "Morton index is computed at compile time");
+        static_assert(VoxelGrid<int, 16, 8, 4>::getIndex(1, 2, 3) == 1 + 16 * (2 + 8 * 3), "Linear index is computed at compile time");
+
+        if (!checkVoxelGridLayout<VoxelGrid<int, 16, 8, 4, LinearLayout>>())
+        {
+            result = false;
+        }
+        if (!checkVoxelGridLayout<VoxelGrid<int, 16, 16, 16, MortonLayout>>())
+        {
+            result = false;
+        }
+        // Uneven sizes leave gaps in a Morton grid but must still be consistent
+        if (!checkVoxelGridLayout<VoxelGrid<int, 12, 8, 5, MortonLayout>>())
+        {
+            result = false;
+        }
+
+        printf("Voxel grid test: %s\n", successString(result));
+        return result;
+    }
+
+    bool worldSnapshot()
+    {
+        bool result = true;
+
+        ChunkMap map;
+        map.addBlock(0, 0, 0, { 1 });
+        map.addBlock(ChunkMap::chunkSize, 0, 0, { 1 });
+        if (map.getSnapshot())
+        {
+            result = false;
+        }
+
+        map.publish();
+        std::shared_ptr<const WorldSnapshot> first = map.getSnapshot();
+
+        // Edits after publishing mustn't show up in the snapshot
+        map.addBlock(1, 0, 0, { 2 });
+        map.removeBlock(0, 0, 0);
+        if (!first->getBlock(0, 0, 0) || first->getBlock(1, 0, 0) || first->isSolid(1, 0, 0) || !map.getBlock(1, 0, 0))
+        {
+            result = false;
+        }
+
+        map.publish();
+        std::shared_ptr<const WorldSnapshot> second = map.getSnapshot();
+        if (second->getVersion() != first->getVersion() + 1 || second->getBlock(0, 0, 0) || !second->getBlock(1, 0, 0))
+        {
+            result = false;
+        }
+
+        // Untouched chunks are shared rather than copied, edited ones aren't
+        if (first->getChunk({ 1, 0, 0 }) != second->getChunk({ 1, 0, 0 }) || first->getChunk({ 0, 0, 0 }) == second->getChunk({ 0, 0, 0 }))
+        {
+            result = false;
+        }
+
+        // Compressing for the memory budget leaves the snapshot's copy alone
+        map.setMemoryBudget(0);
+        map.enforceMemoryBudget();
+        if (second->getChunk({ 1, 0, 0 })->isCompressed() || !map.getChunks().at({ 1, 0, 0 })->isCompressed())
+        {
+            result = false;
+        }
+
+        // Nothing is built for a version nobody asks about, so edits after it don't copy chunks
+        ChunkMap unread;
+        unread.addBlock(0, 0, 0, { 1 });
+        const Chunk* unreadChunk = unread.getChunk({ 0, 0, 0 });
+        unread.publish();
+        unread.addBlock(1, 0, 0, { 1 });
+        if (unread.getChunk({ 0, 0, 0 }) != unreadChunk)
+        {
+            result = false;
+        }
+
+        // A reader on another thread always sees a whole number of edits
+        // Each version adds one more block along a row, so the row length must match the version
+        std::atomic<bool> writing(true);
+        std::atomic<bool> consistent(true);
+        ChunkMap rowMap;
+        rowMap.publish();
+        const uint64_t firstVersion = rowMap.getVersion();
+        // Handed over through std::atomic_load and std::atomic_store
+        std::shared_ptr<const WorldSnapshot> latest = rowMap.getSnapshot();
+
+        std::thread reader([&]()
+        {
+            while (writing)
+            {
+                std::shared_ptr<const WorldSnapshot> snapshot = std::atomic_load(&latest);
+                int length = 0;
+                while (snapshot->isSolid(length, 0, 0) && snapshot->getBlock(length, 0, 0))
+                {
+                    length++;
+                }
+                if ((uint64_t)length != snapshot->getVersion() - firstVersion)
+                {
+                    consistent = false;
+                }
+            }
+        });
+
+        for (int x = 0; x < 200; x++)
+        {
+            rowMap.addBlock(x, 0, 0, { 0 });
+            rowMap.publish();
+            std::atomic_store(&latest, rowMap.getSnapshot());
+        }
+        writing = false;
+        reader.join();
+
+        if (!consistent)
+        {
+            result = false;
+        }
+
+        printf("World snapshot test: %s\n", successString(result));
+        return result;
+    }
+
+    // Check a chunk mesh covers every visible face exactly once, with the right texture and winding
+    static bool checkChunkMesh(const Chunk& chunk, const ChunkMesh& mesh)
+    {
+        bool result = true;
+
+        const int size = ChunkMap::chunkSize;
+        std::vector<int> covered((std::size_t)size * size * size * Chunk::faceCount, 0);
+
+        if (mesh.vertices.size() % 4 != 0 || mesh.indices.size() != mesh.vertices.size() / 4 * 6)
+        {
+            return false;
+        }
+
+        for (std::size_t quad = 0; quad < mesh.vertices.size() / 4; quad++)
+        {
+            const ChunkVertex* corners = &mesh.vertices[quad * 4];
+            const int face = (int)(corners[0].faceAndTexture & 7);
+            const UINT textureId = corners[0].faceAndTexture >> 3;
+            const int axis = face / 2;
+            const bool positive = (face & 1) != 0;
+
+            float minimum[3] = { corners[0].x, corners[0].y, corners[0].z };
+            float maximum[3] = { corners[0].x, corners[0].y, corners[0].z };
+            for (int i = 1; i < 4; i++)
+            {
+                const float position[3] = { corners[i].x, corners[i].y, corners[i].z };
+                for (int j = 0; j < 3; j++)
+                {
+                    minimum[j] = Utility::min(minimum[j], position[j]);
+                    maximum[j] = Utility::max(maximum[j], position[j]);
+                }
+            }
+
+            // Both triangles face outwards, which is clockwise from outside in a left-handed world
+            for (int triangle = 0; triangle < 2; triangle++)
+            {
+                const ChunkVertex& a = mesh.vertices[mesh.indices[quad * 6 + triangle * 3]];
+                const ChunkVertex& b = mesh.vertices[mesh.indices[quad * 6 + triangle * 3 + 1]];
+                const ChunkVertex& c = mesh.vertices[mesh.indices[quad * 6 + triangle * 3 + 2]];
+                const float ab[3] = { b.x - a.x, b.y - a.y, b.z - a.z };
+                const float ac[3] = { c.x - a.x, c.y - a.y, c.z - a.z };
+                const float normal[3] = { ab[1] * ac[2] - ab[2] * ac[1], ab[2] * ac[0] - ab[0] * ac[2], ab[0] * ac[1] - ab[1] * ac[0] };
+                if ((normal[axis] > 0.f) != positive || normal[(axis + 1) % 3] != 0.f || normal[(axis + 2) % 3] != 0.f)
+                {
+                    result = false;
+                }
+            }
+
+            const int slice = (int)minimum[axis] - (positive ? 1 : 0);
+            int coordinates[3];
+            coordinates[axis] = slice;
+            for (int v = (int)minimum[(axis + 2) % 3]; v < (int)maximum[(axis + 2) % 3]; v++)
+            {
+                coordinates[(axis + 2) % 3] = v;
+                for (int u = (int)minimum[(axis + 1) % 3]; u < (int)maximum[(axis + 1) % 3]; u++)
+                {
+                    coordinates[(axis + 1) % 3] = u;
+                    const int index = chunk.getBlockIndex(coordinates[0], coordinates[1], coordinates[2]);
+                    const Block* block = chunk.getBlock(index);
+                    if (!block || block->textureId != textureId || !(chunk.getExposedFaces(index) & (1u << face)))
+                    {
+                        result = false;
+                        continue;
+                    }
+                    covered[(std::size_t)index * Chunk::faceCount + face]++;
+                }
+            }
+        }
+
+        for (int index = 0; index < size * size * size; index++)
+        {
+            for (int face = 0; face < Chunk::faceCount; face++)
+            {
+                const int expected = (chunk.getExposedFaces(index) >> face) & 1;
+                if (covered[(std::size_t)index * Chunk::faceCount + face] != expected)
+                {
+                    result = false;
+                }
+            }
+        }
+
+        return result;
+    }
+
+    bool chunkMesher()
+    {
+        bool result = true;
+
+        ChunkMesher mesher;
+        ChunkMesh greedy, faces;
+        const int size = ChunkMap::chunkSize;
+
+        // A solid cube on its own needs one quad per side
+        ChunkMap solid;
+        for (int z = 0; z < size; z++)
+        {
+            for (int y = 0; y < size; y++)
+            {
+                for (int x = 0; x < size; x++)
+                {
+                    solid.addBlock(x, y, z, { 0 });
+                }
+            }
+        }
+        mesher.buildGreedyMesh(*solid.getChunks().at({ 0, 0, 0 }), greedy);
+        if (greedy.vertices.size() != 6 * 4 || !checkChunkMesh(*solid.getChunks().at({ 0, 0, 0 }), greedy))
+        {
+            result = false;
+        }
+
+        // Rolling terrain with grass on top, some caves, and a neighbouring chunk hiding part of one side
+        ChunkMap map;
+        std::default_random_engine engine(5);
+        for (int z = 0; z < size; z++)
+        {
+            for (int x = 0; x < size; x++)
+            {
+                const int height = 12 + (int)(6.f * sinf(x * 0.3f) + 4.f * cosf(z * 0.2f));
+                for (int y = 0; y < height; y++)
+                {
+                    if (engine() % 20 == 0) continue;
+                    map.addBlock(x, y, z, { (UINT)(y == height - 1 ? 1 : 0) });
+                }
+            }
+        }
+        for (int z = 0; z < size; z++)
+        {
+            for (int y = 0; y < 8; y++)
+            {
+                map.addBlock(size, y, z, { 0 });
+            }
+        }
+
+        const Chunk& chunk = *map.getChunks().at({ 0, 0, 0 });
+        mesher.buildGreedyMesh(chunk, greedy);
+        mesher.buildFaceMesh(chunk, faces);
+        if (!checkChunkMesh(chunk, greedy) || !checkChunkMesh(chunk, faces))
+        {
+            result = false;
+        }
+        if (greedy.vertices.size() >= faces.vertices.size())
+        {
+            result = false;
+        }
+
+        printf("Chunk mesher test: %s\n", successString(result));
+        return result;
+    }
+
+    bool faceInstances()
+    {
+        bool result = true;
+
+        // Two chunks of hills side by side, so faces along the shared border have to stay hidden
+        ChunkMap map;
+        const int size = ChunkMap::chunkSize;
+        for (int z = 0; z < size; z++)
+        {
+            for (int x = 0; x < size * 2; x++)
+            {
+                const int height = 8 + (int)(4.f * sinf(x * 0.4f) + 3.f * cosf(z * 0.3f));
+                for (int y = 0; y < height; y++)
+                {
+                    map.addBlock(x, y, z, { (UINT)(y == height - 1 ? 1 : 0) });
+                }
+            }
+        }
+
+        struct WorldFace
+        {
+            int x, y, z;
+            UINT face, textureId;
+        };
+        std::vector<WorldFace> instances;
+        std::size_t expectedCount = 0;
+        for (const auto& entry : map.getChunks())
+        {
+            const ChunkCoordinate& coordinate = entry.first;
+            std::vector<BlockInstance> chunkInstances;
+            ChunkMesher::buildFaceInstances(*entry.second, chunkInstances);
+
+            // Bring the instances back to world coordinates so they can be checked against the map
+            for (const BlockInstance& instance : chunkInstances)
+            {
+                instances.push_back({ (int)instance.getX() + coordinate.x * size, (int)instance.getY() + coordinate.y * size,
+                    (int)instance.getZ() + coordinate.z * size, instance.getFace(), instance.getTextureId() });
+            }
+
+            for (int face = 0; face < Chunk::faceCount; face++)
+            {
+                Occupancy::forEachBit(entry.second->getExposure(face), [&](int) { expectedCount++; });
+            }
+        }
+
+        // One instance for every exposed face and nothing else
+        if (instances.size() != expectedCount)
+        {
+            result = false;
+        }
+
+        std::set<std::tuple<int, int, int, UINT>> seen;
+        for (const WorldFace& instance : instances)
+        {
+            const int x = instance.x;
+            const int y = instance.y;
+            const int z = instance.z;
+            const Block* block = map.getBlock(x, y, z);
+
+            if (instance.face >= (UINT)Chunk::faceCount || !(map.getExposedFaces(x, y, z) & (1u << instance.face)))
+            {
+                result = false;
+            }
+            else if (!block || block->textureId != instance.textureId)
+            {
+                result = false;
+            }
+            else if (!seen.insert(std::make_tuple(x, y, z, instance.face)).second)
+            {
+                result = false;
+            }
+        }
+
+        // The border column is covered on both sides
+        for (const WorldFace& instance : instances)
+        {
+            if (instance.x == size - 1 && instance.face == 1 && map.isSolid(size, instance.y, instance.z))
+            {
+                result = false;
+            }
+        }
+
+        printf("Face instances test: %s\n", successString(result));
+        return result;
+    }
+
+    bool blockInstancePacking()
+    {
+        bool result = true;
+
+        // Every position in a chunk and every face survives the round trip
+        for (UINT z = 0; z < (UINT)ChunkMap::chunkSize; z++)
+        {
+            for (UINT y = 0; y < (UINT)ChunkMap::chunkSize; y++)
+            {
+                for (UINT x = 0; x < (UINT)ChunkMap::chunkSize; x++)
+                {
+                    for (UINT face = 0; face <= BlockInstance::emptyFace; face++)
+                    {
+                        const UINT textureId = (x * 7 + y * 13 + z * 31 + face) % (BlockInstance::maxTextureId + 1);
+                        const BlockInstance instance = BlockInstance::encode(x, y, z, face, textureId);
+
+                        if (instance.getX() != x || instance.getY() != y || instance.getZ() != z ||
+                            instance.getFace() != face || instance.getTextureId() != textureId)
+                        {
+                            result = false;
+                        }
+                    }
+                }
+            }
+        }
+
+        // The largest texture id doesn't spill into the other fields
+        const BlockInstance highest = BlockInstance::encode(31, 0, 31, 5, BlockInstance::maxTextureId);
+        if (highest.getX() != 31 || highest.getY() != 0 || highest.getZ() != 31 || highest.getFace() != 5 || highest.getTextureId() != BlockInstance::maxTextureId)
+        {
+            result = false;
+        }
+
+        // The layout is shared with the shader, so pin it down
+        if (sizeof(BlockInstance) != 4 || BlockInstance::encode(1, 2, 3, 4, 5).packed != (1u | (2u << 5) | (3u << 10) | (4u << 15) | (5u << 18)))
+        {
+            result = false;
+        }
+
+        printf("Block instance packing test: %s\n", successString(result));
+        return result;
+    }
+
+    static float squaredDistance(const DirectX::XMFLOAT4& a, const DirectX::XMFLOAT4& b)
+    {
+        return (a.x - b.x) * (a.x - b.x) + (a.y - b.y) * (a.y - b.y) + (a.z - b.z) * (a.z - b.z);
+    }
+
+    bool vertexPacking()
+    {
+        bool result = true;
+
+        if (sizeof(PackedVertex) > 24)
+        {
+            result = false;
+        }
+
+        // Every half that isn't NaN survives a round trip through a float exactly
+        for (UINT bits = 0; bits <= 0xFFFF; bits++)
+        {
+            if ((bits & 0x7C00) == 0x7C00 && (bits & 0x3FF)) continue;
+
+            if (VertexPacking::floatToHalf(VertexPacking::halfToFloat((uint16_t)bits)) != bits)
+            {
+                result = false;
+            }
+        }
+
+        std::default_random_engine engine(13);
+        std::uniform_real_distribution<float> valueDistribution(-100.f, 100.f);
+        std::normal_distribution<float> directionDistribution;
+
+        // Halves keep 11 significant bits, so rounding is out by at most half a unit in the last place
+        for (int i = 0; i < 10000; i++)
+        {
+            const float value = valueDistribution(engine);
+            const float error = fabsf(VertexPacking::halfToFloat(VertexPacking::floatToHalf(value)) - value);
+            if (error > fabsf(value) * (1.f / 2048.f))
+            {
+                result = false;
+            }
+        }
+
+        for (int i = -32767; i <= 32767; i += 7)
+        {
+            const float value = i / 32767.f;
+            if (fabsf(VertexPacking::snorm16ToFloat(VertexPacking::floatToSnorm16(value)) - value) > 0.5f / 32767.f)
+            {
+                result = false;
+            }
+        }
+
+        // Random frames, half of them mirrored, as UV seams produce
+        float worstDirection = 0.f;
+        float worstBinormal = 0.f;
+        for (int i = 0; i < 10000; i++)
+        {
+            float normal[3], tangent[3];
+            for (int axis = 0; axis < 3; axis++)
+            {
+                normal[axis] = directionDistribution(engine);
+                tangent[axis] = directionDistribution(engine);
+            }
+
+            // The axes themselves sit on the edges and corners of the octahedron
+            if (i < 6)
+            {
+                normal[0] = normal[1] = normal[2] = 0.f;
+                normal[i / 2] = (i & 1) ? 1.f : -1.f;
+            }
+
+            // Make an orthonormal frame
+            const float normalLength = sqrtf(normal[0] * normal[0] + normal[1] * normal[1] + normal[2] * normal[2]);
+            const float along = (tangent[0] * normal[0] + tangent[1] * normal[1] + tangent[2] * normal[2]) / normalLength;
+            for (int axis = 0; axis < 3; axis++)
+            {
+                normal[axis] /= normalLength;
+                tangent[axis] -= normal[axis] * along;
+            }
+            const float tangentLength = sqrtf(tangent[0] * tangent[0] + tangent[1] * tangent[1] + tangent[2] * tangent[2]);
+            for (int axis = 0; axis < 3; axis++)
+            {
+                tangent[axis] /= tangentLength;
+            }
+
+            const float sign = (i & 1) ? -1.f : 1.f;
+            Vertex vertex;
+            vertex.position = DirectX::XMFLOAT4(valueDistribution(engine), valueDistribution(engine), valueDistribution(engine), 1.f);
+            vertex.colour = DirectX::XMFLOAT4(1.f, 0.25f, 0.f, 1.f);
+            vertex.textureCoord = DirectX::XMFLOAT2(valueDistribution(engine) * 0.01f, valueDistribution(engine) * 0.01f);
+            vertex.normal = DirectX::XMFLOAT4(normal[0], normal[1], normal[2], 0.f);
+            vertex.tangent = DirectX::XMFLOAT4(tangent[0], tangent[1], tangent[2], 0.f);
+            vertex.binormal = DirectX::XMFLOAT4(
+                sign * (normal[1] * tangent[2] - normal[2] * tangent[1]),
+                sign * (normal[2] * tangent[0] - normal[0] * tangent[2]),
+                sign * (normal[0] * tangent[1] - normal[1] * tangent[0]), 0.f);
+
+            const Vertex unpacked = VertexPacking::unpackVertex(VertexPacking::packVertex(vertex));
+
+            const float* before = &vertex.position.x;
+            const float* after = &unpacked.position.x;
+            for (int axis = 0; axis < 3; axis++)
+            {
+                if (fabsf(after[axis] - before[axis]) > fabsf(before[axis]) * (1.f / 2048.f))
+                {
+                    result = false;
+                }
+            }
+            if (fabsf(unpacked.textureCoord.x - vertex.textureCoord.x) > fabsf(vertex.textureCoord.x) * (1.f / 2048.f) ||
+                fabsf(unpacked.textureCoord.y - vertex.textureCoord.y) > fabsf(vertex.textureCoord.y) * (1.f / 2048.f))
+            {
+                result = false;
+            }
+            if (unpacked.colour.x != 1.f || fabsf(unpacked.colour.y - 0.25f) > 0.5f / 255.f || unpacked.colour.z != 0.f || unpacked.colour.w != 1.f)
+            {
+                result = false;
+            }
+
+            const float normalError = sqrtf(squaredDistance(unpacked.normal, vertex.normal));
+            const float tangentError = sqrtf(squaredDistance(unpacked.tangent, vertex.tangent));
+            const float binormalError = sqrtf(squaredDistance(unpacked.binormal, vertex.binormal));
+            worstDirection = Utility::max(worstDirection, normalError, tangentError);
+            worstBinormal = Utility::max(worstBinormal, binormalError);
+        }
+
+        // Within about 0.005 degrees for the normal and tangent, and the rebuilt binormal keeps its handedness
+        if (worstDirection > 1e-4f || worstBinormal > 2e-4f)
+        {
+            result = false;
+        }
+
+        printf("Vertex packing test: %s\n", successString(result));
+        return result;
+    }
+
+    // Triangles as grid positions, rotated so the lowest comes first without changing the winding
+    static std::vector<std::tuple<int, int, int>> getGridTriangles(const std::vector<Vertex>& vertices, const std::vector<UINT>& indices, int size)
+    {
+        std::vector<std::tuple<int, int, int>> triangles;
+        for (std::size_t i = 0; i + 2 < indices.size(); i += 3)
+        {
+            int corners[3];
+            for (int corner = 0; corner < 3; corner++)
+            {
+                const Vertex& vertex = vertices[indices[i + corner]];
+                corners[corner] = (int)vertex.position.x + (int)vertex.position.y * (size + 1);
+            }
+            std::rotate(corners, std::min_element(corners, corners + 3), corners + 3);
+            triangles.push_back(std::make_tuple(corners[0], corners[1], corners[2]));
+        }
+        std::sort(triangles.begin(), triangles.end());
+        return triangles;
+    }
+
+    bool meshOptimiser()
+    {
+        bool result = true;
+
+        // A grid of quads as a triangle soup, in a random order, the way loadFromFile used to leave a mesh
+        const int size = 16;
+        std::vector<std::vector<Vertex>> quads;
+        for (int y = 0; y < size; y++)
+        {
+            for (int x = 0; x < size; x++)
+            {
+                const int corners[6][2] = { { 0, 0 }, { 0, 1 }, { 1, 1 }, { 0, 0 }, { 1, 1 }, { 1, 0 } };
+                for (int triangle = 0; triangle < 2; triangle++)
+                {
+                    std::vector<Vertex> vertices(3);
+                    for (int corner = 0; corner < 3; corner++)
+                    {
+                        const int* offset = corners[triangle * 3 + corner];
+                        vertices[corner] = Vertex();
+                        vertices[corner].position = DirectX::XMFLOAT4((float)(x + offset[0]), (float)(y + offset[1]), 0.f, 1.f);
+                        vertices[corner].textureCoord = DirectX::XMFLOAT2((float)(x + offset[0]) / size, (float)(y + offset[1]) / size);
+                        vertices[corner].normal = DirectX::XMFLOAT4(0.f, 0.f, -1.f, 0.f);
+                    }
+                    quads.push_back(vertices);
+                }
+            }
+        }
+        std::shuffle(quads.begin(), quads.end(), std::default_random_engine(3));
+
+        std::vector<Vertex> soup;
+        for (const std::vector<Vertex>& triangle : quads)
+        {
+            soup.insert(soup.end(), triangle.begin(), triangle.end());
+        }
+        std::vector<UINT> unindexed(soup.size());
+        for (std::size_t i = 0; i < unindexed.size(); i++)
+        {
+            unindexed[i] = (UINT)i;
+        }
+
+        // Welding leaves one vertex per grid point, and every index still finds the vertex it started with
+        std::vector<Vertex> vertices = soup;
+        std::vector<UINT> indices = MeshOptimiser::weldVertices(vertices);
+        if (vertices.size() != (std::size_t)((size + 1) * (size + 1)) || indices.size() != soup.size())
+        {
+            result = false;
+        }
+        for (std::size_t i = 0; i < indices.size() && result; i++)
+        {
+            if (memcmp(&vertices[indices[i]], &soup[i], sizeof(Vertex)) != 0)
+            {
+                result = false;
+            }
+        }
+
+        const float unindexedACMR = MeshOptimiser::calculateACMR(unindexed, soup.size());
+        const float weldedACMR = MeshOptimiser::calculateACMR(indices, vertices.size());
+        MeshOptimiser::optimiseVertexCache(indices, vertices.size());
+        MeshOptimiser::optimiseVertexFetch(vertices, indices);
+        const float optimisedACMR = MeshOptimiser::calculateACMR(indices, vertices.size());
+
+        // A regular grid can get close to 0.5
+        if (unindexedACMR != 3.f || optimisedACMR >= weldedACMR || optimisedACMR > 0.8f)
+        {
+            result = false;
+        }
+
+        // Still the same triangles facing the same way
+        if (getGridTriangles(vertices, indices, size) != getGridTriangles(soup, unindexed, size))
+        {
+            result = false;
+        }
+
+        // Vertices are stored in the order they're first used
+        UINT nextVertex = 0;
+        for (UINT index : indices)
+        {
+            if (index > nextVertex)
+            {
+                result = false;
+            }
+            else if (index == nextVertex)
+            {
+                nextVertex++;
+            }
+        }
+        if (nextVertex != vertices.size())
+        {
+            result = false;
+        }
+
+        printf("Mesh optimiser test: %s\n", successString(result));
+        return result;
+    }
+
+    bool objParser()
+    {
+        bool result = true;
+        ObjData data;
+
+        // Comments, CRLF line breaks, a quad, missing texture coordinates and indices counted back from the end
+        const char* text =
+            "# A square and a triangle\r\n"
+            "o square\r\n"
+            "v 0 0 0\r\n"
+            "v 1 0 0\r\n"
+            "v 1 1 0\r\n"
+            "v 0 1 +0.5e1\r\n"
+            "vt 0.25 0.75\r\n"
+            "vn 0 0 -1\r\n"
+            "s off\r\n"
+            "f 1/1/1 2/1/1 3/1/1 4/1/1\r\n"
+            "v -2.5 3 4\n"
+            "f -1//1 -2//1 -3//1\n"
+            "f 1 2 3";
+
+        if (!ObjParser::parse(text, data))
+        {
+            result = false;
+        }
+        if (data.positions.size() != 15 || data.textureCoords.size() != 2 || data.normals.size() != 3 || data.corners.size() != 12)
+        {
+            result = false;
+        }
+        else
+        {
+            const int expected[12][3] = {
+                { 0, 0, 0 }, { 1, 0, 0 }, { 2, 0, 0 },
+                { 0, 0, 0 }, { 2, 0, 0 }, { 3, 0, 0 },
+                { 4, -1, 0 }, { 3, -1, 0 }, { 2, -1, 0 },
+                { 0, -1, -1 }, { 1, -1, -1 }, { 2, -1, -1 }
+            };
+            for (int i = 0; i < 12; i++)
+            {
+                const ObjCorner& corner = data.corners[i];
+                if (corner.position != expected[i][0] || corner.textureCoord != expected[i][1] || corner.normal != expected[i][2])
+                {
+                    result = false;
+                }
+            }
+
+            if (data.positions[11] != 5.f || data.positions[12] != -2.5f || data.textureCoords[1] != 0.75f || data.normals[2] != -1.f)
+            {
+                result = false;
+            }
+        }
+
+        // Faces have to refer to vertices that exist
+        if (ObjParser::parse("v 0 0 0\nf 1 2 3\n", data) || ObjParser::parse("v 0 0 0\nvt 0 0\nf 1/2 1/1 1/1\n", data))
+        {
+            result = false;
+        }
+
+        // Splitting a large file between threads gives the same answer, relative indices included
+        std::string large;
+        for (int i = 0; i < 100000; i++)
+        {
+            large += "v " + std::to_string(i) + " " + std::to_string(i % 7) + " 0.5\n";
+            large += "vt 0." + std::to_string(i % 10) + " 1\n";
+            if (i >= 2)
+            {
+                large += (i % 2) ? "f -3/-3 -2/-2 -1/-1\n" : "f " + std::to_string(i - 1) + "/1 " + std::to_string(i) + "/2 " + std::to_string(i + 1) + "/3\n";
+            }
+        }
+
+        ObjData single, threaded;
+        if (!ObjParser::parse(large, single, 1) || !ObjParser::parse(large, threaded, 4))
+        {
+            result = false;
+        }
+        if (single.positions != threaded.positions || single.textureCoords != threaded.textureCoords || single.corners.size() != threaded.corners.size())
+        {
+            result = false;
+        }
+        for (std::size_t i = 0; i < single.corners.size() && result; i++)
+        {
+            if (memcmp(&single.corners[i], &threaded.corners[i], sizeof(ObjCorner)) != 0)
+            {
+                result = false;
+            }
+        }
+        for (std::size_t i = 0; i + 2 < single.corners.size() && result; i += 3)
+        {
+            // Each triangle uses three vertices in a row
+            if (single.corners[i + 1].position != single.corners[i].position + 1 || single.corners[i + 2].position != single.corners[i].position + 2)
+            {
+                result = false;
+            }
+        }
+
+        printf("OBJ parser test: %s\n", successString(result));
+        return result;
+    }
+
+    bool meshCache()
+    {
+        bool result = true;
+
+        // A quad, which welds down to four vertices
+        const char* text =
+            "v 0 0 0\n"
+            "v 2 0 0\n"
+            "v 2 1 0\n"
+            "v 0 1 0\n"
+            "vt 0 0\n"
+            "vt 1 0\n"
+            "vt 1 1\n"
+            "vt 0 1\n"
+            "vn 0 0 -1\n"
+            "f 1/1/1 2/2/1 3/3/1 4/4/1\n";
+        const uint64_t hash = MeshCache::hashContent(text, strlen(text));
+
+        std::vector<uint8_t> baked;
+        if (!MeshCache::bake(text, baked))
+        {
+            result = false;
+        }
+
+        MeshCacheView view;
+        if (!MeshCache::read(baked.data(), baked.size(), hash, view))
+        {
+            result = false;
+        }
+        else
+        {
+            if (view.header->vertexCount != 4 || view.header->indexCount != 6)
+            {
+                result = false;
+            }
+            if (view.header->boundsMinimum[0] != 0.f || view.header->boundsMaximum[0] != 2.f || view.header->boundsMaximum[1] != 1.f || view.header->boundsMaximum[2] != 0.f)
+            {
+                result = false;
+            }
+
+            std::set<std::pair<float, float>> corners;
+            for (uint32_t i = 0; i < view.header->vertexCount; i++)
+            {
+                Vertex vertex = VertexPacking::unpackVertex(view.vertices[i]);
+                corners.insert({ vertex.position.x, vertex.position.y });
+                if (vertex.normal.z > -0.999f || vertex.textureCoord.x != vertex.position.x * 0.5f)
+                {
+                    result = false;
+                }
+            }
+            if (corners.size() != 4)
+            {
+                result = false;
+            }
+            for (uint32_t i = 0; i < view.header->indexCount; i++)
+            {
+                if (view.indices[i] >= view.header->vertexCount)
+                {
+                    result = false;
+                }
+            }
+        }
+
+        // The two halves of a bent quad have different tangents, but still share the corners they have in common in the file
+        // Each shared corner gets its faces' tangents averaged, kept square to the normal
+        ObjData bent;
+        ObjParser::parse(
+            "v 0 0 0\n"
+            "v 1 0 0\n"
+            "v 1 1 0\n"
+            "v 0 1 0\n"
+            "vt 0 0\n"
+            "vt 1 0\n"
+            "vt 2 2\n"
+            "vt 0 1\n"
+            "vn 0 0 -1\n"
+            "f 1/1/1 2/2/1 3/3/1 4/4/1\n", bent, 1);
+        std::vector<Vertex> bentVertices;
+        std::vector<UINT> bentIndices;
+        MeshCache::buildMesh(bent, bentVertices, bentIndices);
+        if (bentVertices.size() != 4 || bentIndices.size() != 6)
+        {
+            result = false;
+        }
+        for (const Vertex& vertex : bentVertices)
+        {
+            const float tangentLength = vertex.tangent.x * vertex.tangent.x + vertex.tangent.y * vertex.tangent.y + vertex.tangent.z * vertex.tangent.z;
+            if (fabsf(tangentLength - 1.f) > 0.001f || fabsf(vertex.tangent.z) > 0.001f || fabsf(vertex.binormal.z) > 0.001f)
+            {
+                result = false;
+            }
+        }
+
+        // Anything stale, cut short or from another version has to be baked again
+        if (MeshCache::read(baked.data(), baked.size(), hash + 1, view) || MeshCache::read(baked.data(), baked.size() - 1, hash, view) ||
+            MeshCache::read(baked.data(), sizeof(MeshCacheHeader) - 1, hash, view) || MeshCache::read(nullptr, 0, hash, view))
+        {
+            result = false;
+        }
+
+        std::vector<uint8_t> otherVersion = baked;
+        ((MeshCacheHeader*)otherVersion.data())->version++;
+        std::vector<uint8_t> otherMagic = baked;
+        otherMagic[0] ^= 0xFF;
+        if (MeshCache::read(otherVersion.data(), otherVersion.size(), hash, view) || MeshCache::read(otherMagic.data(), otherMagic.size(), hash, view))
+        {
+            result = false;
+        }
+
+        if (MeshCache::getCachePath("models/block.obj") != "models/block.mesh" || MeshCache::getCachePath("models.v2/block") != "models.v2/block.mesh")
+        {
+            result = false;
+        }
+
+        // Without a hash anything well formed is read, which is how a cache is used when its source is missing or unchanged
+        // The source's stamp starts out zero and is filled in afterwards
+        if (!MeshCache::read(baked.data(), baked.size(), view) || view.header->sourceSize != 0 || view.header->sourceWriteTime != 0 ||
+            MeshCache::read(otherVersion.data(), otherVersion.size(), view))
+        {
+            result = false;
+        }
+        MeshCache::setSourceStamp(baked, strlen(text), 12345);
+        if (!MeshCache::read(baked.data(), baked.size(), hash, view) || view.header->sourceSize != strlen(text) || view.header->sourceWriteTime != 12345)
+        {
+            result = false;
+        }
+
+        uint64_t sourceSize, sourceWriteTime;
+        if (MeshCache::getSourceStamp("models/missing.obj", &sourceSize, &sourceWriteTime))
+        {
+            result = false;
+        }
+
+        printf("Mesh cache test: %s\n", successString(result));
+        return result;
+    }
+
+    bool assetCache()
+    {
+        bool result = true;
+
+        AssetCache<int> cache;
+        std::atomic<int> loadCount(0);
+        auto load = [&loadCount]()
+        {
+            loadCount++;
+            // Slow enough that the other threads ask while it's still loading
+            std::this_thread::sleep_for(std::chrono::milliseconds(20));
+            return std::make_shared<int>(42);
+        };
+
+        // A thousand lookups from eight threads at once only load it once, and everyone gets the same copy
+        std::vector<std::shared_ptr<const int>> handles(1000);
+        std::vector<std::thread> threads;
+        for (int thread = 0; thread < 8; thread++)
+        {
+            threads.emplace_back([&cache, &handles, &load, thread]()
+            {
+                for (std::size_t i = thread; i < handles.size(); i += 8)
+                {
+                    handles[i] = cache.get("models/character.obj", load);
+                }
+            });
+        }
+        for (std::thread& thread : threads)
+        {
+            thread.join();
+        }
+
+        if (loadCount != 1 || cache.getMissCount() != 1 || cache.getHitCount() != 999 || cache.getLiveCount() != 1)
+        {
+            result = false;
+        }
+        for (const std::shared_ptr<const int>& handle : handles)
+        {
+            if (!handle || handle != handles[0] || *handle != 42)
+            {
+                result = false;
+            }
+        }
+
+        // Other keys load separately
+        if (cache.get("models/skybox.obj", load) == handles[0] || loadCount != 2)
+        {
+            result = false;
+        }
+
+        // Once nothing uses it the asset is freed, and loaded again next time it's wanted
+        std::weak_ptr<const int> weak = handles[0];
+        handles.clear();
+        if (!weak.expired() || cache.getLiveCount() != 0)
+        {
+            result = false;
+        }
+        if (!cache.get("models/character.obj", load) || loadCount != 3 || cache.getMissCount() != 3)
+        {
+            result = false;
+        }
+
+        // Failed loads aren't cached
+        int failedCount = 0;
+        auto fail = [&failedCount]()
+        {
+            failedCount++;
+            return std::shared_ptr<int>();
+        };
+        if (cache.get("missing.obj", fail) || cache.get("missing.obj", fail) || failedCount != 2)
+        {
+            result = false;
+        }
+
+        // Nor are loads that throw, which reach the caller and leave the key free to load again
+        bool thrown = false;
+        try
+        {
+            cache.get("broken.obj", []() -> std::shared_ptr<int>
+            {
+                throw std::runtime_error("Couldn't load");
+            });
+        }
+        catch (const std::runtime_error&)
+        {
+            thrown = true;
+        }
+        std::shared_ptr<const int> retried = cache.get("broken.obj", load);
+        if (!thrown || !retried || *retried != 42)
+        {
+            result = false;
+        }
+
+        printf("Asset cache test: %s\n", successString(result));
+        return result;
+    }
+
+    bool taskGraph()
+    {
+        bool result = true;
+
+        // A diamond of tasks, plus serial ones standing in for work on the immediate context
+        TaskGraph graph;
+        std::atomic<int> clock(0);
+        int finished[6] = {};
+        std::thread::id serialThreads[2];
+        std::atomic<int> serialRunning(0);
+        bool serialOverlapped = false;
+
+        auto serialWork = [&](int task)
+        {
+            if (serialRunning++ != 0) serialOverlapped = true;
+            std::this_thread::sleep_for(std::chrono::milliseconds(5));
+            serialThreads[task - 4] = std::this_thread::get_id();
+            serialRunning--;
+            finished[task] = ++clock;
+        };
+
+        TaskGraph::TaskId first = graph.addTask("First", [&]() { finished[0] = ++clock; });
+        TaskGraph::TaskId left = graph.addTask("Left", [&]() { finished[1] = ++clock; }, { first });
+        TaskGraph::TaskId right = graph.addTask("Right", [&]() { finished[2] = ++clock; }, { first });
+        graph.addTask("Last", [&]() { finished[3] = ++clock; }, { left, right });
+        TaskGraph::TaskId serial = graph.addSerialTask("Serial", [&]() { serialWork(4); });
+        graph.addSerialTask("Serial after left", [&]() { serialWork(5); }, { serial, left });
+
+        for (int run = 0; run < 2; run++)
+        {
+            clock = 0;
+            graph.run(4);
+
+            // Everything ran once, after whatever it depends on
+            for (int task = 0; task < 6; task++)
+            {
+                if (finished[task] == 0 || finished[task] > 6)
+                {
+                    result = false;
+                }
+            }
+            if (clock != 6 || finished[1] < finished[0] || finished[2] < finished[0] || finished[3] < finished[1] || finished[3] < finished[2] ||
+                finished[5] < finished[4] || finished[5] < finished[1])
+            {
+                result = false;
+            }
+
+            // Serial tasks only ever run on the calling thread
+            if (serialOverlapped || serialThreads[0] != std::this_thread::get_id() || serialThreads[1] != std::this_thread::get_id())
+            {
+                result = false;
+            }
+        }
+
+        // With one thread it all runs on the caller
+        TaskGraph single;
+        std::thread::id ranOn;
+        single.addTask("Only", [&]() { ranOn = std::this_thread::get_id(); });
+        single.run(1);
+        if (ranOn != std::this_thread::get_id() || single.getTotalSeconds() < 0.0)
+        {
+            result = false;
+        }
+
+        TaskGraph empty;
+        empty.run(4);
+
+        printf("Task graph test: %s\n", successString(result));
+        return result;
+    }
+
+    bool texturePacker()
+    {
+        bool result = true;
+        std::default_random_engine random(7);
+        std::uniform_int_distribution<int> byte(0, 255);
+
+        // Widths that need the vector loop, its scalar tail, odd sizes and single rows and columns
+        const unsigned int sizes[][2] = { { 16, 8 }, { 22, 6 }, { 9, 5 }, { 1, 4 }, { 12, 1 }, { 1, 1 } };
+        for (const auto& size : sizes)
+        {
+            TextureImage image;
+            image.width = size[0];
+            image.height = size[1];
+            image.pixels.resize(image.width * image.height * 4);
+            for (uint8_t& value : image.pixels)
+            {
+                value = (uint8_t)byte(random);
+            }
+
+            TextureImage fast, reference;
+            TexturePacker::downsample(image, fast, false);
+            TexturePacker::downsampleReference(image, reference, false);
+            if (fast.width != reference.width || fast.height != reference.height || fast.pixels != reference.pixels)
+            {
+                result = false;
+            }
+            if (fast.width != Utility::max(size[0] / 2, 1u) || fast.height != Utility::max(size[1] / 2, 1u))
+            {
+                result = false;
+            }
+        }
+
+        // Rounds to nearest
+        TextureImage square = TexturePacker::makeSolid(2, 2, 0, 0, 0, 0);
+        square.pixels[0] = 1;
+        square.pixels[4] = 1;
+        TextureImage average;
+        TexturePacker::downsample(square, average, false);
+        if (average.pixels.size() != 4 || average.pixels[0] != 1)
+        {
+            result = false;
+        }
+
+        if (TexturePacker::getMipCount(16, 4) != 5 || TexturePacker::getMipCount(1, 1) != 1 || TexturePacker::getMipCount(256, 256) != 9)
+        {
+            result = false;
+        }
+
+        // Two layers, each followed by its whole chain
+        std::vector<TextureImage> layers = { TexturePacker::makeSolid(8, 4, 10, 20, 30, 255), TexturePacker::makeSolid(8, 4, 200, 100, 50, 255) };
+        TextureArray array;
+        if (!TexturePacker::pack(layers, false, array))
+        {
+            result = false;
+        }
+        else
+        {
+            if (array.mipCount != 4 || array.layerCount != 2 || array.offsets.size() != 8 || array.data.size() != 2 * (32 + 8 + 2 + 1) * 4)
+            {
+                result = false;
+            }
+            if (array.getMipWidth(3) != 1 || array.getMipHeight(2) != 1 || array.getMip(1, 0) != array.data.data() + 43 * 4)
+            {
+                result = false;
+            }
+            for (unsigned int layer = 0; layer < 2; layer++)
+            {
+                for (unsigned int mip = 0; mip < array.mipCount; mip++)
+                {
+                    if (memcmp(array.getMip(layer, mip), layers[layer].pixels.data(), 4) != 0)
+                    {
+                        result = false;
+                    }
+                }
+            }
+        }
+
+        layers.push_back(TexturePacker::makeSolid(4, 4, 0, 0, 0, 0));
+        if (TexturePacker::pack(layers, false, array))
+        {
+            result = false;
+        }
+
+        // Normals pointing in different directions still average to unit length
+        // Half lean 45 degrees one way and half the other, which would average to a length of 0.7
+        TextureImage normals = TexturePacker::makeSolid(2, 2, 218, 128, 218, 255);
+        normals.pixels[4] = 37;
+        normals.pixels[12] = 37;
+        TextureImage normalMip;
+        TexturePacker::downsample(normals, normalMip, true);
+        float length = 0.f;
+        for (int channel = 0; channel < 3; channel++)
+        {
+            const float value = normalMip.pixels[channel] / 255.f * 2.f - 1.f;
+            length += value * value;
+        }
+        if (fabsf(sqrtf(length) - 1.f) > 0.02f)
+        {
+            result = false;
+        }
+
+        printf("Texture packer test: %s\n", successString(result));
+        return result;
+    }
+
+    bool textureCompression()
+    {
+        bool result = true;
+        std::default_random_engine random(11);
+        std::uniform_int_distribution<int> noise(-6, 6);
+
+        // Smooth gradients with a little grain, the same kind of thing as a block texture, 18x10 so the edge blocks need padding
+        TextureImage image;
+        image.width = 18;
+        image.height = 10;
+        image.pixels.resize(image.width * image.height * 4);
+        for (unsigned int y = 0; y < image.height; y++)
+        {
+            for (unsigned int x = 0; x < image.width; x++)
+            {
+                uint8_t* pixel = &image.pixels[(y * image.width + x) * 4];
+                pixel[0] = (uint8_t)Utility::clamp(40 + (int)x * 10 + noise(random), 0, 255);
+                pixel[1] = (uint8_t)Utility::clamp(200 - (int)y * 12 + noise(random), 0, 255);
+                pixel[2] = (uint8_t)Utility::clamp(90 + (int)(x + y) * 4 + noise(random), 0, 255);
+                pixel[3] = (uint8_t)(255 - y * 20);
+            }
+        }
+
+        const unsigned int formats[] = { TextureCompression::bc1Format, TextureCompression::bc3Format, TextureCompression::bc5Format };
+        const unsigned int channelCounts[] = { 3, 4, 2 };
+        // Worst acceptable peak signal to noise ratio, in dB, at the lowest and highest quality
+        const double minimumPSNR[][2] = { { 27.5, 30.0 }, { 28.5, 31.0 }, { 42.0, 44.0 } };
+        for (int i = 0; i < 3; i++)
+        {
+            double psnr[2] = { 0.0, 0.0 };
+            for (int level = 0; level < 2; level++)
+            {
+                const std::vector<uint8_t> compressed = TextureCompression::compressImage(image, formats[i], level ? TextureCompression::maxQuality : 0);
+                if (compressed.size() != 5 * 3 * TextureCompression::getBlockSize(formats[i]))
+                {
+                    result = false;
+                    continue;
+                }
+
+                TextureImage decompressed;
+                TextureCompression::decompressImage(compressed.data(), image.width, image.height, formats[i], decompressed);
+                psnr[level] = TextureCompression::calculatePSNR(image, decompressed, channelCounts[i]);
+                if (psnr[level] < minimumPSNR[i][level])
+                {
+                    result = false;
+                }
+            }
+
+            if (psnr[1] < psnr[0])
+            {
+                result = false;
+            }
+        }
+
+        // Colours that fit RGB565 exactly come back exactly, as do single channels with two values
+        TextureImage solid = TexturePacker::makeSolid(4, 4, 255, 130, 8, 255);
+        solid.pixels[3] = 0;
+        TextureImage solidOut;
+        TextureCompression::decompressImage(TextureCompression::compressImage(solid, TextureCompression::bc3Format, 0).data(), 4, 4,
+            TextureCompression::bc3Format, solidOut);
+        if (solidOut.pixels != solid.pixels)
+        {
+            result = false;
+        }
+
+        if (TextureCompression::isOpaque(solid) || !TextureCompression::isOpaque(TexturePacker::makeSolid(2, 2, 0, 0, 0, 255)))
+        {
+            result = false;
+        }
+
+        // A whole mip chain survives a trip through a DDS file
+        TextureArray array;
+        TexturePacker::pack({ image, image }, false, array);
+        CompressedTexture texture, readBack;
+        TextureCompression::compress(array, TextureCompression::bc1Format, 1, texture);
+        const std::vector<uint8_t> dds = TextureCompression::writeDDS(texture);
+        if (!TextureCompression::readDDS(dds.data(), dds.size(), readBack) || readBack.width != 18 || readBack.height != 10 ||
+            readBack.mipCount != 5 || readBack.layerCount != 2 || readBack.format != texture.format || readBack.data != texture.data)
+        {
+            result = false;
+        }
+        if (texture.getRowPitch(0) != 5 * 8 || texture.getMip(1, 0) != texture.data.data() + texture.data.size() / 2)
+        {
+            result = false;
+        }
+        if (TextureCompression::readDDS(dds.data(), dds.size() - 1, readBack))
+        {
+            result = false;
+        }
+
+        printf("Texture compression test: %s\n", successString(result));
+        return result;
+    }
+
+    bool perlinNoise()
+    {
+        bool result = true;
+        const PerlinNoise perlin(1234);
+        std::default_random_engine random(3);
+        std::uniform_real_distribution<float> coordinate(-600.f, 600.f);
+
+        // Bit for bit the same as the scalar path, including either side of zero, lattice points and past the permutation's wrap
+        float x[16], y[16], z[16], batched[16];
+        for (int round = 0; round < 256; round++)
+        {
+            for (int i = 0; i < 16; i++)
+            {
+                x[i] = coordinate(random);
+                y[i] = (round % 4 == 0) ? (float)(i - 8) : coordinate(random);
+                z[i] = (round % 8 == 1) ? -0.f : coordinate(random) / 32.f;
+            }
+
+            float batched8[8];
+            perlin.noise16(x, y, z, batched);
+            perlin.noise8(x + 8, y + 8, z + 8, batched8);
+            for (int i = 0; i < 16; i++)
+            {
+                const float scalar = perlin.noise(x[i], y[i], z[i]);
+                if (memcmp(&scalar, &batched[i], sizeof(float)) != 0 || (i >= 8 && memcmp(&scalar, &batched8[i - 8], sizeof(float)) != 0))
+                {
+                    result = false;
+                }
+            }
+        }
+
+        // A region that isn't a multiple of 16 wide, below and behind the origin
+        const int width = 37, height = 40, depth = 3;
+        std::vector<bool> blockValues;
+        perlin.generateRegion(-20, -5, 7, width, height, depth, blockValues);
+        bool anySolid = false, anyEmpty = false;
+        for (int blockZ = 0; blockZ < depth; blockZ++)
+        {
+            for (int blockY = 0; blockY < height; blockY++)
+            {
+                for (int blockX = 0; blockX < width; blockX++)
+                {
+                    const bool solid = perlin.noise((-20 + blockX) / PerlinNoise::scaleFactor, (-5 + blockY) / PerlinNoise::scaleFactor,
+                        (7 + blockZ) / PerlinNoise::scaleFactor) > 0.5f;
+                    if (blockValues[blockX + width * (blockY + height * blockZ)] != solid)
+                    {
+                        result = false;
+                    }
+                    anySolid |= solid;
+                    anyEmpty |= !solid;
+                }
+            }
+        }
+        if (blockValues.size() != (std::size_t)(width * height * depth) || !anySolid || !anyEmpty)
+        {
+            result = false;
+        }
+
+        // A lattice spacing of 1 is the full resolution noise
+        std::vector<float> exact, approximate;
+        perlin.sampleRegion(-20, -5, 7, width, height, depth, exact);
+        if (perlin.sampleRegionLattice(-20, -5, 7, width, height, depth, 1, approximate) != exact.size() || approximate != exact)
+        {
+            result = false;
+        }
+
+        // Coarser lattices, including one that doesn't divide the chunk size, match exactly on lattice points and stay close in between
+        const int spacings[] = { 3, 4 };
+        for (int spacing : spacings)
+        {
+            const std::size_t samples = perlin.sampleRegionLattice(-20, -5, 7, width, height, depth, spacing, approximate);
+            if (samples == 0 || samples * 4 > exact.size() || approximate.size() != exact.size())
+            {
+                result = false;
+                continue;
+            }
+
+            for (int blockZ = 0; blockZ < depth; blockZ++)
+            {
+                for (int blockY = 0; blockY < height; blockY++)
+                {
+                    for (int blockX = 0; blockX < width; blockX++)
+                    {
+                        const std::size_t index = blockX + width * (blockY + (std::size_t)height * blockZ);
+                        const bool onLattice = (-20 + blockX) % spacing == 0 && (-5 + blockY) % spacing == 0 && (7 + blockZ) % spacing == 0;
+                        if ((onLattice && approximate[index] != exact[index]) || fabsf(approximate[index] - exact[index]) > 0.05f)
+                        {
+                            result = false;
+                        }
+                    }
+                }
+            }
+
+            // A region overlapping the first gets the same values where they meet, so chunks join up without seams
+            std::vector<float> overlapping;
+            perlin.sampleRegionLattice(-9, -5, 7, 10, height, depth, spacing, overlapping);
+            for (int blockZ = 0; blockZ < depth; blockZ++)
+            {
+                for (int blockY = 0; blockY < height; blockY++)
+                {
+                    for (int blockX = 0; blockX < 10; blockX++)
+                    {
+                        if (overlapping[blockX + 10 * (blockY + (std::size_t)height * blockZ)] != approximate[blockX + 11 + width * (blockY + (std::size_t)height * blockZ)])
+                        {
+                            result = false;
+                        }
+                    }
+                }
+            }
+        }
+
+        printf("Perlin noise test: %s\n", successString(result));
+        return result;
+    }
+
+    bool terrainGenerator()
+    {
+        bool result = true;
+        const int chunksWide = 3, chunksHigh = 2, chunksDeep = 2;
+        const int size = ChunkMap::chunkSize;
+
+        // The same world the old way, one chunk after another, with the map fixing up exposure as each is added
+        const PerlinNoise noise(99);
+        ChunkMap reference;
+        for (int chunkZ = 0; chunkZ < chunksDeep; chunkZ++)
+        {
+            for (int chunkY = 0; chunkY < chunksHigh; chunkY++)
+            {
+                for (int chunkX = 0; chunkX < chunksWide; chunkX++)
+                {
+                    std::vector<bool> blockValues;
+                    noise.generateRegion(chunkX * size, chunkY * size, chunkZ * size, size, size, size, blockValues);
+                    std::unique_ptr<Chunk> chunk = std::make_unique<Chunk>(size, size, size);
+                    for (std::size_t i = 0; i < blockValues.size(); i++)
+                    {
+                        if (blockValues[i])
+                        {
+                            chunk->addBlock((int)i, Block{ 0 });
+                        }
+                    }
+                    reference.setChunk({ chunkX, chunkY, chunkZ }, std::move(chunk));
+                }
+            }
+        }
+
+        std::vector<ChunkCoordinate> coordinates;
+        for (const auto& entry : reference.getChunks())
+        {
+            coordinates.push_back(entry.first);
+        }
+        std::size_t grassCount = 0;
+        for (const ChunkCoordinate& coordinate : coordinates)
+        {
+            Chunk* chunk = reference.getChunk(coordinate);
+            Occupancy::forEachBit(chunk->getExposure(Chunk::topFace), [chunk, &grassCount](int index)
+            {
+                chunk->addBlock(index, Block{ 1 });
+                grassCount++;
+            });
+        }
+        const uint64_t referenceHash = TerrainGenerator::hashChunks(reference);
+
+        // Byte for byte the same however many threads it's spread over
+        const unsigned int threadCounts[] = { 1, 2, 5 };
+        for (unsigned int threadCount : threadCounts)
+        {
+            ChunkMap generated;
+            TerrainGenerator generator(99);
+            generator.generate(chunksWide, chunksHigh, chunksDeep, threadCount, generated);
+
+            if (TerrainGenerator::hashChunks(generated) != referenceHash || generated.getChunkCount() != reference.getChunkCount())
+            {
+                result = false;
+            }
+            if (generator.getStatistics().chunkCount != chunksWide * chunksHigh * chunksDeep || generator.getStatistics().blockCount == 0)
+            {
+                result = false;
+            }
+            // Every block needs noise in this mode
+            if (generator.getStatistics().voxelsEvaluated != (std::size_t)chunksWide * chunksHigh * chunksDeep * size * size * size || generator.getStatistics().voxelsFilled != 0)
+            {
+                result = false;
+            }
+        }
+
+        // A different seed makes a different world
+        ChunkMap other;
+        TerrainGenerator otherGenerator(100);
+        otherGenerator.generate(chunksWide, chunksHigh, chunksDeep, 2, other);
+        if (grassCount == 0 || TerrainGenerator::hashChunks(other) == referenceHash)
+        {
+            result = false;
+        }
+
+        // Noise every four blocks, interpolated in between, is still the same whatever the thread count
+        TerrainGenerator::Settings latticeSettings;
+        latticeSettings.latticeSpacing = 4;
+        uint64_t latticeHash = 0;
+        for (unsigned int threadCount = 1; threadCount <= 3; threadCount += 2)
+        {
+            ChunkMap generated;
+            TerrainGenerator generator(99, latticeSettings);
+            generator.generate(chunksWide, chunksHigh, chunksDeep, threadCount, generated);
+            const TerrainGenerator::Statistics& statistics = generator.getStatistics();
+
+            const std::size_t voxelCount = (std::size_t)chunksWide * chunksHigh * chunksDeep * size * size * size;
+            if (statistics.voxelsInterpolated != voxelCount || statistics.voxelsEvaluated != 0 || statistics.latticeSamples * 32 > voxelCount || statistics.blockCount == 0)
+            {
+                result = false;
+            }
+
+            const uint64_t hash = TerrainGenerator::hashChunks(generated);
+            if (threadCount == 1)
+            {
+                latticeHash = hash;
+            }
+            else if (hash != latticeHash)
+            {
+                result = false;
+            }
+        }
+
+        // A tall world from a heightmap, which only needs noise near the surface
+        TerrainGenerator::Settings settings;
+        settings.mode = TerrainGenerator::heightmapMode;
+        settings.surfaceHeight = 64.f;
+        const int tallChunksHigh = 4;
+        const std::size_t tallVoxelCount = (std::size_t)2 * tallChunksHigh * 2 * size * size * size;
+        uint64_t heightmapHash = 0;
+        for (unsigned int threadCount = 1; threadCount <= 3; threadCount += 2)
+        {
+            ChunkMap generated;
+            TerrainGenerator generator(99, settings);
+            generator.generate(2, tallChunksHigh, 2, threadCount, generated);
+            const TerrainGenerator::Statistics& statistics = generator.getStatistics();
+
+            if (statistics.voxelsEvaluated + statistics.voxelsFilled != tallVoxelCount || statistics.voxelsEvaluated == 0 || statistics.voxelsEvaluated > tallVoxelCount / 4)
+            {
+                result = false;
+            }
+
+            // The heightmap is only worked out once for each of the four columns, not once per chunk
+            if (statistics.heightmapSamples != (std::size_t)2 * 2 * size * size * settings.heightOctaves)
+            {
+                result = false;
+            }
+
+            const uint64_t hash = TerrainGenerator::hashChunks(generated);
+            if (threadCount == 1)
+            {
+                heightmapHash = hash;
+            }
+            else if (hash != heightmapHash)
+            {
+                result = false;
+            }
+
+            // Solid below the lowest the surface can go, and air above the highest
+            for (int column = 0; column < size * 2; column += 7)
+            {
+                const int lowest = (int)(settings.surfaceHeight - settings.heightVariation) - settings.surfaceBand - 1;
+                const int highest = (int)(settings.surfaceHeight + settings.heightVariation) + settings.surfaceBand + 1;
+                if (!generated.getChunk({ column / size, lowest / size, 1 })->isSolid(column % size, lowest % size, 5) ||
+                    generated.getChunk({ column / size, highest / size, 1 })->isSolid(column % size, highest % size, 5))
+                {
+                    result = false;
+                }
+            }
+        }
+        if (heightmapHash == referenceHash)
+        {
+            result = false;
+        }
+
+        printf("Terrain generator test: %s\n", successString(result));
+        return result;
+    }
+
+    bool simplexNoise()
+    {
+        bool result = true;
+        SimplexNoise simplex(1234);
+        PerlinNoise perlin(1234);
+        const SimplexNoise other(1235);
+
+        // Seeded the same way as PerlinNoise
+        if (simplex.getPermutation() != perlin.getPermutation())
+        {
+            result = false;
+        }
+
+        std::default_random_engine random(5);
+        std::uniform_real_distribution<float> coordinate(-300.f, 300.f);
+        float total[3] = {};
+        bool anyDifferent = false;
+        const int sampleCount = 4096;
+        for (int i = 0; i < sampleCount; i++)
+        {
+            const float x = coordinate(random), y = coordinate(random), z = coordinate(random), w = coordinate(random);
+            const float values[3] = { simplex.noise(x, y), simplex.noise(x, y, z), simplex.noise(x, y, z, w) };
+            // A small step only makes a small change
+            const float stepped[3] = { simplex.noise(x + 0.001f, y), simplex.noise(x, y + 0.001f, z), simplex.noise(x, y, z, w + 0.001f) };
+
+            for (int dimension = 0; dimension < 3; dimension++)
+            {
+                if (values[dimension] < 0.f || values[dimension] > 1.f || fabsf(stepped[dimension] - values[dimension]) > 0.02f)
+                {
+                    result = false;
+                }
+                total[dimension] += values[dimension];
+            }
+            anyDifferent |= other.noise(x, y, z) != values[1];
+
+            // One octave is the noise itself, and more stay in range
+            const float fbm = FractalNoise::fbm<5>(simplex, x, y, z);
+            const float ridged = FractalNoise::ridged<3>(perlin, x, y, z);
+            if (fabsf(FractalNoise::fbm<1>(simplex, x, y, z) - values[1]) > 1e-6f || fbm < 0.f || fbm > 1.f || ridged < 0.f || ridged > 1.f)
+            {
+                result = false;
+            }
+        }
+
+        // Centred on a half, and different for a different seed
+        for (float sum : total)
+        {
+            if (fabsf(sum / sampleCount - 0.5f) > 0.05f)
+            {
+                result = false;
+            }
+        }
+        if (!anyDifferent || FractalNoise::totalAmplitude<3>() != 1.75f)
+        {
+            result = false;
+        }
+
+        printf("Simplex noise test: %s\n", successString(result));
+        return result;
+    }
+
+    bool slotAllocator()
+    {
+        bool result = true;
+
+        SlotAllocator allocator;
+        UINT first = allocator.allocate();
+        UINT second = allocator.allocate();
+        UINT third = allocator.allocate();
+        if (first != 0 || second != 1 || third != 2 || allocator.getSlotCount() != 3)
+        {
+            result = false;
+        }
+
+        // Freed slots are handed out again before the array grows
+        allocator.release(second);
+        allocator.release(first);
+        if (allocator.getUsedCount() != 1 || allocator.getFreeCount() != 2)
+        {
+            result = false;
+        }
+
+        UINT reused[2] = { allocator.allocate(), allocator.allocate() };
+        if (!((reused[0] == 0 && reused[1] == 1) || (reused[0] == 1 && reused[1] == 0)) || allocator.getSlotCount() != 3)
+        {
+            result = false;
+        }
+        if (allocator.allocate() != 3 || allocator.getSlotCount() != 4)
+        {
+            result = false;
+        }
+
+        allocator.clear();
+        if (allocator.getSlotCount() != 0 || allocator.allocate() != 0)
+        {
+            result = false;
+        }
+
+        printf("Slot allocator test: %s\n", successString(result));
+        return result;
+    }
+
+    bool dirtyRangeTracker()
+    {
+        bool result = true;
+
+        DirtyRangeTracker tracker;
+        tracker.markDirty(10);
+        tracker.markDirty(20, 25);
+        tracker.markDirty(5);
+        if (tracker.getRanges().size() != 3 || tracker.getRanges()[0].begin != 5 || tracker.getDirtyCount() != 7)
+        {
+            result = false;
+        }
+
+        // Touching and overlapping ranges merge
+        tracker.markDirty(11);
+        tracker.markDirty(24, 30);
+        tracker.markDirty(6, 10);
+        const std::vector<DirtyRange>& ranges = tracker.getRanges();
+        if (ranges.size() != 2 || ranges[0].begin != 5 || ranges[0].end != 12 || ranges[1].begin != 20 || ranges[1].end != 30)
+        {
+            result = false;
+        }
+
+        // One range spanning everything swallows the rest
+        tracker.markDirty(0, 100);
+        if (ranges.size() != 1 || ranges[0].begin != 0 || ranges[0].end != 100)
+        {
+            result = false;
+        }
+
+        // Compare against a flag per element for random marks
+        tracker.clear();
+        std::vector<bool> expected(1000, false);
+        std::default_random_engine engine(99);
+        for (int i = 0; i < 200; i++)
+        {
+            UINT begin = engine() % 990;
+            UINT end = begin + engine() % 10;
+            tracker.markDirty(begin, end);
+            for (UINT j = begin; j < end; j++)
+            {
+                expected[j] = true;
+            }
+        }
+
+        std::vector<bool> actual(1000, false);
+        for (std::size_t i = 0; i < ranges.size(); i++)
+        {
+            // Ranges are sorted, and never overlap or touch
+            if (ranges[i].begin >= ranges[i].end || (i > 0 && ranges[i].begin <= ranges[i - 1].end))
+            {
+                result = false;
+            }
+            for (UINT j = ranges[i].begin; j < ranges[i].end; j++)
+            {
+                actual[j] = true;
+            }
+        }
+        if (actual != expected)
+        {
+            result = false;
+        }
+
+        // Coalescing can only add elements, and leaves no gaps within the limit
+        UINT dirtyCount = tracker.getDirtyCount();
+        tracker.coalesce(8);
+        for (std::size_t i = 1; i < ranges.size(); i++)
+        {
+            if (ranges[i].begin - ranges[i - 1].end <= 8)
+            {
+                result = false;
+            }
+        }
+        for (UINT j = 0; j < 1000; j++)
+        {
+            if (expected[j])
+            {
+                bool covered = false;
+                for (const DirtyRange& range : ranges)
+                {
+                    covered = covered || (j >= range.begin && j < range.end);
+                }
+                if (!covered)
+                {
+                    result = false;
+                }
+            }
+        }
+        if (tracker.getDirtyCount() < dirtyCount)
+        {
+            result = false;
+        }
+
+        printf("Dirty range tracker test: %s\n", successString(result));
+        return result;
+    }
+
     char* successString(bool success)
     {
         return success ? "SUCCESS" : "FAILURE";
@@ -360,6 +2732,36 @@ namespace UnitTests
         // Transform
         runTest(hierarchy, &result);
 
+        // World
+        runTest(chunk, &result);
+        runTest(chunkPalette, &result);
+        runTest(chunkMap, &result);
+        runTest(sparseVoxelOctree, &result);
+        runTest(sparseVoxelOctreeRaycast, &result);
+        runTest(lzCompression, &result);
+        runTest(chunkCompression, &result);
+        runTest(chunkExposure, &result);
+        runTest(occupancyShift, &result);
+        runTest(occupancyInterior, &result);
+        runTest(voxelGrid, &result);
+        runTest(worldSnapshot, &result);
+        runTest(slotAllocator, &result);
+        runTest(dirtyRangeTracker, &result);
+        runTest(chunkMesher, &result);
+        runTest(faceInstances, &result);
+        runTest(blockInstancePacking, &result);
+        runTest(vertexPacking, &result);
+        runTest(meshOptimiser, &result);
+        runTest(objParser, &result);
+        runTest(meshCache, &result);
+        runTest(assetCache, &result);
+        runTest(taskGraph, &result);
+        runTest(texturePacker, &result);
+        runTest(textureCompression, &result);
+        runTest(perlinNoise, &result);
+        runTest(terrainGenerator, &result);
+        runTest(simplexNoise, &result);
+
         printf("\n\tFinal result: %s\n", successString(result));
         return result;
     }
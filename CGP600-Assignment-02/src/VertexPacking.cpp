@@ -0,0 +1,224 @@
+#include "VertexPacking.hpp"
+#include <cmath>
+#include <cstring>
+
+using namespace DirectX;
+
+static float signNotZero(float value)
+{
+    return (value >= 0.f) ? 1.f : -1.f;
+}
+
+static void cross(const float a[3], const float b[3], float output[3])
+{
+    output[0] = a[1] * b[2] - a[2] * b[1];
+    output[1] = a[2] * b[0] - a[0] * b[2];
+    output[2] = a[0] * b[1] - a[1] * b[0];
+}
+
+static float dot(const float a[3], const float b[3])
+{
+    return a[0] * b[0] + a[1] * b[1] + a[2] * b[2];
+}
+
+static bool normalize(float value[3])
+{
+    const float length = sqrtf(dot(value, value));
+    if (!(length > 1e-12f)) return false;
+
+    value[0] /= length;
+    value[1] /= length;
+    value[2] /= length;
+    return true;
+}
+
+namespace VertexPacking
+{
+    uint16_t floatToHalf(float value)
+    {
+        uint32_t bits;
+        memcpy(&bits, &value, sizeof(bits));
+
+        const uint16_t sign = (uint16_t)((bits >> 16) & 0x8000u);
+        const int exponent = (int)((bits >> 23) & 0xFFu);
+        uint32_t mantissa = bits & 0x7FFFFFu;
+
+        // Infinity stays infinity, and NaN stays NaN
+        if (exponent == 0xFF) return sign | 0x7C00u | (mantissa ? 0x200u : 0u);
+
+        const int halfExponent = exponent - 127 + 15;
+        if (halfExponent >= 31) return sign | 0x7C00u;
+
+        // Too small for a normal half, so shift the whole mantissa down into a denormal
+        if (halfExponent <= 0)
+        {
+            if (halfExponent < -10) return sign;
+
+            mantissa |= 0x800000u;
+            const int shift = 14 - halfExponent;
+            uint32_t half = mantissa >> shift;
+            const uint32_t remainder = mantissa & ((1u << shift) - 1u);
+            const uint32_t halfway = 1u << (shift - 1);
+            if (remainder > halfway || (remainder == halfway && (half & 1u))) half++;
+            return (uint16_t)(sign | half);
+        }
+
+        // Rounding up can carry into the exponent, which is still the right answer
+        uint32_t half = ((uint32_t)halfExponent << 10) | (mantissa >> 13);
+        const uint32_t remainder = mantissa & 0x1FFFu;
+        if (remainder > 0x1000u || (remainder == 0x1000u && (half & 1u))) half++;
+        return (uint16_t)(sign | half);
+    }
+
+    float halfToFloat(uint16_t value)
+    {
+        const uint32_t sign = (uint32_t)(value & 0x8000u) << 16;
+        const int exponent = (value >> 10) & 0x1F;
+        const uint32_t mantissa = value & 0x3FFu;
+
+        if (exponent == 0)
+        {
+            // Denormals are exact in a float
+            const float result = (float)mantissa * (1.f / 16777216.f);
+            return sign ? -result : result;
+        }
+
+        const uint32_t bits = (exponent == 31) ?
+            (sign | 0x7F800000u | (mantissa << 13)) :
+            (sign | ((uint32_t)(exponent - 15 + 127) << 23) | (mantissa << 13));
+
+        float result;
+        memcpy(&result, &bits, sizeof(result));
+        return result;
+    }
+
+    int16_t floatToSnorm16(float value)
+    {
+        value = (value < -1.f) ? -1.f : (value > 1.f) ? 1.f : value;
+        return (int16_t)lroundf(value * 32767.f);
+    }
+
+    float snorm16ToFloat(int16_t value)
+    {
+        // -32768 and -32767 both mean -1, the same as the GPU
+        const float result = (float)value / 32767.f;
+        return (result < -1.f) ? -1.f : result;
+    }
+
+    void octahedralEncode(float x, float y, float z, int16_t output[2])
+    {
+        const float length = fabsf(x) + fabsf(y) + fabsf(z);
+        if (length == 0.f)
+        {
+            output[0] = 0;
+            output[1] = 0;
+            return;
+        }
+
+        float u = x / length;
+        float v = y / length;
+
+        // Fold the lower half over the upper half
+        if (z < 0.f)
+        {
+            const float oldU = u;
+            u = (1.f - fabsf(v)) * signNotZero(oldU);
+            v = (1.f - fabsf(oldU)) * signNotZero(v);
+        }
+
+        output[0] = floatToSnorm16(u);
+        output[1] = floatToSnorm16(v);
+    }
+
+    void octahedralDecode(const int16_t input[2], float output[3])
+    {
+        float u = snorm16ToFloat(input[0]);
+        float v = snorm16ToFloat(input[1]);
+        const float z = 1.f - fabsf(u) - fabsf(v);
+
+        if (z < 0.f)
+        {
+            const float oldU = u;
+            u = (1.f - fabsf(v)) * signNotZero(oldU);
+            v = (1.f - fabsf(oldU)) * signNotZero(v);
+        }
+
+        output[0] = u;
+        output[1] = v;
+        output[2] = z;
+        normalize(output);
+    }
+
+    PackedVertex packVertex(const Vertex& vertex)
+    {
+        PackedVertex result;
+
+        float normal[3] = { vertex.normal.x, vertex.normal.y, vertex.normal.z };
+        float tangent[3] = { vertex.tangent.x, vertex.tangent.y, vertex.tangent.z };
+        const float binormal[3] = { vertex.binormal.x, vertex.binormal.y, vertex.binormal.z };
+
+        if (!normalize(normal))
+        {
+            normal[0] = 0.f;
+            normal[1] = 0.f;
+            normal[2] = 1.f;
+        }
+
+        // Gram-Schmidt, falling back to any perpendicular if the tangent is missing or lines up with the normal
+        const float along = dot(tangent, normal);
+        tangent[0] -= normal[0] * along;
+        tangent[1] -= normal[1] * along;
+        tangent[2] -= normal[2] * along;
+        if (!normalize(tangent))
+        {
+            const float axis[3] = { fabsf(normal[0]) < 0.9f ? 1.f : 0.f, fabsf(normal[0]) < 0.9f ? 0.f : 1.f, 0.f };
+            cross(axis, normal, tangent);
+            normalize(tangent);
+        }
+
+        float rebuilt[3];
+        cross(normal, tangent, rebuilt);
+        const float binormalSign = (dot(rebuilt, binormal) < 0.f) ? -1.f : 1.f;
+
+        result.position[0] = floatToHalf(vertex.position.x);
+        result.position[1] = floatToHalf(vertex.position.y);
+        result.position[2] = floatToHalf(vertex.position.z);
+        result.position[3] = floatToHalf(binormalSign);
+
+        const float* colour = &vertex.colour.x;
+        for (int i = 0; i < 4; i++)
+        {
+            const float channel = (colour[i] < 0.f) ? 0.f : (colour[i] > 1.f) ? 1.f : colour[i];
+            result.colour[i] = (uint8_t)lroundf(channel * 255.f);
+        }
+
+        result.textureCoord[0] = floatToHalf(vertex.textureCoord.x);
+        result.textureCoord[1] = floatToHalf(vertex.textureCoord.y);
+
+        octahedralEncode(normal[0], normal[1], normal[2], result.normal);
+        octahedralEncode(tangent[0], tangent[1], tangent[2], result.tangent);
+
+        return result;
+    }
+
+    Vertex unpackVertex(const PackedVertex& vertex)
+    {
+        Vertex result;
+
+        result.position = XMFLOAT4(halfToFloat(vertex.position[0]), halfToFloat(vertex.position[1]), halfToFloat(vertex.position[2]), 1.f);
+        result.colour = XMFLOAT4(vertex.colour[0] / 255.f, vertex.colour[1] / 255.f, vertex.colour[2] / 255.f, vertex.colour[3] / 255.f);
+        result.textureCoord = XMFLOAT2(halfToFloat(vertex.textureCoord[0]), halfToFloat(vertex.textureCoord[1]));
+
+        float normal[3], tangent[3], binormal[3];
+        octahedralDecode(vertex.normal, normal);
+        octahedralDecode(vertex.tangent, tangent);
+        cross(normal, tangent, binormal);
+        const float binormalSign = halfToFloat(vertex.position[3]);
+
+        result.normal = XMFLOAT4(normal[0], normal[1], normal[2], 0.f);
+        result.tangent = XMFLOAT4(tangent[0], tangent[1], tangent[2], 0.f);
+        result.binormal = XMFLOAT4(binormal[0] * binormalSign, binormal[1] * binormalSign, binormal[2] * binormalSign, 0.f);
+
+        return result;
+    }
+}
@@ -264,6 +264,7 @@ bool Window::pollMessage(MSG* message)
 
 HRESULT Window::create(HINSTANCE instance, int commandShow, char* name)
 {
+    createTime = std::chrono::high_resolution_clock::now();
     backgroundClearColour = new float[4] { 0.f, 0.f, 0.f, 1.f };
 
     WNDCLASSEX windowClass = { 0 };
@@ -355,6 +356,12 @@ void Window::renderFrame()
     worldManager.renderFrame(deltaTime, constantBuffers, blendState);
 
     swapChain->Present(0, 0);
+
+    if (!firstFramePresented)
+    {
+        firstFramePresented = true;
+        printf("Time to first frame: %.1f ms\n", std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - createTime).count());
+    }
 }
 
 LRESULT Window::eventCallbackInternal(UINT message, WPARAM wParam, LPARAM lParam)
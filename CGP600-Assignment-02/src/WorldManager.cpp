@@ -1,10 +1,19 @@
 #include "WorldManager.hpp"
 #include "ConstantBuffers.hpp"
 #include "Utility.hpp"
-#include <random>
-#include <WICTextureLoader.h>
-
-void WorldManager::blockRaytrace(Segment ray, int* blockIndexOut, Hit* hitOut)
+#include "ChunkMesher.hpp"
+#include "Assets.hpp"
+#include "TaskGraph.hpp"
+#include "TerrainGenerator.hpp"
+#include "TexturePacker.hpp"
+#include "TextureCompression.hpp"
+#include "ImageLoader.hpp"
+#include <filesystem>
+#include <thread>
+#include <stdio.h>
+#include <string>
+
+void WorldManager::blockRaytrace(Segment ray, Hit* hitOut)
 {
     XMVECTOR cameraPosition = player.getCamera()->getPosition();
 
@@ -15,20 +24,19 @@ void WorldManager::blockRaytrace(Segment ray, int* blockIndexOut, Hit* hitOut)
 
     const int checkRange = 4;
 
-    int currentBlock = -1;
     Hit currentHit;
     currentHit.hit = false;
     currentHit.time = 1.f;
 
     // Only bother checking around the player in a small radius for performance reasons
-    for (int x = Utility::max(cameraX - checkRange, 0); x <= Utility::min(cameraX + checkRange, width - 1); x++)
+    for (int x = cameraX - checkRange; x <= cameraX + checkRange; x++)
     {
-        for (int y = Utility::max(cameraY - checkRange, 0); y <= Utility::min(cameraY + checkRange, height - 1); y++)
+        for (int y = cameraY - checkRange; y <= cameraY + checkRange; y++)
         {
-            for (int z = Utility::max(cameraZ - checkRange, 0); z <= Utility::min(cameraZ + checkRange, depth - 1); z++)
+            for (int z = cameraZ - checkRange; z <= cameraZ + checkRange; z++)
             {
                 // Make sure there's a block here
-                if (getBlock(x, y, z) == nullptr) continue;
+                if (!blocks.isSolid(x, y, z)) continue;
 
                 // Re-use a single block object moved to the current position to save memory
                 blockObject->setPosition(XMVectorSet((float)x, (float)y, (float)z, 1.f));
@@ -39,7 +47,6 @@ void WorldManager::blockRaytrace(Segment ray, int* blockIndexOut, Hit* hitOut)
                     if (hit.time < currentHit.time)
                     {
                         currentHit = hit;
-                        currentBlock = getBlockIndex(x, y, z);
                         currentHit.position = XMVectorSet((float)x, (float)y, (float)z, 1.f);
                     }
                 }
@@ -47,73 +54,340 @@ void WorldManager::blockRaytrace(Segment ray, int* blockIndexOut, Hit* hitOut)
         }
     }
 
-    if (blockIndexOut)
-    {
-        *blockIndexOut = currentBlock;
-    }
     if (hitOut)
     {
         *hitOut = currentHit;
     }
 }
 
-int WorldManager::getBlockIndex(int x, int y, int z)
+// Chunk relative coordinates have to fit in an instance
+static_assert(ChunkMap::chunkSize <= (1 << BlockInstance::coordinateBits), "Chunks are too big for BlockInstance");
+
+UINT WorldManager::getFaceKey(int x, int y, int z, int face)
+{
+    return (UINT)((x + ChunkMap::chunkSize * (y + ChunkMap::chunkSize * z)) * Chunk::faceCount + face);
+}
+
+void WorldManager::updateInstance(int x, int y, int z)
 {
-    return x + width * (y + height * z);
+    const UINT faces = blocks.getExposedFaces(x, y, z);
+    const ChunkCoordinate coordinate = ChunkMap::getChunkCoordinate(x, y, z);
+
+    // Don't make an entry for a chunk that has never had anything to show
+    auto entry = chunkInstances.find(coordinate);
+    if (entry == chunkInstances.end())
+    {
+        if (!faces) return;
+        entry = chunkInstances.emplace(coordinate, ChunkInstances()).first;
+    }
+    ChunkInstances& chunk = entry->second;
+
+    const int localX = ChunkMap::getLocalCoordinate(x);
+    const int localY = ChunkMap::getLocalCoordinate(y);
+    const int localZ = ChunkMap::getLocalCoordinate(z);
+    const UINT textureId = faces ? blocks.getBlock(x, y, z)->textureId : 0;
+
+    for (int face = 0; face < Chunk::faceCount; face++)
+    {
+        const UINT key = getFaceKey(localX, localY, localZ, face);
+        auto iterator = chunk.slots.find(key);
+
+        if (!(faces & (1u << face)))
+        {
+            if (iterator == chunk.slots.end()) continue;
+
+            // Park an empty instance in the slot until it's re-used
+            chunk.instances[iterator->second] = BlockInstance::encode(0, 0, 0, BlockInstance::emptyFace, 0);
+            chunk.dirty.markDirty(iterator->second);
+
+            chunk.slotAllocator.release(iterator->second);
+            chunk.slots.erase(iterator);
+            continue;
+        }
+
+        UINT slot;
+        if (iterator == chunk.slots.end())
+        {
+            slot = chunk.slotAllocator.allocate();
+            chunk.slots[key] = slot;
+            if (slot >= chunk.instances.size())
+            {
+                chunk.instances.resize(slot + 1);
+            }
+        }
+        else
+        {
+            slot = iterator->second;
+        }
+
+        chunk.instances[slot] = BlockInstance::encode((UINT)localX, (UINT)localY, (UINT)localZ, (UINT)face, textureId);
+        chunk.dirty.markDirty(slot);
+    }
 }
 
-void WorldManager::removeBlock(int index)
+void WorldManager::updateInstancesAround(int x, int y, int z)
 {
-    blocks[index] = nullptr;
+    std::lock_guard<std::mutex> guard(instanceMutex);
+
+    updateInstance(x, y, z);
+    updateInstance(x - 1, y, z);
+    updateInstance(x + 1, y, z);
+    updateInstance(x, y - 1, z);
+    updateInstance(x, y + 1, z);
+    updateInstance(x, y, z - 1);
+    updateInstance(x, y, z + 1);
 }
 
-void WorldManager::buildInstanceBuffer()
+void WorldManager::buildInstances()
 {
-    // Hold up the render thread to prevent bad data being read
-    std::lock_guard<std::mutex> guard(mutex);
+    std::lock_guard<std::mutex> guard(instanceMutex);
 
-    // Get rid of the old instance buffer
-    if (instanceBuffer)
+    // Keep the GPU buffers, they'll be refilled on the next upload
+    for (auto& entry : chunkInstances)
     {
-        instanceBuffer->Release();
-        instanceBuffer = nullptr;
+        ChunkInstances& chunk = entry.second;
+        chunk.instances.clear();
+        chunk.slots.clear();
+        chunk.slotAllocator.clear();
+        chunk.dirty.clear();
     }
 
-    instances.clear();
+    // Loop through the chunks, which only exist if they contain blocks
+    for (const auto& entry : blocks.getChunks())
+    {
+        ChunkInstances& chunk = chunkInstances[entry.first];
+        ChunkMesher::buildFaceInstances(*blocks.getChunk(entry.first), chunk.instances);
+
+        for (const BlockInstance& instance : chunk.instances)
+        {
+            chunk.slots[getFaceKey((int)instance.getX(), (int)instance.getY(), (int)instance.getZ(), (int)instance.getFace())] = chunk.slotAllocator.allocate();
+        }
+
+        chunk.dirty.markDirty(0, (UINT)chunk.instances.size());
+    }
+}
 
-    // Loop through the world
-    for (int x = 0; x < width; x++)
+void WorldManager::uploadInstances()
+{
+    std::lock_guard<std::mutex> guard(instanceMutex);
+
+    instanceDraws.clear();
+
+    for (auto& entry : chunkInstances)
     {
-        for (int y = 0; y < height; y++)
+        ChunkInstances& chunk = entry.second;
+
+        const UINT slotCount = chunk.slotAllocator.getSlotCount();
+        if (slotCount > chunk.bufferCapacity)
         {
-            for (int z = 0; z < depth; z++)
+            if (chunk.buffer)
             {
-                // If there's a block, make an instance
-                if (blocks[getBlockIndex(x, y, z)])
-                {
-                    BlockInstance instance;
-                    instance.position = XMFLOAT4((float)x, (float)y, (float)z, 0.f);
-                    instance.textureId = getBlock(x, y, z)->textureId;
-                    instances.push_back(instance);
-                }
+                chunk.buffer->Release();
+                chunk.buffer = nullptr;
             }
+
+            // Leave room to spare so placing blocks doesn't recreate the buffer every time
+            chunk.bufferCapacity = Utility::max(slotCount + slotCount / 2, 256u);
+
+            D3D11_BUFFER_DESC bufferDescription;
+            ZeroMemory(&bufferDescription, sizeof(bufferDescription));
+            bufferDescription.Usage = D3D11_USAGE_DEFAULT;
+            bufferDescription.ByteWidth = sizeof(BlockInstance) * chunk.bufferCapacity;
+            bufferDescription.BindFlags = D3D11_BIND_VERTEX_BUFFER;
+
+            if (FAILED(device->CreateBuffer(&bufferDescription, nullptr, &chunk.buffer)))
+            {
+                OutputDebugString("#### Failed to create an instance buffer! ####\n");
+                chunk.bufferCapacity = 0;
+                continue;
+            }
+
+            // A new buffer starts out with nothing in it
+            chunk.dirty.clear();
+            chunk.dirty.markDirty(0, slotCount);
+        }
+
+        // Copying a few clean slots is cheaper than another update call
+        chunk.dirty.coalesce(64);
+        for (const DirtyRange& range : chunk.dirty.getRanges())
+        {
+            D3D11_BOX box = { range.begin * (UINT)sizeof(BlockInstance), 0, 0, range.end * (UINT)sizeof(BlockInstance), 1, 1 };
+            immediateContext->UpdateSubresource(chunk.buffer, 0, &box, &chunk.instances[range.begin], 0, 0);
+        }
+        chunk.dirty.clear();
+
+        // Chunks that have been dug out keep their buffer in case they're built on again, but aren't drawn
+        if (chunk.slotAllocator.getUsedCount() > 0)
+        {
+            instanceDraws.push_back({ entry.first, chunk.buffer, slotCount });
         }
     }
+}
+
+// Every layer from the DDS files baked with -bake, or false if any are missing or they don't all match
+static bool loadBakedLayers(const std::vector<std::wstring>& fileNames, CompressedTexture& output)
+{
+    for (std::size_t layer = 0; layer < fileNames.size(); layer++)
+    {
+        const std::wstring bakedPath = Assets::getBakedTexturePath(fileNames[layer].c_str());
+        if (bakedPath.empty()) return false;
 
-    // Make the buffer
-    D3D11_BUFFER_DESC bufferDescription;
-    ZeroMemory(&bufferDescription, sizeof(bufferDescription));
-    bufferDescription.Usage = D3D11_USAGE_DEFAULT;
-    bufferDescription.ByteWidth = sizeof(BlockInstance) * (UINT)instances.size();
-    bufferDescription.BindFlags = D3D11_BIND_VERTEX_BUFFER;
+        MappedFile file;
+        CompressedTexture texture;
+        if (!file.open(std::filesystem::path(bakedPath).string().c_str()) || !TextureCompression::readDDS(file.getData(), file.getSize(), texture)) return false;
+        if (texture.layerCount != 1) return false;
 
-    // Make a reference to the instance array
-    D3D11_SUBRESOURCE_DATA instanceData;
-    ZeroMemory(&instanceData, sizeof(instanceData));
-    instanceData.pSysMem = instances.data();
+        if (layer == 0)
+        {
+            output = std::move(texture);
+            continue;
+        }
+
+        if (texture.width != output.width || texture.height != output.height || texture.mipCount != output.mipCount || texture.format != output.format) return false;
+
+        for (std::size_t offset : texture.offsets)
+        {
+            output.offsets.push_back(output.data.size() + offset);
+        }
+        output.data.insert(output.data.end(), texture.data.begin(), texture.data.end());
+        output.layerCount++;
+    }
+
+    return !fileNames.empty();
+}
+
+static HRESULT createTextureArray(ID3D11Device* device, UINT width, UINT height, UINT mipCount, UINT layerCount, DXGI_FORMAT format,
+    const std::vector<D3D11_SUBRESOURCE_DATA>& subresources, ID3D11ShaderResourceView** viewOut)
+{
+    D3D11_TEXTURE2D_DESC textureDescription;
+    ZeroMemory(&textureDescription, sizeof(textureDescription));
+    textureDescription.Width = width;
+    textureDescription.Height = height;
+    textureDescription.MipLevels = mipCount;
+    textureDescription.ArraySize = layerCount;
+    textureDescription.Format = format;
+    textureDescription.SampleDesc.Count = 1;
+    textureDescription.Usage = D3D11_USAGE_IMMUTABLE;
+    textureDescription.BindFlags = D3D11_BIND_SHADER_RESOURCE;
+
+    ID3D11Texture2D* texture = nullptr;
+    HRESULT result = device->CreateTexture2D(&textureDescription, subresources.data(), &texture);
+    if (SUCCEEDED(result))
+    {
+        result = device->CreateShaderResourceView(texture, nullptr, viewOut);
+    }
+    if (texture) texture->Release();
 
-    // Create the buffer
-    device->CreateBuffer(&bufferDescription, &instanceData, &instanceBuffer);
+    return result;
+}
+
+void WorldManager::loadBlockTextures()
+{
+    // Texture id order, each with an albedo and a normal map
+    const wchar_t* names[] = { L"dirt", L"grass" };
+    const wchar_t* suffixes[2] = { L"-albedo.png", L"-normal.png" };
+    // Used in place of anything missing, mid grey and a flat normal
+    const uint8_t placeholders[2][4] = { { 128, 128, 128, 255 }, { 128, 128, 255, 255 } };
+
+    std::vector<std::wstring> fileNames[2];
+    for (int kind = 0; kind < 2; kind++)
+    {
+        for (const wchar_t* name : names)
+        {
+            fileNames[kind].push_back(std::wstring(L"textures/") + name + suffixes[kind]);
+        }
+    }
+
+    textures.assign(2, nullptr);
+
+    // Baked layers are already compressed with their mips made, so they only need uploading
+    // Albedo layers have to all be opaque or all not, so they share a format
+    bool baked[2] = { false, false };
+    for (int kind = 0; kind < 2; kind++)
+    {
+        CompressedTexture texture;
+        if (!loadBakedLayers(fileNames[kind], texture)) continue;
+
+        std::vector<D3D11_SUBRESOURCE_DATA> subresources(texture.layerCount * texture.mipCount);
+        for (UINT layer = 0; layer < texture.layerCount; layer++)
+        {
+            for (UINT mip = 0; mip < texture.mipCount; mip++)
+            {
+                D3D11_SUBRESOURCE_DATA& subresource = subresources[layer * texture.mipCount + mip];
+                subresource.pSysMem = texture.getMip(layer, mip);
+                subresource.SysMemPitch = texture.getRowPitch(mip);
+                subresource.SysMemSlicePitch = 0;
+            }
+        }
+
+        baked[kind] = SUCCEEDED(createTextureArray(device, texture.width, texture.height, texture.mipCount, texture.layerCount, (DXGI_FORMAT)texture.format,
+            subresources, &textures[kind]));
+    }
+
+    std::vector<TextureImage> layers[2];
+    std::vector<bool> loaded[2];
+    unsigned int width = 0;
+    unsigned int height = 0;
+
+    for (int kind = 0; kind < 2; kind++)
+    {
+        if (baked[kind]) continue;
+
+        for (const std::wstring& fileName : fileNames[kind])
+        {
+            TextureImage image;
+            loaded[kind].push_back(ImageLoader::loadFile(fileName.c_str(), image));
+
+            if (!loaded[kind].back())
+            {
+                OutputDebugStringW((L"#### Failed to load texture: " + fileName + L" ####\n").c_str());
+            }
+            else if (width == 0)
+            {
+                width = image.width;
+                height = image.height;
+            }
+            layers[kind].push_back(std::move(image));
+        }
+    }
+
+    for (int kind = 0; kind < 2; kind++)
+    {
+        if (baked[kind]) continue;
+
+        for (std::size_t layer = 0; layer < layers[kind].size(); layer++)
+        {
+            if (!loaded[kind][layer])
+            {
+                const uint8_t* colour = placeholders[kind];
+                layers[kind][layer] = TexturePacker::makeSolid(width ? width : 1, height ? height : 1, colour[0], colour[1], colour[2], colour[3]);
+            }
+        }
+
+        TextureArray array;
+        if (!TexturePacker::pack(layers[kind], kind == 1, array))
+        {
+            OutputDebugString("#### Block textures have to all be the same size! ####\n");
+            continue;
+        }
+
+        std::vector<D3D11_SUBRESOURCE_DATA> subresources(array.layerCount * array.mipCount);
+        for (UINT layer = 0; layer < array.layerCount; layer++)
+        {
+            for (UINT mip = 0; mip < array.mipCount; mip++)
+            {
+                D3D11_SUBRESOURCE_DATA& subresource = subresources[layer * array.mipCount + mip];
+                subresource.pSysMem = array.getMip(layer, mip);
+                subresource.SysMemPitch = array.getMipWidth(mip) * 4;
+                subresource.SysMemSlicePitch = 0;
+            }
+        }
+
+        if (FAILED(createTextureArray(device, array.width, array.height, array.mipCount, array.layerCount, DXGI_FORMAT_R8G8B8A8_UNORM, subresources, &textures[kind])))
+        {
+            OutputDebugString("#### Failed to create the block textures! ####\n");
+        }
+    }
 }
 
 void WorldManager::handleCharacterCollision(Character& character)
@@ -130,14 +404,14 @@ void WorldManager::handleCharacterCollision(Character& character)
     XMVECTOR hitDelta = XMVectorZero();
 
     // Only check in an area around the character for performance reasons
-    for (int x = Utility::max(characterX - checkRange, 0); x < Utility::min(characterX + checkRange, width); x++)
+    for (int x = characterX - checkRange; x < characterX + checkRange; x++)
     {
-        for (int y = Utility::max(characterY - checkRange, 0); y < Utility::min(characterY + checkRange, height); y++)
+        for (int y = characterY - checkRange; y < characterY + checkRange; y++)
         {
-            for (int z = Utility::max(characterZ - checkRange, 0); z < Utility::min(characterZ + checkRange, depth); z++)
+            for (int z = characterZ - checkRange; z < characterZ + checkRange; z++)
             {
                 // Make sure the block exists
-                if (getBlock(x, y, z) == nullptr) continue;
+                if (!blocks.isSolid(x, y, z)) continue;
 
                 XMVECTOR blockPosition = XMVectorSet((float)x, (float)y, (float)z, 1.f);
 
@@ -179,8 +453,7 @@ void WorldManager::handleCharacterCollision(Character& character)
     }
 }
 
-WorldManager::WorldManager() :
-    blocks(width * height * depth)
+WorldManager::WorldManager()
 {
     // Setup the directional light
     directionalLight.setDirection(DirectX::XMVector3Normalize(DirectX::XMVectorSet(-1.f, -1.f, 1.f, 0.f)));
@@ -198,10 +471,14 @@ WorldManager::~WorldManager()
     // Cleanup the textures
     for (ID3D11ShaderResourceView* texture : textures)
     {
-        texture->Release();
+        if (texture) texture->Release();
     }
 
-    if (instanceBuffer) instanceBuffer->Release();
+    for (auto& entry : chunkInstances)
+    {
+        if (entry.second.buffer) entry.second.buffer->Release();
+    }
+    if (chunkConstantBuffer) chunkConstantBuffer->Release();
 }
 
 void WorldManager::initialise(HWND* windowHandle, ID3D11Device* device, ID3D11DeviceContext* immediateContext)
@@ -210,41 +487,29 @@ void WorldManager::initialise(HWND* windowHandle, ID3D11Device* device, ID3D11De
     this->device = device;
     this->immediateContext = immediateContext;
 
-    // Make a sprite batch and font
-    spriteBatch = std::make_unique<SpriteBatch>(immediateContext);
-    spriteFont = std::make_unique<SpriteFont>(device, L"fonts/comicsans.spritefont");
-
     // Setup the player
     player.initialise(windowHandle);
     player.setBreakBlockFunction([&](Segment ray)
     {
-        int index;
+        Hit hit;
         // Look for a block to break
-        blockRaytrace(ray, &index, nullptr);
+        blockRaytrace(ray, &hit);
         // If there was a block in reach
-        if (index != -1)
+        if (hit.hit)
         {
-            removeBlock(index);
-            buildInstanceBuffer();
+            removeBlock((int)floor(XMVectorGetX(hit.position)), (int)floor(XMVectorGetY(hit.position)), (int)floor(XMVectorGetZ(hit.position)));
         }
     });
     player.setPlaceBlockFunction([&](Segment ray)
     {
         Hit hit;
         // Look for a block to build on
-        blockRaytrace(ray, nullptr, &hit);
+        blockRaytrace(ray, &hit);
         // If there was a block in reach
         if (hit.hit)
         {
-            // Check if there's space in the world
             XMVECTOR newPosition = hit.position + hit.normal;
-            if (XMVectorGetX(newPosition) >= 0.f && XMVectorGetX(newPosition) < (float)width &&
-                XMVectorGetY(newPosition) >= 0.f && XMVectorGetY(newPosition) < (float)height &&
-                XMVectorGetZ(newPosition) >= 0.f && XMVectorGetZ(newPosition) < (float)depth)
-            {
-                addBlock((int)floor(XMVectorGetX(newPosition)), (int)floor(XMVectorGetY(newPosition)), (int)floor(XMVectorGetZ(newPosition)), { 0 });
-                buildInstanceBuffer();
-            }
+            addBlock((int)floor(XMVectorGetX(newPosition)), (int)floor(XMVectorGetY(newPosition)), (int)floor(XMVectorGetZ(newPosition)), { 0 });
         }
     });
     player.setPosition(XMVectorSet((float)width / 2.f, (float)height + 2.f, (float)depth / 2.f, 1.f));
@@ -253,131 +518,124 @@ void WorldManager::initialise(HWND* windowHandle, ID3D11Device* device, ID3D11De
     player.addChild(&pointLight);
     pointLight.setLocalPosition(XMVectorSet(0.f, 1.f, 0.f, 1.f));
 
+    // Everything else is loaded as a graph of tasks, so reading files, decoding images, baking models and generating terrain overlap
+    // The device is free-threaded, but the immediate context isn't, so anything using it is a serial task and stays on this thread
+    TaskGraph startup;
+
+    // Make a sprite batch and font
+    startup.addSerialTask("Sprite batch", [&]()
+    {
+        spriteBatch = std::make_unique<SpriteBatch>(immediateContext);
+    });
+    startup.addTask("Font", [&]()
+    {
+        spriteFont = std::make_unique<SpriteFont>(device, L"fonts/comicsans.spritefont");
+    });
+
     // Initialise the block object
-    blockObject = std::make_unique<BlockObject>(device, immediateContext);
-    D3D11_INPUT_ELEMENT_DESC blockInputElementDescriptions[] = {
-        { "POSITION", 0, DXGI_FORMAT_R32G32B32A32_FLOAT, 0, 0, D3D11_INPUT_PER_VERTEX_DATA, 0 },
-        { "COLOR", 0, DXGI_FORMAT_R32G32B32A32_FLOAT, 0, D3D11_APPEND_ALIGNED_ELEMENT, D3D11_INPUT_PER_VERTEX_DATA, 0 },
-        { "TEXCOORD", 0, DXGI_FORMAT_R32G32_FLOAT, 0, D3D11_APPEND_ALIGNED_ELEMENT, D3D11_INPUT_PER_VERTEX_DATA, 0 },
-        { "NORMAL", 0, DXGI_FORMAT_R32G32B32A32_FLOAT, 0, D3D11_APPEND_ALIGNED_ELEMENT, D3D11_INPUT_PER_VERTEX_DATA, 0 },
-        { "TANGENT", 0, DXGI_FORMAT_R32G32B32A32_FLOAT, 0, D3D11_APPEND_ALIGNED_ELEMENT, D3D11_INPUT_PER_VERTEX_DATA, 0 },
-        { "BINORMAL", 0, DXGI_FORMAT_R32G32B32A32_FLOAT, 0, D3D11_APPEND_ALIGNED_ELEMENT, D3D11_INPUT_PER_VERTEX_DATA, 0 },
-        { "INST_POSITION", 0, DXGI_FORMAT_R32G32B32A32_FLOAT, 1, 0, D3D11_INPUT_PER_INSTANCE_DATA, 1 },
-        { "TEXID", 0, DXGI_FORMAT_R32_UINT, 1, D3D11_APPEND_ALIGNED_ELEMENT, D3D11_INPUT_PER_INSTANCE_DATA, 1 }
-    };
-    blockObject->getMesh()->loadShaders(L"shaders/blockShaders.hlsl", device, blockInputElementDescriptions, ARRAYSIZE(blockInputElementDescriptions));
+    startup.addTask("Block object", [&]()
+    {
+        blockObject = std::make_unique<BlockObject>(device, immediateContext);
+        D3D11_INPUT_ELEMENT_DESC blockInputElementDescriptions[] = {
+            { "INSTANCE", 0, DXGI_FORMAT_R32_UINT, 0, 0, D3D11_INPUT_PER_INSTANCE_DATA, 1 }
+        };
+        blockObject->getMesh()->loadShaders(L"shaders/blockShaders.hlsl", device, blockInputElementDescriptions, ARRAYSIZE(blockInputElementDescriptions));
+
+        // Create the constant buffer holding the origin of the chunk being drawn
+        D3D11_BUFFER_DESC constantBufferDescription;
+        ZeroMemory(&constantBufferDescription, sizeof(constantBufferDescription));
+        constantBufferDescription.Usage = D3D11_USAGE_DEFAULT;
+        constantBufferDescription.ByteWidth = sizeof(ChunkConstantBuffer);
+        constantBufferDescription.BindFlags = D3D11_BIND_CONSTANT_BUFFER;
+
+        if (FAILED(device->CreateBuffer(&constantBufferDescription, NULL, &chunkConstantBuffer)))
+        {
+            OutputDebugString("#### Failed to create the chunk constant buffer! ####\n");
+        }
+    });
 
     // Initialise the skybox
-    skybox.loadFromFile("models/skybox.obj");
-    skybox.loadTexture(device, L"textures/clouds-albedo.png", L"textures/clouds-normal.png");
-    D3D11_INPUT_ELEMENT_DESC skyboxInputElementDescriptions[] = {
-        { "POSITION", 0, DXGI_FORMAT_R32G32B32A32_FLOAT, 0, 0, D3D11_INPUT_PER_VERTEX_DATA, 0 },
-        { "COLOR", 0, DXGI_FORMAT_R32G32B32A32_FLOAT, 0, D3D11_APPEND_ALIGNED_ELEMENT, D3D11_INPUT_PER_VERTEX_DATA, 0 },
-        { "TEXCOORD", 0, DXGI_FORMAT_R32G32_FLOAT, 0, D3D11_APPEND_ALIGNED_ELEMENT, D3D11_INPUT_PER_VERTEX_DATA, 0 },
-        { "NORMAL", 0, DXGI_FORMAT_R32G32B32_FLOAT, 0, D3D11_APPEND_ALIGNED_ELEMENT, D3D11_INPUT_PER_VERTEX_DATA, 0 },
-        { "TANGENT", 0, DXGI_FORMAT_R32G32B32_FLOAT, 0, D3D11_APPEND_ALIGNED_ELEMENT, D3D11_INPUT_PER_VERTEX_DATA, 0 },
-        { "BINORMAL", 0, DXGI_FORMAT_R32G32B32_FLOAT, 0, D3D11_APPEND_ALIGNED_ELEMENT, D3D11_INPUT_PER_VERTEX_DATA, 0 }
-    };
-    skybox.loadShaders(L"shaders/skyboxShaders.hlsl", device, skyboxInputElementDescriptions, ARRAYSIZE(skyboxInputElementDescriptions));
-    skybox.initialiseVertexBuffer(device, immediateContext);
+    startup.addTask("Skybox", [&]()
+    {
+        skybox.loadFromFile(device, "models/skybox.obj");
+        skybox.loadTexture(device, L"textures/clouds-albedo.png", L"textures/clouds-normal.png");
+        D3D11_INPUT_ELEMENT_DESC skyboxInputElementDescriptions[] = {
+            { "POSITION", 0, DXGI_FORMAT_R16G16B16A16_FLOAT, 0, 0, D3D11_INPUT_PER_VERTEX_DATA, 0 },
+            { "COLOR", 0, DXGI_FORMAT_R8G8B8A8_UNORM, 0, D3D11_APPEND_ALIGNED_ELEMENT, D3D11_INPUT_PER_VERTEX_DATA, 0 },
+            { "TEXCOORD", 0, DXGI_FORMAT_R16G16_FLOAT, 0, D3D11_APPEND_ALIGNED_ELEMENT, D3D11_INPUT_PER_VERTEX_DATA, 0 },
+            { "NORMAL", 0, DXGI_FORMAT_R16G16_SNORM, 0, D3D11_APPEND_ALIGNED_ELEMENT, D3D11_INPUT_PER_VERTEX_DATA, 0 },
+            { "TANGENT", 0, DXGI_FORMAT_R16G16_SNORM, 0, D3D11_APPEND_ALIGNED_ELEMENT, D3D11_INPUT_PER_VERTEX_DATA, 0 }
+        };
+        skybox.loadShaders(L"shaders/skyboxShaders.hlsl", device, skyboxInputElementDescriptions, ARRAYSIZE(skyboxInputElementDescriptions));
+    });
 
     // Create 10 enemies
     for (int i = 0; i < 10; i++)
     {
         enemies.push_back(std::move(std::make_unique<Enemy>()));
     }
-    for (std::unique_ptr<Enemy>& enemy : enemies)
-    {
-        enemy->initialise(device, immediateContext);
-        enemy->setPosition(XMVectorSet((float)width / 2.f, (float)height + 2.f, (float)depth / 2.f, 1.f));
-    }
-
-    // Create the textures for the blocks
-    ID3D11ShaderResourceView* texture = nullptr;
-
-    CreateWICTextureFromFile(device, immediateContext, L"textures/dirt-albedo.png", NULL, &texture);
-    textures.push_back(texture);
-    CreateWICTextureFromFile(device, immediateContext, L"textures/dirt-normal.png", NULL, &texture);
-    textures.push_back(texture);
-    CreateWICTextureFromFile(device, immediateContext, L"textures/grass-albedo.png", NULL, &texture);
-    textures.push_back(texture);
-    CreateWICTextureFromFile(device, immediateContext, L"textures/grass-normal.png", NULL, &texture);
-    textures.push_back(texture);
-
-    // Generate block values using the compute shader
-    perlinNoiseCompute.initialise(device, immediateContext, std::uniform_int_distribution<int>(0, 999999999)(std::random_device()));
-    perlinNoiseCompute.run();
-
-    std::vector<bool> blockValues = perlinNoiseCompute.getBlockValues();
-
-    for (std::size_t i = 0; i < blocks.size(); i++)
+    startup.addTask("Enemies", [&]()
     {
-        // If there should be a block in this position
-        if (blockValues[i])
+        for (std::unique_ptr<Enemy>& enemy : enemies)
         {
-            blocks[i] = std::make_unique<Block>(Block{ 0 });
+            enemy->initialise(device, immediateContext);
+            enemy->setPosition(XMVectorSet((float)width / 2.f, (float)height + 2.f, (float)depth / 2.f, 1.f));
         }
-    }
-
-    // Hollow out the world for performance reasons
-    std::vector<int> toRemove;
+    });
 
-    for (int x = 1; x < width - 1; x++)
+    // Create the textures for the blocks
+    startup.addTask("Block textures", [&]()
     {
-        for (int y = 1; y < height - 1; y++)
-        {
-            for (int z = 1; z < depth - 1; z++)
-            {
-                if (getBlock(x - 1, y, z) && getBlock(x + 1, y, z) &&
-                    getBlock(x, y - 1, z) && getBlock(x, y + 1, z) &&
-                    getBlock(x, y, z - 1) && getBlock(x, y, z + 1))
-                {
-                    toRemove.push_back(getBlockIndex(x, y, z));
-                }
-            }
-        }
-    }
+        loadBlockTextures();
+    });
 
-    for (int x = 0; x < width; x++)
-    {
-        for (int y = 0; y < height; y++)
-        {
-            for (int z = 0; z < depth; z++)
-            {
-                if (getBlock(x, y, z) && ((y == height - 1) || !getBlock(x, y + 1, z)))
-                {
-                    getBlock(x, y, z)->textureId = 1;
-                }
-            }
-        }
-    }
+    // Generate the terrain a chunk at a time, the same world every run for the same seed
+    // Its tasks go straight into this graph, so they share its threads rather than starting a pool of their own
+    TerrainGenerator generator(seed);
+    TaskGraph::TaskId terrain = generator.addTasks(startup, width / ChunkMap::chunkSize, height / ChunkMap::chunkSize, depth / ChunkMap::chunkSize, blocks);
 
-    for (int block : toRemove)
+    startup.addTask("Instances", [&]()
     {
-        removeBlock(block);
-    }
+        buildInstances();
+    }, { terrain });
 
-    buildInstanceBuffer();
+    startup.run(Utility::max(std::thread::hardware_concurrency(), 1u));
+    startup.printReport("Startup");
+    generator.printReport();
+    Assets::printStatistics();
+
+    blocks.enforceMemoryBudget();
+    blocks.publish();
 }
 
 void WorldManager::addBlock(int x, int y, int z, Block value)
 {
-    blocks[getBlockIndex(x, y, z)] = std::make_unique<Block>(value);
+    blocks.addBlock(x, y, z, value);
+    updateInstancesAround(x, y, z);
+    worldChanged = true;
 }
 
 void WorldManager::removeBlock(int x, int y, int z)
 {
-    removeBlock(getBlockIndex(x, y, z));
+    blocks.removeBlock(x, y, z);
+    updateInstancesAround(x, y, z);
+    worldChanged = true;
+}
+
+const Block* WorldManager::getBlock(int x, int y, int z)
+{
+    return blocks.getBlock(x, y, z);
 }
 
-std::unique_ptr<Block>& WorldManager::getBlock(int x, int y, int z)
+std::shared_ptr<const WorldSnapshot> WorldManager::getSnapshot() const
 {
-    return blocks[getBlockIndex(x, y, z)];
+    return blocks.getSnapshot();
 }
 
 void WorldManager::renderFrame(float deltaTime, std::vector<ID3D11Buffer*>& constantBuffers, ID3D11BlendState* blendState)
 {
-    std::lock_guard<std::mutex> guard(mutex);
+    // Pick up any edits made since the last frame
+    uploadInstances();
 
     // Use the block shaders
     blockObject->getMesh()->setShaders(immediateContext);
@@ -400,22 +658,20 @@ void WorldManager::renderFrame(float deltaTime, std::vector<ID3D11Buffer*>& cons
     immediateContext->PSSetConstantBuffers(1, 1, &constantBuffers[1]);
     immediateContext->PSSetShaderResources(0, (UINT)textures.size(), textures.data());
 
-    UINT strides[2] = {
-        sizeof(Vertex),
-        sizeof(BlockInstance)
-    };
-    UINT offsets[2] = { 0, 0 };
-
-    UINT vertexCount;
-
-    ID3D11Buffer* buffers[2] = {
-        blockObject->getMesh()->getVertexBuffer(&vertexCount),
-        instanceBuffer
-    };
+    UINT stride = sizeof(BlockInstance);
+    UINT offset = 0;
 
-    // Draw the blocks
-    immediateContext->IASetVertexBuffers(0, 2, buffers, strides, offsets);
-    immediateContext->DrawInstanced(vertexCount, (UINT)instances.size(), 0, 0);
+    // Draw the block faces a chunk at a time, six vertices each, including any empty slots, which the vertex shader throws away
+    immediateContext->VSSetConstantBuffers(2, 1, &chunkConstantBuffer);
+    for (const InstanceDraw& draw : instanceDraws)
+    {
+        ChunkConstantBuffer chunkConstantBufferValue = {
+            XMINT4(draw.coordinate.x * ChunkMap::chunkSize, draw.coordinate.y * ChunkMap::chunkSize, draw.coordinate.z * ChunkMap::chunkSize, 0)
+        };
+        immediateContext->UpdateSubresource(chunkConstantBuffer, 0, 0, &chunkConstantBufferValue, 0, 0);
+        immediateContext->IASetVertexBuffers(0, 1, &draw.buffer, &stride, &offset);
+        immediateContext->DrawInstanced(6, draw.instanceCount, 0, 0);
+    }
 
     // Draw the enemies
     for (std::unique_ptr<Enemy>& enemy : enemies)
@@ -479,6 +735,14 @@ void WorldManager::update(float deltaTime)
 
     // Set the skybox to follow the player
     skybox.setPosition(player.getPosition());
+
+    // Edits from this update go out as a single new version
+    if (worldChanged)
+    {
+        blocks.enforceMemoryBudget();
+        blocks.publish();
+        worldChanged = false;
+    }
 }
 
 void WorldManager::setCameraAspectRatio(UINT width, UINT height)
@@ -0,0 +1,46 @@
+#include "WorldSnapshot.hpp"
+
+WorldSnapshot::WorldSnapshot(uint64_t version, ChunkTable chunks) :
+    version(version),
+    chunks(std::move(chunks))
+{
+}
+
+uint64_t WorldSnapshot::getVersion() const
+{
+    return version;
+}
+
+const Block* WorldSnapshot::getBlock(int x, int y, int z) const
+{
+    const Chunk* chunk = getChunk(ChunkMap::getChunkCoordinate(x, y, z));
+    if (!chunk) return nullptr;
+
+    return chunk->getBlock(ChunkMap::getLocalCoordinate(x), ChunkMap::getLocalCoordinate(y), ChunkMap::getLocalCoordinate(z));
+}
+
+bool WorldSnapshot::isSolid(int x, int y, int z) const
+{
+    const Chunk* chunk = getChunk(ChunkMap::getChunkCoordinate(x, y, z));
+    if (!chunk) return false;
+
+    return chunk->isSolid(ChunkMap::getLocalCoordinate(x), ChunkMap::getLocalCoordinate(y), ChunkMap::getLocalCoordinate(z));
+}
+
+const Chunk* WorldSnapshot::getChunk(ChunkCoordinate coordinate) const
+{
+    auto iterator = chunks.find(coordinate);
+    if (iterator == chunks.end()) return nullptr;
+
+    return iterator->second.get();
+}
+
+const WorldSnapshot::ChunkTable& WorldSnapshot::getChunks() const
+{
+    return chunks;
+}
+
+std::size_t WorldSnapshot::getChunkCount() const
+{
+    return chunks.size();
+}
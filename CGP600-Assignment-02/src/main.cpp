@@ -1,10 +1,21 @@
 #include "Window.hpp"
 #include "UnitTests.hpp"
+#include "Benchmarks.hpp"
+#include "MeshCache.hpp"
+#include "Assets.hpp"
+#include "TextureCompression.hpp"
 #include <stdio.h>
+#include <string.h>
 #include <thread>
 
 int WINAPI WinMain(HINSTANCE instance, HINSTANCE previousInstance, LPSTR commandLine, int commandShow)
 {
+    const bool benchmark = strstr(commandLine, "-benchmark") != nullptr;
+    // Rebake every model up front, rather than leaving it to the first launch after they change, and compress every texture
+    const bool bake = strstr(commandLine, "-bake") != nullptr;
+    // Textures are compressed at the best quality unless -fast is given as well
+    const int textureQuality = (strstr(commandLine, "-fast") != nullptr) ? 0 : TextureCompression::maxQuality;
+
 #if _DEBUG
     // Give us a console in debug mode
     AllocConsole(); // Create the console
@@ -12,8 +23,32 @@ int WINAPI WinMain(HINSTANCE instance, HINSTANCE previousInstance, LPSTR command
     freopen_s(&file, "CONOUT$", "wb", stdout); // Pipe stdout into the console
 
     UnitTests::runTests();
+#else
+    // Benchmarks are meant for release builds, so they need a console of their own
+    if (benchmark || bake)
+    {
+        AllocConsole();
+        FILE* file;
+        freopen_s(&file, "CONOUT$", "wb", stdout);
+    }
 #endif
 
+    if (benchmark)
+    {
+        Benchmarks::runBenchmarks();
+        // Keep the console open until the results have been read
+        MessageBox(nullptr, "Benchmarks finished", "CGP600 Assignment 02", MB_OK);
+        return 0;
+    }
+
+    if (bake)
+    {
+        printf("Baked %d meshes\n", MeshCache::bakeDirectory("models"));
+        printf("Baked %d textures\n", Assets::bakeTextures("textures", textureQuality));
+        MessageBox(nullptr, "Baking finished", "CGP600 Assignment 02", MB_OK);
+        return 0;
+    }
+
     Window window;
     if (FAILED(window.create(instance, commandShow, "CGP600 Assignment 02\0")))
     {